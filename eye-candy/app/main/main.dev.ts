@@ -52,6 +52,20 @@ const imageSet = new Set();
 let earlyFrameQueue: nativeImage[] = [];
 let firstFrameNumber = -1;
 
+// Stimuli that the native library can render are queued directly rather than drawn by
+// the stimulus window. Each run of them is queued as soon as the stimulus window has
+// produced the frames that come before it so the video stays in program order.
+type NativeRun = {
+  windowFrames: number;
+  stimuli: Stimulus[];
+};
+const NATIVE_BATCH_SIZE = 50;
+let nativeRuns: NativeRun[] = [];
+let windowFrameCount = 0;
+let windowFramesQueued = 0;
+let nativeFramesQueued = 0;
+let nativeFramesProcessing = 0;
+
 /*
  * Install tools to aid in development and debugging. We use the 'source-map-support'
  * library in production to produce useful stack traces and the 'electron-debug'
@@ -120,7 +134,11 @@ function runStopped() {
     stimulusWindow = null;
   }
 
-  // Close out video encoding
+  // Stop checking for completed frames and close out video encoding
+  if (frameCleanTimer !== null) {
+    clearInterval(frameCleanTimer);
+    frameCleanTimer = null;
+  }
   eyeNative.closeVideoOutput();
 
   // Reset internal state variables
@@ -129,6 +147,11 @@ function runStopped() {
   imageSet.clear();
   earlyFrameQueue = [];
   firstFrameNumber = -1;
+  nativeRuns = [];
+  windowFrameCount = 0;
+  windowFramesQueued = 0;
+  nativeFramesQueued = 0;
+  nativeFramesProcessing = 0;
 
   // Notify the control window
   if (controlWindow && controlWindow.webContents) {
@@ -157,6 +180,9 @@ function startFrameCleanTimer() {
       const id: string = completed[i];
       if (id in pendingFrames) {
         delete pendingFrames[id];
+      } else {
+        // Frames rendered by the native library have no image to release
+        nativeFramesProcessing -= 1;
       }
     }
 
@@ -168,7 +194,10 @@ function startFrameCleanTimer() {
     if (controlWindow && controlWindow.webContents) {
       controlWindow.webContents.send(
         'runProgress',
-        videoInfo.frameNumber - firstFrameNumber - framesProcessing,
+        windowFramesQueued +
+          nativeFramesQueued -
+          framesProcessing -
+          nativeFramesProcessing,
         videoInfo.frameCount
       );
     }
@@ -176,7 +205,9 @@ function startFrameCleanTimer() {
     // Detect when recording is complete and stop the run
     if (
       framesProcessing === 0 &&
-      videoInfo.frameNumber >= videoInfo.frameCount + firstFrameNumber
+      nativeFramesProcessing === 0 &&
+      nativeRuns.length === 0 &&
+      windowFramesQueued >= windowFrameCount
     ) {
       if (frameCleanTimer !== null) {
         clearInterval(frameCleanTimer);
@@ -187,6 +218,67 @@ function startFrameCleanTimer() {
     }
   }, 30);
 }
+
+/**
+ * The getFrameCount() function returns the number of frames that the stimulus lasts. The
+ * stimulus window renderers draw frames while the frame number is below lifespan * fps
+ * and the native library rounds the same way.
+ */
+function getFrameCount(stimulus: Stimulus) {
+  if (videoInfo === null) {
+    throw new Error('Video info not defined');
+  }
+  return Math.ceil(stimulus.lifespan * videoInfo.fps);
+}
+
+/**
+ * The queueNativeRuns() function renders every run of stimuli in the native library that
+ * the frames queued from the stimulus window have reached. It returns false if the
+ * native library stops partway through a run. The stimulus window has already been
+ * given the stimuli that follow, so the missing ones can't be drawn in their place and
+ * the recording has to be abandoned.
+ */
+function queueNativeRuns() {
+  while (
+    nativeRuns.length > 0 &&
+    nativeRuns[0].windowFrames <= windowFramesQueued
+  ) {
+    const run = nativeRuns.shift() as NativeRun;
+    const result = eyeNative.queueStimuli(run.stimuli);
+    for (let i = 0; i < result.firstFrameIds.length; i += 1) {
+      const frameCount = getFrameCount(run.stimuli[i]);
+      nativeFramesQueued += frameCount;
+      nativeFramesProcessing += frameCount;
+    }
+    if (result.firstFrameIds.length < run.stimuli.length) {
+      log(`Error: Failed to render stimuli natively: ${result.stopReason}\n`);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * The queueWindowFrame() function passes a frame captured from the stimulus window to
+ * the native layer and remembers the ID that it is assigned. Any stimuli rendered
+ * natively that follow the frame in the program are queued right behind it. It returns
+ * false if they couldn't be.
+ */
+function queueWindowFrame(image: nativeImage) {
+  if (windowFramesQueued >= windowFrameCount) {
+    return true;
+  }
+  const size = image.getSize();
+  const id: number = eyeNative.queueNextFrame(
+    image.getBitmap(),
+    size.width,
+    size.height
+  );
+  pendingFrames[id] = image;
+  windowFramesQueued += 1;
+  return queueNativeRuns();
+}
+
 function frameCaptured(image: nativeImage) {
   // The stimulus window produces a series of blank frames before we get the first
   // frame of the program. Retain all frames until we know the first frame number.
@@ -202,17 +294,12 @@ function frameCaptured(image: nativeImage) {
   // Handle the case where we've just been informed of the first frame number. We
   // detect this by the early frame queue not being empty.
   if (earlyFrameQueue.length > 0) {
-    // Pass each image since the first frame to the native layer and remember the
-    // IDs that they are assigned
+    // Pass each image since the first frame to the native layer
     for (let i = firstFrameNumber; i < earlyFrameQueue.length; i += 1) {
-      const earlyImage = earlyFrameQueue[i];
-      const size = earlyImage.getSize();
-      const id: number = eyeNative.queueNextFrame(
-        earlyImage.getBitmap(),
-        size.width,
-        size.height
-      );
-      pendingFrames[id] = earlyImage;
+      if (!queueWindowFrame(earlyFrameQueue[i])) {
+        runStopped();
+        return;
+      }
     }
 
     // Clear the queue and start the frame cleanup timer
@@ -222,19 +309,15 @@ function frameCaptured(image: nativeImage) {
 
   // Discard any frames beyond the last one that we expect while waiting for FFmpeg to
   // process any frames that are queued up
-  if (videoInfo.frameNumber >= videoInfo.frameCount + firstFrameNumber) {
+  if (windowFramesQueued >= windowFrameCount) {
     return;
   }
 
-  // Pass the new image to the native layer, remember the ID that it is assigned,
-  // and increment the frame number
-  const size = image.getSize();
-  const id: number = eyeNative.queueNextFrame(
-    image.getBitmap(),
-    size.width,
-    size.height
-  );
-  pendingFrames[id] = image;
+  // Pass the new image to the native layer and increment the frame number
+  if (!queueWindowFrame(image)) {
+    runStopped();
+    return;
+  }
   videoInfo.frameNumber += 1;
 }
 
@@ -528,6 +611,7 @@ function generateStimuli() {
     throw new Error('Program not defined');
   }
   let durationSecs = 0;
+  let frameCount = 0;
   while (true) {
     const response: ProgramNext = program.next() as ProgramNext;
     if (response.done) {
@@ -538,6 +622,7 @@ function generateStimuli() {
     }
     const stimulus: Stimulus = response.value as Stimulus;
     durationSecs += stimulus.lifespan;
+    frameCount += getFrameCount(stimulus);
     stimulusQueue.push(stimulus);
     if (stimulus.stimulusType === 'IMAGE') {
       imageSet.add((stimulus as Image).image);
@@ -568,7 +653,7 @@ function generateStimuli() {
 
   // Calculate the total number of frames we expect
   if (videoInfo !== null) {
-    videoInfo.frameCount = durationSecs * videoInfo.fps;
+    videoInfo.frameCount = frameCount;
   }
 }
 function checkFFmpeg() {
@@ -607,6 +692,48 @@ function checkFFmpeg() {
 
   return true;
 }
+
+function planNativeRuns() {
+  // Take the stimuli that the native library can render out of the queue so the
+  // stimulus window only draws the rest, and remember how many frames the stimulus
+  // window draws before each run of them. Stamped frames can only be drawn by the
+  // stimulus window.
+  if (videoInfo === null) {
+    throw new Error('Video info not defined');
+  }
+  nativeRuns = [];
+  windowFrameCount = 0;
+  const windowQueue: Stimulus[] = [];
+  let i = 0;
+  while (i < stimulusQueue.length) {
+    let count = 0;
+    if (!videoInfo.stampFrames) {
+      count = eyeNative.countNativeStimuli(
+        stimulusQueue.slice(i, i + NATIVE_BATCH_SIZE),
+        videoInfo.fps
+      );
+    }
+    if (count > 0) {
+      const stimuli = stimulusQueue.slice(i, i + count);
+      const lastRun = nativeRuns[nativeRuns.length - 1];
+      if (lastRun !== undefined && lastRun.windowFrames === windowFrameCount) {
+        lastRun.stimuli.push(...stimuli);
+      } else {
+        nativeRuns.push({ windowFrames: windowFrameCount, stimuli });
+      }
+      i += count;
+    } else {
+      windowQueue.push(stimulusQueue[i]);
+      windowFrameCount += getFrameCount(stimulusQueue[i]);
+      i += 1;
+    }
+  }
+  log(
+    `${stimulusQueue.length - windowQueue.length} stimuli rendered natively\n`
+  );
+  stimulusQueue = windowQueue;
+}
+
 function spawnFFmpeg() {
   // Calculate the location of ffprobe under the assumption that it is located in the
   // same directory as ffmpeg
@@ -627,6 +754,16 @@ function spawnFFmpeg() {
     return false;
   }
   eyeNative.initialize(videoInfo.ffmpegPath, ffprobePath, log);
+
+  // Mark the first frame of every stimulus so the encoder places a key frame there and
+  // a seek index can be written alongside the video
+  let frameNumber = 0;
+  for (let i = 0; i < stimulusQueue.length; i += 1) {
+    eyeNative.markStimulusBoundary(i, frameNumber);
+    frameNumber += getFrameCount(stimulusQueue[i]);
+  }
+  planNativeRuns();
+
   const result: string = eyeNative.createVideoOutput(
     videoInfo.width,
     videoInfo.height,
@@ -638,6 +775,11 @@ function spawnFFmpeg() {
     return false;
   }
 
+  // Queue any stimuli rendered natively that open the program
+  if (!queueNativeRuns()) {
+    return false;
+  }
+
   // Create the preview channel and pass it and the module root to the control window
   const channelName = eyeNative.createPreviewChannel();
   if (controlWindow && controlWindow.webContents) {
@@ -676,6 +818,12 @@ ipcMain.on('startProgram', (_event, stringArg: string) => {
       return;
     }
 
+    // Skip the stimulus window if every stimulus was rendered natively
+    if (windowFrameCount === 0) {
+      startFrameCleanTimer();
+      return;
+    }
+
     // Wait 200 ms and create the stimulus window
     log('Creating stimulus window...\n');
     setTimeout(function () {
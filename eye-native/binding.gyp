@@ -4,22 +4,66 @@
     "cflags!": [ "-fno-exceptions" ],
     "cflags_cc!": [ "-fno-exceptions" ],
     "sources": [
+      "src/BarGenerator.cpp",
+      "src/BenchmarkWorker.cpp",
+      "src/Blake2b.cpp",
       "src/CalibrationThread.cpp",
+      "src/CheckerboardGenerator.cpp",
+      "src/ChirpGenerator.cpp",
+      "src/Color.cpp",
+      "src/DryRunAnalyzer.cpp",
       "src/ExternalEventThread.cpp",
+      "src/EyeChartGenerator.cpp",
       "src/FfmpegPlaybackProcess.cpp",
       "src/FfmpegRecordProcess.cpp",
       "src/FfprobeProcess.cpp",
+      "src/FrameArchive.cpp",
+      "src/FrameArchiveReader.cpp",
+      "src/FrameArchiveWriter.cpp",
+      "src/FrameCode.cpp",
       "src/FrameHeader.cpp",
+      "src/FramePool.cpp",
+      "src/FrameReader.cpp",
+      "src/FrameStore.cpp",
+      "src/FrameStoreWriter.cpp",
       "src/FrameWrapper.cpp",
+      "src/GammaTable.cpp",
+      "src/GeneratorThread.cpp",
+      "src/GlyphAtlas.cpp",
+      "src/GratingGenerator.cpp",
+      "src/ImageCache.cpp",
+      "src/ImageDecodeThread.cpp",
+      "src/ImageGenerator.cpp",
+      "src/LetterGenerator.cpp",
+      "src/LuminanceTraceWriter.cpp",
+      "src/Lz4.cpp",
       "src/main.cpp",
+      "src/MkvReader.cpp",
+      "src/Mp4Reader.cpp",
       "src/Native.cpp",
+      "src/Philox.cpp",
       "src/PipeReader.cpp",
+      "src/PlaybackCache.cpp",
+      "src/PlaybackPrepareThread.cpp",
       "src/PlaybackThread.cpp",
+      "src/PresentationLog.cpp",
+      "src/PresentationLogWriter.cpp",
       "src/PreviewReceiveThread.cpp",
       "src/PreviewSendThread.cpp",
+      "src/ProbeCache.cpp",
       "src/ProjectorThread.cpp",
       "src/RecordThread.cpp",
+      "src/SeekIndex.cpp",
+      "src/SimulatedEventSource.cpp",
+      "src/SolidGenerator.cpp",
+      "src/Stimuli.cpp",
+      "src/SyncPatch.cpp",
+      "src/SyncTracker.cpp",
+      "src/TensorExportWriter.cpp",
       "src/Thread.cpp",
+      "src/TiledLetterGenerator.cpp",
+      "src/VideoInfo.cpp",
+      "src/WhiteNoiseGenerator.cpp",
       "src/Wrapper.cpp",
     ],
     'include_dirs': [
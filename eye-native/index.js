@@ -45,7 +45,9 @@ function initialize(ffmpegPath, ffprobePath, logCallback) {
 /**
  * Use the functions in this section to create a new video file, queue frames to be
  * written to that file, check periodically to see which frames have been processed,
- * and close the file when finished.
+ * and close the file when finished. Closing returns straight away while ffmpeg and the
+ * record stages finish their files in the background. The next createVideoOutput() or
+ * collectFrameStore() call waits for them.
  */
 
 function createVideoOutput(width, height, fps, outputPath) {
@@ -62,6 +64,217 @@ function queueNextFrame(buffer, width, height) {
   return native.queueNextFrame(buffer, width, height);
 }
 
+/**
+ * The queueWhiteNoise() function renders the given number of white noise frames in the
+ * native layer and queues them after any frames already queued. Cells are drawn from a
+ * truncated Gaussian the same way as WhiteNoiseRenderer and the same seed always
+ * produces the same frames. When color is false every cell is gray. Returns the ID of
+ * the first frame, the rest follow consecutively, or -1 on error. Generated frames are
+ * reported by checkCompletedFrames() like captured ones and their buffers are reused
+ * once they have been.
+ */
+function queueWhiteNoise(frameCount, rows, columns, color, seed) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueWhiteNoise(frameCount, rows, columns, color, seed);
+}
+
+/**
+ * The queueGrating() function renders a moving grating in the native layer and queues
+ * its frames like queueWhiteNoise(). Set sinusoidal to true for a SinusoidalGrating and
+ * false for a square Grating. The speed is in pixels per second, the bar width in
+ * pixels, and the angle in radians, matching the stimulus types. Returns the ID of the
+ * first frame or -1 on error.
+ */
+function queueGrating(frameCount, sinusoidal, speed, barWidth, angle, barColor,
+    backgroundColor) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueGrating(frameCount, sinusoidal, speed, barWidth, angle, barColor,
+    backgroundColor);
+}
+
+/**
+ * The queueChirp() function renders a full-field chirp in the native layer and queues
+ * its frames like queueWhiteNoise(). The parameters match the Chirp stimulus type.
+ * Returns the ID of the first frame or -1 on error.
+ */
+function queueChirp(frameCount, f0, f1, a0, a1, t1, phi) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueChirp(frameCount, f0, f1, a0, a1, t1, phi);
+}
+
+/**
+ * The queueSolid(), queueCheckerboard(), and queueBar() functions render the Solid,
+ * Checkerboard, and Bar stimuli in the native layer and queue their frames like
+ * queueWhiteNoise(). The parameters match the stimulus types. Frames that don't change
+ * are passed on as repeats of the previous frame without being rendered again. Each
+ * returns the ID of the first frame or -1 on error.
+ */
+function queueSolid(frameCount, color) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueSolid(frameCount, color);
+}
+
+function queueCheckerboard(frameCount, color, alternateColor, size, angle) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueCheckerboard(frameCount, color, alternateColor, size, angle);
+}
+
+function queueBar(frameCount, speed, barWidth, angle, barColor, backgroundColor) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueBar(frameCount, speed, barWidth, angle, barColor, backgroundColor);
+}
+
+/**
+ * The queueLetter(), queueTiledLetter(), and queueEyeChart() functions render the
+ * Letter, TiledLetter, and EyeChart stimuli in the native layer and queue their frames
+ * like queueWhiteNoise(). The parameters match the stimulus types and the letters must
+ * be Sloan letters (C, D, H, K, N, O, R, S, V, or Z). Each returns the ID of the first
+ * frame or -1 on error.
+ */
+function queueLetter(frameCount, letter, x, y, size, color, backgroundColor) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueLetter(frameCount, letter, x, y, size, color, backgroundColor);
+}
+
+function queueTiledLetter(frameCount, letter, size, padding, color, angle,
+    backgroundColor) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueTiledLetter(frameCount, letter, size, padding, color, angle,
+    backgroundColor);
+}
+
+function queueEyeChart(frameCount, letterMatrix, size, padding, color, backgroundColor) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueEyeChart(frameCount, letterMatrix.map((row) => row.join('')), size,
+    padding, color, backgroundColor);
+}
+
+/**
+ * The queueStimuli() function renders a batch of stimuli in the native layer and queues
+ * their frames like queueWhiteNoise(), bypassing the stimulus window entirely. Pass the
+ * stimulus objects produced by the program in order. Stimuli are queued up to the first
+ * one that can't be rendered natively, such as an Image or a stimulus with an invalid
+ * field, which must then be drawn and captured by the stimulus window before the rest of
+ * the batch is passed in again. Frame stamping is not supported natively. A stimulus
+ * lasts Math.ceil(lifespan * fps) frames and white noise without a seed is seeded with
+ * the index of its first frame in the video. Returns an object containing the ID of the
+ * first frame of each queued stimulus (firstFrameIds) and the reason the batch stopped
+ * early, if it did (stopReason).
+ *
+ * The countNativeStimuli() function returns how many of the leading stimuli in the batch
+ * queueStimuli() would render at the given frame rate, without queueing anything, so a
+ * program can be split between the native layer and the stimulus window before it
+ * starts. Returns -1 if the batch can't be parsed.
+ *
+ * The setNativeLetters() function controls whether queueStimuli() and
+ * countNativeStimuli() render Letter, TiledLetter, and EyeChart stimuli natively. It's
+ * off by default because the native glyphs approximate the Sloan font that the stimulus
+ * window draws with rather than matching it pixel for pixel, so acuity programs keep
+ * their optotypes unless this is turned on.
+ */
+function queueStimuli(stimuli) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.queueStimuli(JSON.stringify(stimuli));
+}
+
+function countNativeStimuli(stimuli, fps) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.countNativeStimuli(JSON.stringify(stimuli), fps);
+}
+
+function setNativeLetters(enabled) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setNativeLetters(enabled);
+}
+
+/**
+ * The queueImage() function renders the Image stimulus in the native layer and queues
+ * its frames like queueWhiteNoise(). The image is the path of the picture on disk and
+ * the scale is either a number or an array of horizontal and vertical scale factors.
+ * Decoded and scaled frames are kept in a cache so a picture shown many times is only
+ * decoded once. Returns the ID of the first frame or -1 on error.
+ */
+function queueImage(frameCount, image, fixationPoint, scale, backgroundColor) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  const [scaleX, scaleY] = typeof scale === 'number' ? [scale, scale] : scale;
+  return native.queueImage(frameCount, image, fixationPoint.x, fixationPoint.y, scaleX,
+    scaleY, backgroundColor);
+}
+
+/**
+ * The configureImageCache() function replaces the image cache with one that holds up
+ * to the given number of megabytes of decoded frames and decodes with the given number
+ * of worker threads. By default the cache holds 1024 megabytes and uses one worker per
+ * core. Returns an empty string on success or an error message.
+ */
+function configureImageCache(maxMegabytes, workerCount) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.configureImageCache(maxMegabytes, workerCount);
+}
+
+/**
+ * The prefetchImages() function starts decoding the pictures of upcoming Image stimuli
+ * in the background so they're ready by the time they're queued. Pass the next few
+ * stimuli of the program as objects with the same image, fixationPoint, scale, and
+ * backgroundColor properties as queueImage() takes. Call this while recording. Returns
+ * an empty string on success or the first error message.
+ */
+function prefetchImages(images) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  for (let i = 0; i < images.length; i += 1) {
+    const { image, fixationPoint, scale, backgroundColor } = images[i];
+    const [scaleX, scaleY] = typeof scale === 'number' ? [scale, scale] : scale;
+    const error = native.prefetchImage(image, fixationPoint.x, fixationPoint.y, scaleX,
+      scaleY, backgroundColor);
+    if (error !== '') {
+      return error;
+    }
+  }
+  return '';
+}
+
+/**
+ * The getImageCacheStatistics() function returns an object containing the number of
+ * images that were ready when they were needed (hits) and that had to be waited for
+ * (misses) as well as the number of entries and bytes held by the cache.
+ */
+function getImageCacheStatistics() {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.getImageCacheStatistics();
+}
+
 function checkCompletedFrames() {
   if (native === null) {
     throw new Error('Native module has not been initialized');
@@ -76,19 +289,253 @@ function closeVideoOutput() {
   native.closeVideoOutput();
 }
 
+/**
+ * The markStimulusBoundary() function records that the given stimulus starts at the
+ * given frame of the video. Boundaries marked before createVideoOutput() is called
+ * become forced key frames. Once the closed output has been finished, a seek index
+ * mapping each stimulus to its frame, byte offset, and timestamp is written next to
+ * the video.
+ */
+function markStimulusBoundary(stimulusId, frameNumber) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.markStimulusBoundary(stimulusId, frameNumber);
+}
+
+/**
+ * The enableFrameArchive() function asks the next recording to also store every frame
+ * bit-exactly in a frame archive at the given path. The compression can be "lz4" or
+ * "none". Archives use the ".frames" extension and can be passed to
+ * beginVideoPlayback() in place of a video file. Call this before createVideoOutput().
+ */
+function enableFrameArchive(archivePath, compression) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.enableFrameArchive(archivePath, compression);
+}
+
+/**
+ * The benchmarkFrameArchive() function writes the given number of synthetic frames to
+ * a temporary archive and reads them back on a worker thread. It returns a promise that
+ * resolves to an object containing the writer and reader throughput in MB/s and the
+ * compression ratio.
+ */
+function benchmarkFrameArchive(archivePath, width, height, frameCount, compression) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.benchmarkFrameArchive(archivePath, width, height, frameCount,
+    compression);
+}
+
+/**
+ * The enableFrameStore() function asks the next recording to add its frames to the
+ * content-addressed frame store at the given path. Each unique frame is stored once
+ * across all runs and the frames of this run are listed in order in a manifest named
+ * after the run. The compression can be "lz4" or "none". Call this before
+ * createVideoOutput().
+ */
+function enableFrameStore(storePath, runName, compression) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.enableFrameStore(storePath, runName, compression);
+}
+
+/**
+ * The collectFrameStore() function deletes every frame in the store that is not listed
+ * in a manifest. Delete the manifests of unwanted runs first. Recordings lock the store
+ * while they write to it, so this fails without deleting anything if one is underway in
+ * any process, and a recording can't start while this runs. Returns an object
+ * containing the number of frames and bytes removed and the number of frames kept.
+ */
+function collectFrameStore(storePath) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.collectFrameStore(storePath);
+}
+
+/**
+ * The enableLuminanceTrace() function asks the next recording to write the mean
+ * luminance, RMS contrast, minimum, and maximum of every frame to a trace next to the
+ * video. The format can be "csv" or "binary". Pass a non-zero number of grid rows and
+ * columns to also measure each cell of a grid. Call this before createVideoOutput().
+ */
+function enableLuminanceTrace(format, gridRows, gridColumns) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.enableLuminanceTrace(format, gridRows, gridColumns);
+}
+
+/**
+ * The enableTensorExport() function asks the next recording to area-downsample every
+ * frame to the given size in grayscale and append it to memory-mapped .npy files next to
+ * the video. The format can be "uint8" or "float32". Each shard is preallocated for the
+ * given number of frames, so pass the total frame count to get a single file. Call this
+ * before createVideoOutput().
+ */
+function enableTensorExport(width, height, format, framesPerShard) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.enableTensorExport(width, height, format, framesPerShard);
+}
+
+/**
+ * The enableDryRun() function makes the next recording a dry run. Frames are queued and
+ * completed as usual but nothing is encoded or previewed, so a program runs as fast as
+ * its frames can be rendered. Every frame is measured and the results are returned by
+ * getDryRunStatistics(). Pixels with a red, green, or blue level outside gamutMin and
+ * gamutMax, each an array of three levels from 0 to 255, are counted as out of gamut.
+ * The output path passed to createVideoOutput() is only used by the other record stages.
+ * Call this before createVideoOutput().
+ */
+function enableDryRun(gamutMin = [0, 0, 0], gamutMax = [255, 255, 255]) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.enableDryRun(gamutMin, gamutMax);
+}
+
+/**
+ * The getDryRunStatistics() function returns the statistics of the current or last dry
+ * run: the frame count, the duration in seconds, the luminance range and mean from 0 to
+ * 1, the number of frames out of gamut, and the first such frame or -1. The same
+ * statistics are returned for each stimulus marked with markStimulusBoundary() in the
+ * stimuli array along with the stimulus ID and its first frame.
+ */
+function getDryRunStatistics() {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.getDryRunStatistics();
+}
+
+/**
+ * The loadGammaTable() function loads a table that corrects frames for the measured
+ * transfer curve of a projector from a calibration file. The target is either "record",
+ * to correct frames before they're encoded, or "playback", to correct frames just
+ * before they're displayed so one video can be shown on rigs with different
+ * calibrations. The file holds an optional "bits <n>" line with a precision of 8, 10, or
+ * 16 followed by 256 lines of output levels, either one per line or separate red,
+ * green, and blue levels. Pass an empty path to remove the table. The table takes effect
+ * from the next recording or playback. Returns an empty string on success or an error
+ * message.
+ */
+function loadGammaTable(path, target) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.loadGammaTable(path, target);
+}
+
+/**
+ * The enableSyncPatch() function paints a square patch into a corner of every frame
+ * during playback so a photodiode over that corner can time when each frame actually
+ * reached the screen. The corner is "top-left", "top-right", "bottom-left", or
+ * "bottom-right" and the size is in pixels. In "alternate" mode the patch is white on
+ * every other frame and in "sequence" mode it follows a pseudorandom sequence, which
+ * keeps missed events from being mistaken for a shift in latency. The photodiode events
+ * normally come from the timing card. Pass a simulation object with latencyMs, jitterMs,
+ * missRate, and an optional seed to generate them instead. The patch is painted after
+ * gamma correction and takes effect from the next playback. Returns an empty string on
+ * success or an error message. The disableSyncPatch() function removes the patch.
+ *
+ * The getSyncStatistics() function returns the measurements of the current or last
+ * playback that used the patch: the number of frames presented and dropped, the number
+ * of times the patch turned on, the events matched to those onsets, the onsets that
+ * were missed, the events that couldn't be matched, and the mean, standard deviation,
+ * minimum, maximum, and last latency in milliseconds.
+ */
+function enableSyncPatch(corner, size, mode, simulation = null) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  if (simulation === null) {
+    return native.enableSyncPatch(corner, size, mode, false, 0, 0, 0, 0);
+  }
+  return native.enableSyncPatch(corner, size, mode, true, simulation.latencyMs,
+    simulation.jitterMs, simulation.missRate, simulation.seed || 0);
+}
+
+function disableSyncPatch() {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.disableSyncPatch();
+}
+
+function getSyncStatistics() {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.getSyncStatistics();
+}
+
+/**
+ * The enableFrameCode() function paints the frame number into every frame so footage of
+ * the projector from a camera or photodiode array can be aligned to the source frames
+ * offline. The target is either "record", to paint the code into the video as it's
+ * encoded, or "playback", to paint it just before each frame is displayed. The code is
+ * a strip of square cells with its top left corner at (x, y): a white and a black
+ * reference cell, the frame number in Gray code using the given number of bits from 1
+ * to 31, and a parity cell. A recorded code counts from zero at the first frame of each
+ * video. The code is painted after gamma correction and takes effect from the next
+ * recording or playback. Returns an empty string on success or an error
+ * message. The disableFrameCode() function removes the code from the target.
+ *
+ * The decodeFrameCodes() function reads the frame numbers back from an array of
+ * captured image files and returns them in an Int32Array, with -1 for each image in
+ * which no valid code was found. The region gives the position of the strip and the
+ * size of its cells in image pixels, which may differ horizontally and vertically,
+ * along with the number of bits. Images are decoded in parallel.
+ */
+function enableFrameCode(target, x, y, cellSize, bits) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.enableFrameCode(target, x, y, cellSize, bits);
+}
+
+function disableFrameCode(target) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.disableFrameCode(target);
+}
+
+function decodeFrameCodes(paths, region) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.decodeFrameCodes(paths, region.x, region.y, region.cellWidth,
+    region.cellHeight, region.bits);
+}
+
 /**
  * Use the functions in this section to create a full screen window on the projector,
  * play a series of video file to it, and close when finished. The helper function
  * getDisplayFrequency() allows us to get a monitor's display frequency.
+ *
+ * The optional startPosition resumes an interrupted playlist part way through. It is
+ * either { video, frame }, a zero-based video index and frame number within that video,
+ * or { ms }, a time from the start of the playlist. The duration and position callbacks
+ * still report times relative to the start of the playlist.
  */
 
 function beginVideoPlayback(x, y, videos, scaleToFit, durationCallback,
-    positionCallback, delayCallback) {
+    positionCallback, delayCallback, startPosition) {
   if (native === null) {
     throw new Error('Native module has not been initialized');
   }
+  const start = startPosition || {};
   return native.beginVideoPlayback(x, y, videos, scaleToFit, durationCallback,
-    positionCallback, delayCallback);
+    positionCallback, delayCallback, start.video || 0, start.frame || 0,
+    start.ms === undefined ? -1 : start.ms);
 }
 
 function endVideoPlayback() {
@@ -98,6 +545,139 @@ function endVideoPlayback() {
   return native.endVideoPlayback();
 }
 
+/**
+ * The setDecoderLookahead() function sets how many videos beyond the one playing are
+ * decoded ahead of time so playback moves from one file to the next without a gap. Each
+ * of them buffers one second of frames until its turn comes. The default is 1 and 0
+ * starts each decoder only when its video comes up. Takes effect from the next playback
+ * and returns an empty string on success or an error message.
+ *
+ * The setPlaybackBufferSize() function sets how many megabytes of decoded frames may be
+ * held between the decoders and the projector, shared by the video that's playing and
+ * those decoded ahead of it. The default is 2048. Playback starts once enough frames are
+ * buffered to reach the end of the playlist at the measured decode rate, so a larger
+ * buffer helps most when decoding is slower than the display.
+ */
+function setDecoderLookahead(videoCount) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setDecoderLookahead(videoCount);
+}
+
+function setPlaybackBufferSize(maxMegabytes) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setPlaybackBufferSize(maxMegabytes);
+}
+
+/**
+ * The setDecodeToDisplay() function controls whether ffmpeg scales and pads each video
+ * to the projector's resolution while decoding. Frames then reach the projector ready to
+ * be copied to the screen, which takes the scaling off the display path and makes
+ * buffered frames match the projector's size rather than the video's. The picture is the
+ * same as when the projector scales. Frame archives and prepared videos are still shown
+ * at the size they were prepared with. Off by default and takes effect from the next
+ * playback.
+ */
+function setDecodeToDisplay(enabled) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setDecodeToDisplay(enabled);
+}
+
+/**
+ * The setStarvationPolicy() function chooses what the projector does after falling
+ * behind because frames weren't decoded in time. "drift" carries on and leaves the rest
+ * of the playlist late, "drop" skips frames until playback is back on time, and "pause"
+ * holds the current frame until the buffer has been rebuilt. Every frame that was held
+ * on the screen for too long or skipped is written to the log with its frame number and
+ * time so the stimulus can still be aligned. The default is "drift" and it takes effect
+ * from the next playback.
+ */
+function setStarvationPolicy(policy) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setStarvationPolicy(policy);
+}
+
+/**
+ * The setPresentationLogPath() function sets the file that the next playback records
+ * every frame's presentation in. Each record holds the video index, frame number,
+ * target time, timing card timestamp of the present, delay, and flags for skipped,
+ * late, and resumed frames and a lit sync patch. Records are written from their own
+ * thread so logging never holds up the display. An empty path turns the log off.
+ *
+ * The exportPresentationLog() function converts a presentation log to CSV or to a
+ * NumPy structured array depending on whether the output path ends in ".csv" or
+ * ".npy". Both return an empty string on success or an error message.
+ */
+function setPresentationLogPath(path) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setPresentationLogPath(path);
+}
+
+function exportPresentationLog(logPath, outputPath) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.exportPresentationLog(logPath, outputPath);
+}
+
+/**
+ * The setProbeCachePath() function sets the file used to remember the dimensions, frame
+ * rate, and length of each video so a playlist doesn't have to be examined with ffprobe
+ * every time it's played. Entries are matched on the video's path, size, and
+ * modification time. A file in the app's user data directory works well and an empty
+ * path turns the cache off. Returns an empty string on success or an error message.
+ */
+function setProbeCachePath(path) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setProbeCachePath(path);
+}
+
+/**
+ * The setPlaybackCache() function sets the directory on fast local disk where playlists
+ * are stored after being decoded by beginPlaybackPreparation(). Playback then reads
+ * each prepared video's frames straight from its memory-mapped file without running
+ * ffmpeg. The least recently played videos are deleted to keep the directory under the
+ * given number of megabytes, and an empty directory turns the cache off. Returns an
+ * empty string on success or an error message.
+ *
+ * The beginPlaybackPreparation() function decodes every video in the playlist that
+ * isn't already in the cache. The compression can be "none", which costs the least to
+ * play, or "lz4", which saves space on stimuli with large flat areas. The progress
+ * callback receives the percentage of frames done and is passed 100 at the end. Call
+ * endPlaybackPreparation() to stop early or once preparation is complete.
+ */
+function setPlaybackCache(directory, maxMegabytes) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.setPlaybackCache(directory, maxMegabytes);
+}
+
+function beginPlaybackPreparation(videos, compression, progressCallback) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.beginPlaybackPreparation(videos, compression, progressCallback);
+}
+
+function endPlaybackPreparation() {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  native.endPlaybackPreparation();
+}
+
 function getDisplayFrequencies(x, y) {
   if (native === null) {
     throw new Error('Native module has not been initialized');
@@ -105,6 +685,21 @@ function getDisplayFrequencies(x, y) {
   return native.getDisplayFrequencies(x, y);
 }
 
+/**
+ * The benchmarkVideoDecode() function measures how fast decoded video reaches the
+ * projector. It passes a file of raw BGRA frames with the given dimensions through
+ * ffmpeg and the same frame reader used during playback on a worker thread. It returns
+ * a promise that resolves to an object containing the number of frames read, the frames
+ * per second, and the throughput in MB/s. Compare the result with the frame size times
+ * the display rate to see how much headroom playback has.
+ */
+function benchmarkVideoDecode(rawPath, width, height) {
+  if (native === null) {
+    throw new Error('Native module has not been initialized');
+  }
+  return native.benchmarkVideoDecode(rawPath, width, height);
+}
+
 /**
  * The functions in this section give us the ability to process a video in the main thread
  * and show a preview of it in a BrowserWindow, all without having to use the Electron
@@ -167,11 +762,54 @@ module.exports = {
   initialize,
   createVideoOutput,
   queueNextFrame,
+  queueWhiteNoise,
+  queueGrating,
+  queueChirp,
+  queueSolid,
+  queueCheckerboard,
+  queueBar,
+  queueLetter,
+  queueTiledLetter,
+  queueEyeChart,
+  queueStimuli,
+  countNativeStimuli,
+  setNativeLetters,
+  queueImage,
+  configureImageCache,
+  prefetchImages,
+  getImageCacheStatistics,
   checkCompletedFrames,
   closeVideoOutput,
+  markStimulusBoundary,
+  enableFrameArchive,
+  benchmarkFrameArchive,
+  enableFrameStore,
+  collectFrameStore,
+  enableLuminanceTrace,
+  enableTensorExport,
+  enableDryRun,
+  getDryRunStatistics,
+  loadGammaTable,
+  enableSyncPatch,
+  disableSyncPatch,
+  getSyncStatistics,
+  enableFrameCode,
+  disableFrameCode,
+  decodeFrameCodes,
   beginVideoPlayback,
   endVideoPlayback,
+  setDecoderLookahead,
+  setPlaybackBufferSize,
+  setDecodeToDisplay,
+  setStarvationPolicy,
+  setPresentationLogPath,
+  exportPresentationLog,
+  setProbeCachePath,
+  setPlaybackCache,
+  beginPlaybackPreparation,
+  endPlaybackPreparation,
   getDisplayFrequencies,
+  benchmarkVideoDecode,
   createPreviewChannel,
   openPreviewChannel,
   getNextFrame,
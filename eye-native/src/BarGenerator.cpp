@@ -0,0 +1,115 @@
+#include "BarGenerator.h"
+#include "Color.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// Narrows the span [start, end) to the integer positions x where
+// lower <= offset + slope * x < upper
+static void clipSpan(double offset, double slope, double lower, double upper,
+  double& start, double& end)
+{
+  if (slope == 0.0)
+  {
+    if ((offset < lower) || (offset >= upper))
+    {
+      end = start;
+    }
+    return;
+  }
+  double a = (lower - offset) / slope, b = (upper - offset) / slope;
+  if (slope > 0.0)
+  {
+    start = max(start, ceil(a));
+    end = min(end, ceil(b));
+  }
+  else
+  {
+    start = max(start, floor(b) + 1);
+    end = min(end, floor(a) + 1);
+  }
+}
+
+BarGenerator::BarGenerator(uint32_t count, uint32_t f, double s, double w, double a,
+    string bar, string background) :
+  FrameGenerator("bar", count),
+  fps(f),
+  speed(s),
+  barWidth(w),
+  angle(a),
+  barColor(bar),
+  backgroundColor(background)
+{
+}
+
+bool BarGenerator::open(uint32_t wid, uint32_t hgt, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(barColor, red, green, blue))
+  {
+    error = "Unknown color " + barColor;
+    return false;
+  }
+  uint32_t barPixel = color::toPixel(red, green, blue);
+  if (!color::parse(backgroundColor, red, green, blue))
+  {
+    error = "Unknown color " + backgroundColor;
+    return false;
+  }
+  uint32_t backgroundPixel = color::toPixel(red, green, blue);
+  if (fps == 0)
+  {
+    error = "Invalid frame rate";
+    return false;
+  }
+  width = wid;
+  height = hgt;
+  diagonal = sqrt((double)width * width + (double)height * height);
+  backgroundRow.resize((size_t)width * 4);
+  color::fillPixels(backgroundRow.data(), backgroundPixel, width);
+  barRow.resize((size_t)width * 4);
+  color::fillPixels(barRow.data(), barPixel, width);
+  return true;
+}
+
+void BarGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  // Position the center of the bar the way the renderer does
+  double timeDelta = frameNumber * (1.0 / fps);
+  double distance = diagonal / 2 - speed * timeDelta;
+  double centerX = (barWidth / 2) * cos(-angle) + distance * cos(-angle) + width / 2.0;
+  double centerY = (barWidth / 2) * sin(-angle) + distance * sin(-angle) + height / 2.0;
+
+  // The bar spans these coordinates once the rotation is undone
+  double left = floor(-barWidth / 2 + 0.5), top = floor(-diagonal / 2 + 0.5);
+  double right = left + barWidth, bottom = top + diagonal;
+
+  // Intersect each row with the bar, sampling at pixel centers, and copy the spans
+  double cosAngle = cos(angle), sinAngle = sin(angle);
+  double dx = 0.5 - centerX;
+  size_t stride = (size_t)width * 4;
+  for (uint32_t y = 0; y < height; ++y)
+  {
+    double dy = y + 0.5 - centerY;
+    double start = 0.0, end = width;
+    clipSpan(dx * cosAngle - dy * sinAngle, cosAngle, left, right, start, end);
+    clipSpan(dx * sinAngle + dy * cosAngle, sinAngle, top, bottom, start, end);
+    size_t spanStart = 0, spanEnd = 0;
+    if (start < end)
+    {
+      spanStart = (size_t)start * 4;
+      spanEnd = (size_t)end * 4;
+    }
+    uint8_t* row = dest + y * stride;
+    memcpy(row, backgroundRow.data(), spanStart);
+    memcpy(row + spanStart, barRow.data(), spanEnd - spanStart);
+    memcpy(row + spanEnd, backgroundRow.data(), stride - spanEnd);
+  }
+}
+
+bool BarGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (speed == 0.0) && (frameNumber > 0);
+}
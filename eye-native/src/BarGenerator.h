@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The BarGenerator class renders the Bar stimulus, a bar of the given width that is as
+// long as the frame diagonal and sweeps across the frame at the given speed in pixels
+// per second. The angle in radians gives the direction of travel. This matches
+// BarRenderer in the stimulus window.
+//
+// The bar covers at most one span of each row, so each row is written as up to three
+// spans copied from a row of background pixels and a row of bar pixels prepared when
+// the generator is opened.
+class BarGenerator : public FrameGenerator
+{
+public:
+  BarGenerator(uint32_t frameCount, uint32_t fps, double speed, double barWidth,
+    double angle, std::string barColor, std::string backgroundColor);
+  virtual ~BarGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  uint32_t fps;
+  double speed;
+  double barWidth;
+  double angle;
+  std::string barColor;
+  std::string backgroundColor;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  double diagonal = 0.0;
+  std::vector<uint8_t> backgroundRow;
+  std::vector<uint8_t> barRow;
+};
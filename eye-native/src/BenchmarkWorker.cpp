@@ -0,0 +1,42 @@
+#include "BenchmarkWorker.h"
+
+using namespace std;
+
+BenchmarkWorker::BenchmarkWorker(Napi::Env env,
+    function<string(BenchmarkResults& results)> func) :
+  Napi::AsyncWorker(env),
+  deferred(Napi::Promise::Deferred::New(env)),
+  benchmark(func)
+{
+}
+
+Napi::Promise BenchmarkWorker::getPromise()
+{
+  return deferred.Promise();
+}
+
+void BenchmarkWorker::Execute()
+{
+  // Runs on the worker thread
+  string error = benchmark(results);
+  if (!error.empty())
+  {
+    SetError(error);
+  }
+}
+
+void BenchmarkWorker::OnOK()
+{
+  Napi::Env env = Env();
+  Napi::Object result = Napi::Object::New(env);
+  for (auto it = results.begin(); it != results.end(); ++it)
+  {
+    result.Set(it->first, Napi::Number::New(env, it->second));
+  }
+  deferred.Resolve(result);
+}
+
+void BenchmarkWorker::OnError(const Napi::Error& error)
+{
+  deferred.Reject(error.Value());
+}
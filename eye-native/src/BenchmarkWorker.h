@@ -0,0 +1,35 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <napi.h>
+
+// The named numbers that a benchmark reports
+typedef std::vector<std::pair<std::string, double>> BenchmarkResults;
+
+// The BenchmarkWorker class runs a benchmark on a worker thread from the Node.js pool
+// and settles a promise when it's done, so a benchmark that takes seconds doesn't block
+// the JavaScript thread. The promise resolves to an object holding each of the results
+// or rejects with the error the benchmark returned. The benchmark must not touch any
+// JavaScript values.
+class BenchmarkWorker : public Napi::AsyncWorker
+{
+public:
+  BenchmarkWorker(Napi::Env env,
+    std::function<std::string(BenchmarkResults& results)> benchmark);
+  virtual ~BenchmarkWorker() {};
+
+  Napi::Promise getPromise();
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error& error) override;
+
+private:
+  Napi::Promise::Deferred deferred;
+  std::function<std::string(BenchmarkResults& results)> benchmark;
+  BenchmarkResults results;
+};
@@ -0,0 +1,171 @@
+#include "Blake2b.h"
+#include <cstring>
+
+using namespace std;
+
+// Block size in bytes and number of rounds
+#define BLOCK_SIZE 128
+#define ROUNDS 12
+
+static const uint64_t initVector[8] =
+{
+  0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL,
+  0xA54FF53A5F1D36F1ULL, 0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+  0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+};
+
+static const uint8_t sigma[12][16] =
+{
+  { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+  { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+  { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+  { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+  { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+  { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+  { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+  { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+  { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+  { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 }
+};
+
+static inline uint64_t rotateRight(uint64_t value, uint32_t bits)
+{
+  return (value >> bits) | (value << (64 - bits));
+}
+
+static inline uint64_t readLittleEndian64(const uint8_t* data)
+{
+  return (uint64_t)data[0] | ((uint64_t)data[1] << 8) | ((uint64_t)data[2] << 16) |
+    ((uint64_t)data[3] << 24) | ((uint64_t)data[4] << 32) | ((uint64_t)data[5] << 40) |
+    ((uint64_t)data[6] << 48) | ((uint64_t)data[7] << 56);
+}
+
+#define MIX(a, b, c, d, x, y) \
+  a = a + b + x; \
+  d = rotateRight(d ^ a, 32); \
+  c = c + d; \
+  b = rotateRight(b ^ c, 24); \
+  a = a + b + y; \
+  d = rotateRight(d ^ a, 16); \
+  c = c + d; \
+  b = rotateRight(b ^ c, 63);
+
+Blake2b::Blake2b(uint32_t length) :
+  bufferLength(0),
+  digestLength(length)
+{
+  // Initialize the state with the parameter block for an unkeyed hash
+  memcpy(state, initVector, sizeof(state));
+  state[0] ^= 0x01010000ULL ^ digestLength;
+  counter[0] = 0;
+  counter[1] = 0;
+}
+
+void Blake2b::update(const uint8_t* data, size_t length)
+{
+  // The final block must be compressed with the last block flag set so always keep at
+  // least one byte buffered until finish() is called
+  while (length > 0)
+  {
+    if (bufferLength == BLOCK_SIZE)
+    {
+      counter[0] += BLOCK_SIZE;
+      if (counter[0] < BLOCK_SIZE)
+      {
+        counter[1] += 1;
+      }
+      compress(buffer, false);
+      bufferLength = 0;
+    }
+
+    // Compress whole blocks straight from the input when nothing is buffered
+    if (bufferLength == 0)
+    {
+      while (length > BLOCK_SIZE)
+      {
+        counter[0] += BLOCK_SIZE;
+        if (counter[0] < BLOCK_SIZE)
+        {
+          counter[1] += 1;
+        }
+        compress(data, false);
+        data += BLOCK_SIZE;
+        length -= BLOCK_SIZE;
+      }
+    }
+    size_t chunk = BLOCK_SIZE - bufferLength;
+    if (chunk > length)
+    {
+      chunk = length;
+    }
+    memcpy(buffer + bufferLength, data, chunk);
+    bufferLength += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+void Blake2b::finish(uint8_t* digest)
+{
+  counter[0] += bufferLength;
+  if (counter[0] < bufferLength)
+  {
+    counter[1] += 1;
+  }
+  memset(buffer + bufferLength, 0, BLOCK_SIZE - bufferLength);
+  compress(buffer, true);
+  for (uint32_t i = 0; i < digestLength; ++i)
+  {
+    digest[i] = (uint8_t)(state[i / 8] >> (8 * (i % 8)));
+  }
+}
+
+string Blake2b::toHex(const uint8_t* digest, size_t length)
+{
+  static const char digits[] = "0123456789abcdef";
+  string hex(length * 2, '0');
+  for (size_t i = 0; i < length; ++i)
+  {
+    hex[i * 2] = digits[digest[i] >> 4];
+    hex[i * 2 + 1] = digits[digest[i] & 0x0F];
+  }
+  return hex;
+}
+
+void Blake2b::compress(const uint8_t* block, bool lastBlock)
+{
+  uint64_t m[16], v[16];
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    m[i] = readLittleEndian64(block + i * 8);
+  }
+  for (uint32_t i = 0; i < 8; ++i)
+  {
+    v[i] = state[i];
+    v[i + 8] = initVector[i];
+  }
+  v[12] ^= counter[0];
+  v[13] ^= counter[1];
+  if (lastBlock)
+  {
+    v[14] = ~v[14];
+  }
+  for (uint32_t round = 0; round < ROUNDS; ++round)
+  {
+    const uint8_t* s = sigma[round];
+    MIX(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+    MIX(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+    MIX(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+    MIX(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+    MIX(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+    MIX(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+    MIX(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+    MIX(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+  }
+  for (uint32_t i = 0; i < 8; ++i)
+  {
+    state[i] ^= v[i] ^ v[i + 8];
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// The Blake2b class implements the BLAKE2b cryptographic hash (RFC 7693). It is used to
+// identify frames by their content and was chosen over SHA-256 because it is roughly
+// twice as fast in portable code, which matters when hashing every frame as it is
+// recorded.
+class Blake2b
+{
+public:
+  Blake2b(uint32_t digestLength = 32);
+  virtual ~Blake2b() {};
+
+  void update(const uint8_t* data, size_t length);
+  void finish(uint8_t* digest);
+
+  static std::string toHex(const uint8_t* digest, size_t length);
+
+private:
+  void compress(const uint8_t* block, bool lastBlock);
+
+private:
+  uint64_t state[8];
+  uint64_t counter[2];
+  uint8_t buffer[128];
+  size_t bufferLength;
+  uint32_t digestLength;
+};
@@ -0,0 +1,95 @@
+#include "CheckerboardGenerator.h"
+#include "Color.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+CheckerboardGenerator::CheckerboardGenerator(uint32_t count, string col, string alternate,
+    double s, double a) :
+  FrameGenerator("checkerboard", count),
+  color(col),
+  alternateColor(alternate),
+  size(s),
+  angle(a)
+{
+}
+
+bool CheckerboardGenerator::open(uint32_t width, uint32_t height, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(color, red, green, blue))
+  {
+    error = "Unknown color " + color;
+    return false;
+  }
+  uint32_t pixel = color::toPixel(red, green, blue);
+  if (!color::parse(alternateColor, red, green, blue))
+  {
+    error = "Unknown color " + alternateColor;
+    return false;
+  }
+  uint32_t alternatePixel = color::toPixel(red, green, blue);
+  if (!(size >= 1.0))
+  {
+    error = "Invalid checkerboard size";
+    return false;
+  }
+
+  // The renderer repeats a pattern two squares wide in whole pixels
+  uint32_t length = (uint32_t)(size * 2);
+  size_t stride = (size_t)width * 4;
+  frame.resize(stride * height);
+  if (angle == 0)
+  {
+    // Without rotation every row is one of two patterns, so build both and copy them
+    // into place
+    vector<uint32_t> rows[2];
+    for (uint32_t parity = 0; parity < 2; ++parity)
+    {
+      rows[parity].resize(width);
+      for (uint32_t x = 0; x < width; ++x)
+      {
+        bool first = ((x % length) + 0.5 < size);
+        rows[parity][x] = (first == (parity == 0)) ? pixel : alternatePixel;
+      }
+    }
+    for (uint32_t y = 0; y < height; ++y)
+    {
+      uint32_t parity = ((y % length) + 0.5 < size) ? 0 : 1;
+      memcpy(&frame[y * stride], rows[parity].data(), stride);
+    }
+  }
+  else
+  {
+    // Map the center of each pixel into pattern space by undoing the rotation about the
+    // center of the frame
+    double diagonal = sqrt((double)width * width + (double)height * height);
+    double cosAngle = cos(angle), sinAngle = sin(angle);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+      uint32_t* row = (uint32_t*)&frame[y * stride];
+      double dy = y + 0.5 - height / 2.0;
+      for (uint32_t x = 0; x < width; ++x)
+      {
+        double dx = x + 0.5 - width / 2.0;
+        double u = fmod(floor(dx * cosAngle - dy * sinAngle + diagonal / 2), length);
+        double v = fmod(floor(dx * sinAngle + dy * cosAngle + diagonal / 2), length);
+        u += (u < 0) ? length : 0;
+        v += (v < 0) ? length : 0;
+        row[x] = (((u + 0.5) < size) == ((v + 0.5) < size)) ? pixel : alternatePixel;
+      }
+    }
+  }
+  return true;
+}
+
+void CheckerboardGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  memcpy(dest, frame.data(), frame.size());
+}
+
+bool CheckerboardGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (frameNumber > 0);
+}
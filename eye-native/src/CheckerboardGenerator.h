@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The CheckerboardGenerator class renders the Checkerboard stimulus, squares of the
+// given size in two alternating colors, rotated by the angle around the center of the
+// frame. This matches CheckerboardRenderer in the stimulus window. The pattern does not
+// move so the frame is rasterized once when the generator is opened and every frame
+// after the first is marked as a repeat.
+class CheckerboardGenerator : public FrameGenerator
+{
+public:
+  CheckerboardGenerator(uint32_t frameCount, std::string color,
+    std::string alternateColor, double size, double angle);
+  virtual ~CheckerboardGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  std::string color;
+  std::string alternateColor;
+  double size;
+  double angle;
+  std::vector<uint8_t> frame;
+};
@@ -0,0 +1,49 @@
+#include "ChirpGenerator.h"
+#include "Color.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+
+ChirpGenerator::ChirpGenerator(uint32_t count, uint32_t f, double freq0, double freq1,
+    double amp0, double amp1, double time1, double phase) :
+  FrameGenerator("chirp", count),
+  fps(f),
+  f0(freq0),
+  f1(freq1),
+  a0(amp0),
+  a1(amp1),
+  t1(time1),
+  phi(phase)
+{
+}
+
+bool ChirpGenerator::open(uint32_t wid, uint32_t hgt, string& error)
+{
+  if ((fps == 0) || !(t1 > 0.0))
+  {
+    error = "Invalid chirp parameters";
+    return false;
+  }
+  width = wid;
+  height = hgt;
+  return true;
+}
+
+void ChirpGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  // Interpolate the amplitude and evaluate the phase of the linear chirp
+  double timeDelta = frameNumber * (1.0 / fps);
+  double timeFraction = min(1.0, timeDelta / t1);
+  double amplitude = a0 * (1 - timeFraction) + a1 * timeFraction;
+  double beta = (f1 - f0) / t1;
+  double phase = 2 * PI * (f0 * timeDelta + 0.5 * beta * timeDelta * timeDelta);
+  double scale = cos(phi + phase);
+
+  // Stay centered around gray
+  double value = floor(amplitude * scale + 127.5 + 0.5);
+  uint8_t level = (uint8_t)min(max(value, 0.0), 255.0);
+  color::fillPixels(dest, color::toPixel(level, level, level), (size_t)width * height);
+}
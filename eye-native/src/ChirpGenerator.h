@@ -0,0 +1,29 @@
+#pragma once
+
+#include "FrameGenerator.h"
+
+// The ChirpGenerator class renders the Chirp stimulus, a full-field gray level that
+// follows a linear frequency chirp around mid gray. The frequency sweeps from f0 to f1
+// and the amplitude from a0 to a1 over t1 seconds, with a phase offset of phi, as in
+// scipy.signal.chirp. This matches ChirpRenderer in the stimulus window.
+class ChirpGenerator : public FrameGenerator
+{
+public:
+  ChirpGenerator(uint32_t frameCount, uint32_t fps, double f0, double f1, double a0,
+    double a1, double t1, double phi);
+  virtual ~ChirpGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+
+private:
+  uint32_t fps;
+  double f0;
+  double f1;
+  double a0;
+  double a1;
+  double t1;
+  double phi;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// These functions convert the CSS color strings used by the stimulus types into the
+// values that the canvas would draw, so natively generated frames match those rendered
+// by the stimulus window.
+
+namespace color
+{
+  // Parses a named color, "#rgb", "#rrggbb", or "rgb(r, g, b)". Returns false if the
+  // color is not recognized
+  bool parse(std::string text, uint8_t& red, uint8_t& green, uint8_t& blue);
+
+  // Packs a color into a fully opaque BGRA pixel as it is laid out in memory on the
+  // little-endian platforms we support
+  inline uint32_t toPixel(uint8_t red, uint8_t green, uint8_t blue)
+  {
+    return (uint32_t)blue | ((uint32_t)green << 8) | ((uint32_t)red << 16) | 0xFF000000;
+  }
+
+  // Fills the given number of pixels with a single value
+  void fillPixels(uint8_t* dest, uint32_t pixel, size_t count);
+}
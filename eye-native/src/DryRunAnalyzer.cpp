@@ -0,0 +1,144 @@
+#include "DryRunAnalyzer.h"
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+
+// Number of frames to reserve room for up front, about an hour at 60 fps
+#define INITIAL_FRAME_CAPACITY 216000
+
+DryRunAnalyzer::DryRunAnalyzer(uint8_t minLevels[3], uint8_t maxLevels[3],
+    vector<pair<uint32_t, uint32_t>> boundaries) :
+  RecordStage("dryrun"),
+  stimulusBoundaries(boundaries)
+{
+  // Frames are BGRA so the limits are given in that order. Alpha is never checked
+  gamutMin = Scalar(minLevels[2], minLevels[1], minLevels[0], 0);
+  gamutMax = Scalar(maxLevels[2], maxLevels[1], maxLevels[0], 255);
+  checkGamut = false;
+  for (int i = 0; i < 3; ++i)
+  {
+    checkGamut |= (minLevels[i] > 0) || (maxLevels[i] < 255);
+  }
+}
+
+void DryRunAnalyzer::addStimulusBoundary(uint32_t stimulusId, uint32_t frameNumber)
+{
+  unique_lock<mutex> lock(analyzerMutex);
+  stimulusBoundaries.push_back(make_pair(stimulusId, frameNumber));
+}
+
+bool DryRunAnalyzer::open(uint32_t wid, uint32_t hgt, uint32_t f, string& error)
+{
+  unique_lock<mutex> lock(analyzerMutex);
+  width = wid;
+  height = hgt;
+  fps = f;
+  frames.clear();
+  frames.reserve(INITIAL_FRAME_CAPACITY);
+  return true;
+}
+
+bool DryRunAnalyzer::processFrame(shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+  size_t length, string& error)
+{
+  if (length != ((size_t)width * height * 4))
+  {
+    error = "Unexpected frame length";
+    return false;
+  }
+
+  // A repeated frame has the same statistics as the last one
+  FrameStatistics statistics;
+  bool repeat = false;
+  {
+    unique_lock<mutex> lock(analyzerMutex);
+    if (wrapper->repeatFrame && !frames.empty())
+    {
+      statistics = frames.back();
+      repeat = true;
+    }
+  }
+  if (!repeat)
+  {
+    // OpenCV's conversions and reductions are vectorized so each frame costs a few
+    // passes over memory
+    Mat frame(height, width, CV_8UC4, (void*)data);
+    cvtColor(frame, grayFrame, COLOR_BGRA2GRAY);
+    double minValue, maxValue;
+    minMaxLoc(grayFrame, &minValue, &maxValue);
+    statistics.minLuminance = (float)(minValue / 255.0);
+    statistics.maxLuminance = (float)(maxValue / 255.0);
+    statistics.meanLuminance = (float)(mean(grayFrame)[0] / 255.0);
+    statistics.outOfGamut = false;
+    if (checkGamut)
+    {
+      inRange(frame, gamutMin, gamutMax, gamutMask);
+      statistics.outOfGamut = (countNonZero(gamutMask) != (int)(width * height));
+    }
+  }
+  unique_lock<mutex> lock(analyzerMutex);
+  frames.push_back(statistics);
+  return true;
+}
+
+bool DryRunAnalyzer::close(string& error)
+{
+  return true;
+}
+
+void DryRunAnalyzer::getSummary(DryRunSummary& program, vector<DryRunSummary>& stimuli)
+{
+  unique_lock<mutex> lock(analyzerMutex);
+  program = summarize(0, (uint32_t)frames.size());
+
+  // Each stimulus runs from its boundary to the next one or the end of the program
+  vector<pair<uint32_t, uint32_t>> boundaries = stimulusBoundaries;
+  stable_sort(boundaries.begin(), boundaries.end(),
+    [](const pair<uint32_t, uint32_t>& a, const pair<uint32_t, uint32_t>& b)
+    {
+      return a.second < b.second;
+    });
+  stimuli.clear();
+  for (size_t i = 0; i < boundaries.size(); ++i)
+  {
+    uint32_t first = min(boundaries[i].second, (uint32_t)frames.size());
+    uint32_t last = (i + 1 < boundaries.size()) ?
+      min(boundaries[i + 1].second, (uint32_t)frames.size()) : (uint32_t)frames.size();
+    DryRunSummary summary = summarize(first, last - first);
+    summary.stimulusId = boundaries[i].first;
+    stimuli.push_back(summary);
+  }
+}
+
+DryRunSummary DryRunAnalyzer::summarize(uint32_t firstFrame, uint32_t frameCount)
+{
+  DryRunSummary summary;
+  summary.firstFrame = firstFrame;
+  summary.frameCount = frameCount;
+  summary.duration = (fps > 0) ? ((double)frameCount / fps) : 0;
+  if (frameCount == 0)
+  {
+    return summary;
+  }
+  summary.minLuminance = 1;
+  double luminanceSum = 0;
+  for (uint32_t i = firstFrame; i < firstFrame + frameCount; ++i)
+  {
+    const FrameStatistics& statistics = frames[i];
+    summary.minLuminance = min(summary.minLuminance, statistics.minLuminance);
+    summary.maxLuminance = max(summary.maxLuminance, statistics.maxLuminance);
+    luminanceSum += statistics.meanLuminance;
+    if (statistics.outOfGamut)
+    {
+      summary.outOfGamutFrames += 1;
+      if (summary.firstOutOfGamutFrame < 0)
+      {
+        summary.firstOutOfGamutFrame = i;
+      }
+    }
+  }
+  summary.meanLuminance = (float)(luminanceSum / frameCount);
+  return summary;
+}
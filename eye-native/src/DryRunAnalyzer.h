@@ -0,0 +1,72 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "RecordStage.h"
+
+// The DryRunSummary structure holds the statistics of a dry run, either for the whole
+// program or for a single stimulus. Luminance is the Rec. 601 weighted gray level
+// normalized to the range 0 to 1. A frame is out of gamut if any of its pixels has a
+// channel outside the limits the projector can show
+struct DryRunSummary
+{
+  uint32_t stimulusId = 0;
+  uint32_t firstFrame = 0;
+  uint32_t frameCount = 0;
+  double duration = 0;
+  float minLuminance = 0;
+  float maxLuminance = 0;
+  float meanLuminance = 0;
+  uint32_t outOfGamutFrames = 0;
+  int64_t firstOutOfGamutFrame = -1;
+};
+
+// The DryRunAnalyzer class is the record stage used for dry runs, where a program is
+// played through the record pipeline without encoding or previewing it to find out how
+// long it is and what it shows before committing to a full render. It measures the
+// luminance range of every frame and counts pixels outside the projector's gamut, and
+// summarizes them for the whole program and for each stimulus marked with a boundary.
+// Repeated frames reuse the measurements of the frame before them.
+class DryRunAnalyzer : public RecordStage
+{
+public:
+  DryRunAnalyzer(uint8_t gamutMin[3], uint8_t gamutMax[3],
+    std::vector<std::pair<uint32_t, uint32_t>> stimulusBoundaries);
+  virtual ~DryRunAnalyzer() {};
+
+  void addStimulusBoundary(uint32_t stimulusId, uint32_t frameNumber);
+
+  bool open(uint32_t width, uint32_t height, uint32_t fps, std::string& error) override;
+  bool processFrame(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length, std::string& error) override;
+  bool close(std::string& error) override;
+
+  // Summarizes the frames analyzed so far. This may be called while the dry run is in
+  // progress
+  void getSummary(DryRunSummary& program, std::vector<DryRunSummary>& stimuli);
+
+private:
+  struct FrameStatistics
+  {
+    float minLuminance;
+    float maxLuminance;
+    float meanLuminance;
+    bool outOfGamut;
+  };
+
+  DryRunSummary summarize(uint32_t firstFrame, uint32_t frameCount);
+
+private:
+  cv::Scalar gamutMin;
+  cv::Scalar gamutMax;
+  bool checkGamut;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t fps = 0;
+  cv::Mat grayFrame;
+  cv::Mat gamutMask;
+  std::mutex analyzerMutex;
+  std::vector<std::pair<uint32_t, uint32_t>> stimulusBoundaries;
+  std::vector<FrameStatistics> frames;
+};
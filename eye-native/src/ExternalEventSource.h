@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// The ExternalEventSource class is the interface for something other than the timing
+// card that reports external events, such as a simulated photodiode used to test sync
+// patch measurements without hardware. Timestamps are in microseconds on the same clock
+// as the frame timestamps reported by the platform display functions.
+class ExternalEventSource
+{
+public:
+  ExternalEventSource() {};
+  virtual ~ExternalEventSource() {};
+
+  virtual bool start() = 0;
+  virtual bool waitForEvent(uint32_t timeoutMs, uint64_t& eventTimestampUsec) = 0;
+  virtual void stop() = 0;
+
+  // Called after each frame is presented with whether its sync patch was lit so a
+  // simulated source can respond to it
+  virtual void framePresented(uint64_t timestampUsec, bool patchLit)
+  {
+  }
+};
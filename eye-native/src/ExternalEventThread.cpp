@@ -3,8 +3,12 @@
 
 using namespace std;
 
-ExternalEventThread::ExternalEventThread() :
+// Maximum number of events held for getEvents() before the oldest are discarded
+#define MAX_PENDING_EVENTS 1024
+
+ExternalEventThread::ExternalEventThread(shared_ptr<ExternalEventSource> source) :
   Thread("externalevent"),
+  eventSource(source),
   eventTimestamp(0)
 {
 }
@@ -17,24 +21,46 @@ uint64_t ExternalEventThread::getEventTimestamp()
   return timestamp;
 }
 
+vector<uint64_t> ExternalEventThread::getEvents()
+{
+  unique_lock<mutex> lock(timestampMutex);
+  vector<uint64_t> result;
+  result.swap(events);
+  return result;
+}
+
 uint32_t ExternalEventThread::run()
 {
-  if (!platform::startExternalEventDetection())
+  if ((eventSource != nullptr) ? !eventSource->start() :
+    !platform::startExternalEventDetection())
   {
     return 1;
   }
   while (!checkForExit())
   {
     uint64_t eventTimestampUsec = 0;
-    if (!platform::waitForExternalEvent(10, eventTimestampUsec))
+    if ((eventSource != nullptr) ? !eventSource->waitForEvent(10, eventTimestampUsec) :
+      !platform::waitForExternalEvent(10, eventTimestampUsec))
     {
       continue;
     }
     {
       unique_lock<mutex> lock(timestampMutex);
       eventTimestamp = eventTimestampUsec;
+      if (events.size() == MAX_PENDING_EVENTS)
+      {
+        events.erase(events.begin());
+      }
+      events.push_back(eventTimestampUsec);
     }
   }
-  platform::stopExternalEventDetection();
+  if (eventSource != nullptr)
+  {
+    eventSource->stop();
+  }
+  else
+  {
+    platform::stopExternalEventDetection();
+  }
   return 0;
 }
@@ -1,19 +1,28 @@
 #pragma once
 
+#include <memory>
 #include <mutex>
+#include <vector>
+#include "ExternalEventSource.h"
 #include "Thread.h"
 
+// The ExternalEventThread class waits for events from the timing card, or from another
+// source if one is given, and records their timestamps. getEventTimestamp() returns the
+// most recent event and getEvents() returns every event since it was last called
 class ExternalEventThread : public Thread
 {
 public:
-  ExternalEventThread();
+  ExternalEventThread(std::shared_ptr<ExternalEventSource> eventSource = nullptr);
   virtual ~ExternalEventThread() {};
 
   uint64_t getEventTimestamp();
+  std::vector<uint64_t> getEvents();
 
   uint32_t run();
 
 private:
+  std::shared_ptr<ExternalEventSource> eventSource;
   uint64_t eventTimestamp;
+  std::vector<uint64_t> events;
   std::mutex timestampMutex;
 };
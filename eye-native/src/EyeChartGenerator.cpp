@@ -0,0 +1,75 @@
+#include "EyeChartGenerator.h"
+#include "Color.h"
+#include "GlyphAtlas.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+EyeChartGenerator::EyeChartGenerator(uint32_t count, vector<string> matrix, double s,
+    double p, string col, string background) :
+  FrameGenerator("eyechart", count),
+  letterMatrix(matrix),
+  size(s),
+  padding(p),
+  color(col),
+  backgroundColor(background)
+{
+}
+
+bool EyeChartGenerator::open(uint32_t width, uint32_t height, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(color, red, green, blue))
+  {
+    error = "Unknown color " + color;
+    return false;
+  }
+  uint32_t pixel = color::toPixel(red, green, blue);
+  if (!color::parse(backgroundColor, red, green, blue))
+  {
+    error = "Unknown color " + backgroundColor;
+    return false;
+  }
+  uint32_t backgroundPixel = color::toPixel(red, green, blue);
+  if (!(size >= 1.0) || !(padding >= 0.0))
+  {
+    error = "Invalid eye chart size";
+    return false;
+  }
+
+  // Lay out enough rows and columns to cover the frame. Letters beyond the end of the
+  // matrix are left blank
+  frame.resize((size_t)width * height * 4);
+  color::fillPixels(frame.data(), backgroundPixel, (size_t)width * height);
+  GlyphAtlas atlas((uint32_t)floor(size + 0.5));
+  double fullSize = size + padding;
+  uint32_t rows = (uint32_t)ceil(height / fullSize);
+  uint32_t columns = (uint32_t)ceil(width / fullSize);
+  for (uint32_t i = 0; (i < rows) && (i < letterMatrix.size()); ++i)
+  {
+    for (uint32_t j = 0; (j < columns) && (j < letterMatrix[i].size()); ++j)
+    {
+      char letter = letterMatrix[i][j];
+      if (!GlyphAtlas::isSupported(letter))
+      {
+        error = string("Unsupported letter ") + letter;
+        return false;
+      }
+      int32_t left = (int32_t)floor(j * fullSize + padding / 2 + 0.5);
+      int32_t top = (int32_t)floor(i * fullSize + padding / 2 + 0.5);
+      atlas.composite(letter, left, top, pixel, frame.data(), width, height);
+    }
+  }
+  return true;
+}
+
+void EyeChartGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  memcpy(dest, frame.data(), frame.size());
+}
+
+bool EyeChartGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (frameNumber > 0);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The EyeChartGenerator class renders the EyeChart stimulus, a grid of Sloan letters
+// that fills the frame. Each string in the letter matrix is one row of the chart with
+// one letter per column. This matches EyeChartRenderer in the stimulus window. The
+// frame is composed once from a GlyphAtlas when the generator is opened and every frame
+// after the first is marked as a repeat.
+class EyeChartGenerator : public FrameGenerator
+{
+public:
+  EyeChartGenerator(uint32_t frameCount, std::vector<std::string> letterMatrix,
+    double size, double padding, std::string color, std::string backgroundColor);
+  virtual ~EyeChartGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  std::vector<std::string> letterMatrix;
+  double size;
+  double padding;
+  std::string color;
+  std::string backgroundColor;
+  std::vector<uint8_t> frame;
+};
@@ -1,19 +1,47 @@
 #include "FfmpegPlaybackProcess.h"
 #include "Platform.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <stdexcept>
 
 using namespace std;
 
 FfmpegPlaybackProcess::FfmpegPlaybackProcess(string exec, string videoPath,
-    uint32_t w, uint32_t h) :
+    uint32_t w, uint32_t h, shared_ptr<FramePool> pool,
+    shared_ptr<Queue<shared_ptr<FrameWrapper>>> outputQueue, bool rawInput,
+    string videoFilter) :
   Thread("ffmpegplayback"),
   executable(exec),
   width(w),
-  height(h)
+  height(h),
+  framePool(pool),
+  outputFrameQueue(outputQueue)
 {
+  // Raw input has no header so the format and dimensions are given up front
+  if (rawInput)
+  {
+    arguments.push_back("-f");
+    arguments.push_back("rawvideo");
+
+    arguments.push_back("-pix_fmt");
+    arguments.push_back("bgra");
+
+    arguments.push_back("-video_size");
+    arguments.push_back(to_string(width) + "x" + to_string(height));
+  }
+
   arguments.push_back("-i");
   arguments.push_back(videoPath);
 
+  // An optional filter chain resizes the frames, in which case the given dimensions
+  // are those of the filter's output
+  if (!videoFilter.empty())
+  {
+    arguments.push_back("-vf");
+    arguments.push_back(videoFilter);
+  }
+
   arguments.push_back("-f");
   arguments.push_back("image2pipe");
 
@@ -26,6 +54,17 @@ FfmpegPlaybackProcess::FfmpegPlaybackProcess(string exec, string videoPath,
   arguments.push_back("pipe:1");
 }
 
+void FfmpegPlaybackProcess::setStartTime(double startSec)
+{
+  // Only called before the thread is spawned. Seeking on the input side jumps straight
+  // to the key frame before the start time, and ffmpeg then decodes and discards the
+  // frames up to it so output begins on exactly that frame
+  stringstream value;
+  value << fixed << setprecision(6) << max(startSec, 0.0);
+  arguments.insert(arguments.begin(), value.str());
+  arguments.insert(arguments.begin(), "-ss");
+}
+
 FfmpegPlaybackProcess::~FfmpegPlaybackProcess()
 {
   if (stdoutReader)
@@ -45,9 +84,8 @@ uint32_t FfmpegPlaybackProcess::run()
   {
     return 1;
   }
-  uint32_t frameSize = width * height * 4;
-  stdoutReader = shared_ptr<PipeReader>(new PipeReader("ffmpegplayback_stdout",
-    processStdout, 5 * frameSize));
+  stdoutReader = shared_ptr<FrameReader>(new FrameReader("ffmpegplayback_stdout",
+    processStdout, width, height, framePool, outputFrameQueue));
   stderrReader = shared_ptr<PipeReader>(new PipeReader("ffmpegplayback_stderr",
     processStderr));
   if (!stdoutReader->spawn() || !stderrReader->spawn())
@@ -61,7 +99,8 @@ uint32_t FfmpegPlaybackProcess::run()
   processStartEvent.notify_one();
   while (isProcessRunning())
   {
-    if (!stdoutReader->isRunning() ||
+    // The frame reader exits by itself once ffmpeg closes its end of the pipe
+    if ((!stdoutReader->isRunning() && !stdoutReader->isFinished()) ||
       !stderrReader->isRunning())
     {
       fprintf(stderr, "[FfmpegPlaybackProcess] ERROR: A process thread has exited unexpectedly\n");
@@ -115,16 +154,17 @@ void FfmpegPlaybackProcess::waitForExit()
   }
 }
 
-string FfmpegPlaybackProcess::readStdout()
+bool FfmpegPlaybackProcess::isDecodingFinished()
 {
-  if (stdoutReader)
+  // Decoding is also over if ffmpeg failed to start
   {
-    return stdoutReader->getData();
-  }
-  else
-  {
-    return "";
+    unique_lock<mutex> lock(processMutex);
+    if (processStarted)
+    {
+      return stdoutReader->isFinished();
+    }
   }
+  return !isRunning();
 }
 
 void FfmpegPlaybackProcess::terminateProcess()
@@ -4,22 +4,33 @@
 #include <memory>
 #include <mutex>
 #include <vector>
+#include "FramePool.h"
+#include "FrameReader.h"
+#include "FrameWrapper.h"
 #include "PipeReader.h"
+#include "Queue.hpp"
 #include "Thread.h"
 
 class FfmpegPlaybackProcess : public Thread
 {
 public:
   FfmpegPlaybackProcess(std::string executable, std::string videoPath,
-    uint32_t width, uint32_t height);
+    uint32_t width, uint32_t height, std::shared_ptr<FramePool> framePool,
+    std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue,
+    bool rawInput = false, std::string videoFilter = "");
   virtual ~FfmpegPlaybackProcess();
 
 public:
+  // Starts decoding at the first frame presented at or after the given time, which is
+  // relative to the start of the video
+  void setStartTime(double startSec);
+
   bool isProcessRunning();
   void waitForExit();
   void terminateProcess();
 
-  std::string readStdout();
+  // Returns true once every decoded frame has been passed to the output queue
+  bool isDecodingFinished();
 
 private:
   bool startProcess();
@@ -33,6 +44,8 @@ private:
   std::string executable;
   uint32_t width;
   uint32_t height;
+  std::shared_ptr<FramePool> framePool;
+  std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue;
   std::vector<std::string> arguments;
   bool processStarted = false;
   std::mutex processMutex;
@@ -41,6 +54,6 @@ private:
   uint64_t processStdin = 0;
   uint64_t processStdout = 0;
   uint64_t processStderr = 0;
-  std::shared_ptr<PipeReader> stdoutReader;
+  std::shared_ptr<FrameReader> stdoutReader;
   std::shared_ptr<PipeReader> stderrReader;
 };
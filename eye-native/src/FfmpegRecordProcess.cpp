@@ -1,11 +1,18 @@
 #include "FfmpegRecordProcess.h"
 #include "Platform.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <stdexcept>
 
 using namespace std;
 
+// Longest list of forced key frame times to pass to ffmpeg, which leaves room for the
+// paths and other arguments within the Windows command line limit
+#define MAX_KEY_FRAME_CHARS 24000
+
 FfmpegRecordProcess::FfmpegRecordProcess(string exec, uint32_t width, uint32_t height,
-    uint32_t fps, string outputPath) :
+    uint32_t fps, string outputPath, vector<uint32_t> keyFrames) :
   Thread("ffmpegrecord"),
   executable(exec)
 {
@@ -41,6 +48,40 @@ FfmpegRecordProcess::FfmpegRecordProcess(string exec, uint32_t width, uint32_t h
   arguments.push_back("-pix_fmt");
   arguments.push_back("yuv420p");
 
+  // Force a key frame at the start of each stimulus so playback and analysis can seek
+  // directly to it. Each time is placed half a frame early because ffmpeg promotes the
+  // first frame whose timestamp is at or after the given time. The list has to fit on
+  // the command line, which Windows limits to 32767 characters, so on programs with
+  // thousands of stimuli only the ones that fit are forced. The seek index still covers
+  // the rest by pointing at the key frame before each of them
+  if (!keyFrames.empty())
+  {
+    string times;
+    uint32_t forcedCount = 0;
+    for (auto it = keyFrames.begin(); it != keyFrames.end(); ++it)
+    {
+      stringstream time;
+      time << fixed << setprecision(4) << max(0.0, ((double)*it - 0.5) / (double)fps);
+      if ((times.size() + time.str().size() + 1) > MAX_KEY_FRAME_CHARS)
+      {
+        break;
+      }
+      if (!times.empty())
+      {
+        times += ",";
+      }
+      times += time.str();
+      forcedCount += 1;
+    }
+    if (forcedCount < keyFrames.size())
+    {
+      fprintf(stderr, "[FfmpegRecordProcess] WARNING: Only the first %u of %u stimulus "
+        "boundaries will be key frames\n", forcedCount, (uint32_t)keyFrames.size());
+    }
+    arguments.push_back("-force_key_frames");
+    arguments.push_back(times);
+  }
+
   arguments.push_back("-y");
   
   arguments.push_back(outputPath);
@@ -11,7 +11,7 @@ class FfmpegRecordProcess : public Thread
 {
 public:
   FfmpegRecordProcess(std::string executable, uint32_t width, uint32_t height, uint32_t fps,
-    std::string outputPath);
+    std::string outputPath, std::vector<uint32_t> keyFrames);
   virtual ~FfmpegRecordProcess() {};
 
 public:
@@ -1,6 +1,7 @@
 #include "FfprobeProcess.h"
 #include "Platform.h"
 #include "json/json.hpp"
+#include <cmath>
 #include <stdexcept>
 #include <sstream>
 
@@ -13,7 +14,8 @@ FfprobeProcess::FfprobeProcess(string exec, string videoPath) :
   width(0),
   height(0),
   fps(0),
-  frameCount(0)
+  frameCount(0),
+  durationUsec(0)
 {
   arguments.push_back("-v");
   arguments.push_back("quiet");
@@ -22,6 +24,7 @@ FfprobeProcess::FfprobeProcess(string exec, string videoPath) :
   arguments.push_back("json");
 
   arguments.push_back("-show_streams");
+  arguments.push_back("-show_format");
 
   arguments.push_back(videoPath);
 }
@@ -82,24 +85,51 @@ uint32_t FfprobeProcess::run()
   stderrReader->terminate();
   cleanUpProcess();
 
-  json stdoutJson = json::parse(stdoutRaw.str());
+  // Pick up any output that arrived after the last poll and leave the details at zero
+  // if it can't be parsed
+  stdoutRaw << stdoutReader->getData();
+  json stdoutJson = json::parse(stdoutRaw.str(), nullptr, false);
+  if (stdoutJson.is_discarded() || !stdoutJson.is_object() ||
+    !stdoutJson.contains("streams") || !stdoutJson["streams"].is_array())
+  {
+    return 1;
+  }
   for (auto& stream : stdoutJson["streams"])
   {
-    string codecType = stream["codec_type"].get<string>();
-    if (stream["codec_type"] != "video")
+    if (stream.value("codec_type", "") != "video")
     {
       continue;
     }
-    width = stream["width"].get<uint32_t>();
-    height = stream["height"].get<uint32_t>();
-    string fpsStr = stream["r_frame_rate"].get<string>();  // e.g. "30/1"
+    width = stream.value("width", 0u);
+    height = stream.value("height", 0u);
+    string fpsStr = stream.value("r_frame_rate", "");  // e.g. "30000/1001"
     size_t slashPos = fpsStr.find('/');
+    double rate = 0;
     if (slashPos != string::npos)
     {
-      fps = atoi(fpsStr.substr(0, slashPos).c_str());
+      double denominator = atof(fpsStr.substr(slashPos + 1).c_str());
+      if (denominator > 0)
+      {
+        rate = atof(fpsStr.substr(0, slashPos).c_str()) / denominator;
+        fps = (uint32_t)round(rate);
+      }
     }
-    string frameCountStr = stream["nb_frames"].get<string>(); // e.g. "902"
+
+    // Matroska and some other containers don't declare a frame count, so estimate it
+    // from the duration of the stream or, failing that, the whole file
+    string durationStr = stream.value("duration", "");  // e.g. "30.033333"
+    if (durationStr.empty() && stdoutJson.contains("format") &&
+      stdoutJson["format"].is_object())
+    {
+      durationStr = stdoutJson["format"].value("duration", "");
+    }
+    durationUsec = (uint64_t)(atof(durationStr.c_str()) * 1000000.0);
+    string frameCountStr = stream.value("nb_frames", ""); // e.g. "902"
     frameCount = atoi(frameCountStr.c_str());
+    if (frameCount == 0)
+    {
+      frameCount = (uint32_t)round((double)durationUsec * rate / 1000000.0);
+    }
     break;
   }
   return 0;
@@ -154,6 +184,11 @@ uint32_t FfprobeProcess::getFrameCount()
   return frameCount;
 }
 
+uint64_t FfprobeProcess::getDurationUsec()
+{
+  return durationUsec;
+}
+
 void FfprobeProcess::terminateProcess()
 {
   platform::terminateProcess(processPid, 1);
@@ -21,6 +21,7 @@ public:
   uint32_t getHeight();
   uint32_t getFps();
   uint32_t getFrameCount();
+  uint64_t getDurationUsec();
 
 private:
   bool startProcess();
@@ -47,4 +48,5 @@ private:
   uint32_t height;
   uint32_t fps;
   uint32_t frameCount;
+  uint64_t durationUsec;
 };
@@ -0,0 +1,92 @@
+#include "FrameArchive.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// Magic number and version used to identify frame archives
+#define MAGIC_NUMBER 0x41455945
+#define VERSION 1
+
+// Extension used for frame archive files
+#define ARCHIVE_EXTENSION ".frames"
+
+bool framearchive::isArchivePath(string path)
+{
+  string extension = ARCHIVE_EXTENSION;
+  if (path.size() < extension.size())
+  {
+    return false;
+  }
+  string suffix = path.substr(path.size() - extension.size());
+  transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower);
+  return (suffix == extension);
+}
+
+bool framearchive::parseCompression(string name, uint32_t& compression)
+{
+  if (name == "none")
+  {
+    compression = FRAME_ARCHIVE_COMPRESSION_NONE;
+    return true;
+  }
+  if (name == "lz4")
+  {
+    compression = FRAME_ARCHIVE_COMPRESSION_LZ4;
+    return true;
+  }
+  return false;
+}
+
+void framearchive::formatHeader(FrameArchiveHeader& header, uint8_t* buffer)
+{
+  uint32_t magicNumber = MAGIC_NUMBER, version = VERSION;
+  memset(buffer, 0, FRAME_ARCHIVE_HEADER_SIZE);
+  memcpy(&buffer[0], &magicNumber, sizeof(uint32_t));
+  memcpy(&buffer[4], &version, sizeof(uint32_t));
+  memcpy(&buffer[8], &header.width, sizeof(uint32_t));
+  memcpy(&buffer[12], &header.height, sizeof(uint32_t));
+  memcpy(&buffer[16], &header.fps, sizeof(uint32_t));
+  memcpy(&buffer[20], &header.pixelFormat, sizeof(uint32_t));
+  memcpy(&buffer[24], &header.compression, sizeof(uint32_t));
+  memcpy(&buffer[28], &header.alignment, sizeof(uint32_t));
+  memcpy(&buffer[32], &header.frameCount, sizeof(uint32_t));
+  memcpy(&buffer[40], &header.indexOffset, sizeof(uint64_t));
+}
+
+bool framearchive::parseHeader(const uint8_t* buffer, FrameArchiveHeader& header)
+{
+  // Parse and verify the magic number and version
+  uint32_t magicNumber, version;
+  memcpy(&magicNumber, &buffer[0], sizeof(uint32_t));
+  memcpy(&version, &buffer[4], sizeof(uint32_t));
+  if ((magicNumber != MAGIC_NUMBER) || (version != VERSION))
+  {
+    return false;
+  }
+
+  // Parse the remaining fields
+  memcpy(&header.width, &buffer[8], sizeof(uint32_t));
+  memcpy(&header.height, &buffer[12], sizeof(uint32_t));
+  memcpy(&header.fps, &buffer[16], sizeof(uint32_t));
+  memcpy(&header.pixelFormat, &buffer[20], sizeof(uint32_t));
+  memcpy(&header.compression, &buffer[24], sizeof(uint32_t));
+  memcpy(&header.alignment, &buffer[28], sizeof(uint32_t));
+  memcpy(&header.frameCount, &buffer[32], sizeof(uint32_t));
+  memcpy(&header.indexOffset, &buffer[40], sizeof(uint64_t));
+  return true;
+}
+
+void framearchive::formatIndexEntry(FrameArchiveIndexEntry& entry, uint8_t* buffer)
+{
+  memcpy(&buffer[0], &entry.offset, sizeof(uint64_t));
+  memcpy(&buffer[8], &entry.length, sizeof(uint32_t));
+  memcpy(&buffer[12], &entry.compression, sizeof(uint32_t));
+}
+
+void framearchive::parseIndexEntry(const uint8_t* buffer, FrameArchiveIndexEntry& entry)
+{
+  memcpy(&entry.offset, &buffer[0], sizeof(uint64_t));
+  memcpy(&entry.length, &buffer[8], sizeof(uint32_t));
+  memcpy(&entry.compression, &buffer[12], sizeof(uint32_t));
+}
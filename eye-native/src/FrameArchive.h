@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// These functions handle the header and index of the frame archive, a container that
+// holds every recorded frame bit-exactly so runs can be reproduced and analyzed without
+// the losses introduced by video compression. The file is laid out as follows:
+//
+// - Header (64 bytes):
+//   - Magic number (uint32_t)
+//   - Version (uint32_t)
+//   - Width (uint32_t)
+//   - Height (uint32_t)
+//   - Frame rate (uint32_t)
+//   - Pixel format (uint32_t), always BGRA
+//   - Compression (uint32_t), the default codec for frame blocks
+//   - Alignment (uint32_t), the boundary on which every block starts
+//   - Frame count (uint32_t)
+//   - Reserved (uint32_t)
+//   - Index offset (uint64_t)
+//   - Reserved (16 bytes)
+// - Frame blocks, each padded with zeros to the alignment boundary
+// - Index (16 bytes per frame):
+//   - Byte offset of the block (uint64_t)
+//   - Stored length of the block (uint32_t)
+//   - Compression of the block (uint32_t)
+//
+// The frame count and index offset are zero until the archive has been closed so a
+// truncated recording can be detected. Blocks that do not compress are stored raw,
+// which is why each index entry carries its own compression field.
+
+// The number of bytes in the header and in each index entry
+#define FRAME_ARCHIVE_HEADER_SIZE 64
+#define FRAME_ARCHIVE_INDEX_ENTRY_SIZE 16
+
+// Every frame block starts on a 64-byte boundary so a memory-mapped archive can be read
+// with aligned vector loads
+#define FRAME_ARCHIVE_ALIGNMENT 64
+
+// Block compression codecs
+#define FRAME_ARCHIVE_COMPRESSION_NONE 0
+#define FRAME_ARCHIVE_COMPRESSION_LZ4 1
+
+// Pixel formats
+#define FRAME_ARCHIVE_FORMAT_BGRA 0
+
+struct FrameArchiveHeader
+{
+  uint32_t width;
+  uint32_t height;
+  uint32_t fps;
+  uint32_t pixelFormat;
+  uint32_t compression;
+  uint32_t alignment;
+  uint32_t frameCount;
+  uint64_t indexOffset;
+};
+
+struct FrameArchiveIndexEntry
+{
+  uint64_t offset;
+  uint32_t length;
+  uint32_t compression;
+};
+
+namespace framearchive
+{
+  bool isArchivePath(std::string path);
+  bool parseCompression(std::string name, uint32_t& compression);
+
+  void formatHeader(FrameArchiveHeader& header, uint8_t* buffer);
+  bool parseHeader(const uint8_t* buffer, FrameArchiveHeader& header);
+  void formatIndexEntry(FrameArchiveIndexEntry& entry, uint8_t* buffer);
+  void parseIndexEntry(const uint8_t* buffer, FrameArchiveIndexEntry& entry);
+}
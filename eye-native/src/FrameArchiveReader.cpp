@@ -0,0 +1,132 @@
+#include "FrameArchiveReader.h"
+#include "Lz4.h"
+#include "Platform.h"
+#include <cstring>
+
+using namespace std;
+
+FrameArchiveReader::FrameArchiveReader(string path, bool seq) :
+  archivePath(path),
+  sequential(seq)
+{
+  memset(&header, 0, sizeof(header));
+}
+
+FrameArchiveReader::~FrameArchiveReader()
+{
+  close();
+}
+
+bool FrameArchiveReader::open(string& error)
+{
+  if (!platform::mapFile(archivePath, sequential, data, length, mapId))
+  {
+    error = "Failed to map " + archivePath;
+    return false;
+  }
+
+  // Validate the header and make sure the index lies within the file. An archive that
+  // was never closed has a zero index offset
+  if ((length < FRAME_ARCHIVE_HEADER_SIZE) || !framearchive::parseHeader(data, header))
+  {
+    error = "Invalid frame archive header in " + archivePath;
+    close();
+    return false;
+  }
+  if ((header.indexOffset < FRAME_ARCHIVE_HEADER_SIZE) || (header.indexOffset > length) ||
+    (((length - header.indexOffset) / FRAME_ARCHIVE_INDEX_ENTRY_SIZE) < header.frameCount))
+  {
+    error = "Frame archive " + archivePath + " is incomplete";
+    close();
+    return false;
+  }
+  if (header.pixelFormat != FRAME_ARCHIVE_FORMAT_BGRA)
+  {
+    error = "Unsupported pixel format in " + archivePath;
+    close();
+    return false;
+  }
+  return true;
+}
+
+void FrameArchiveReader::close()
+{
+  if (data != nullptr)
+  {
+    platform::unmapFile(data, length, mapId);
+    data = nullptr;
+    length = 0;
+    mapId = 0;
+  }
+}
+
+uint32_t FrameArchiveReader::getWidth()
+{
+  return header.width;
+}
+
+uint32_t FrameArchiveReader::getHeight()
+{
+  return header.height;
+}
+
+uint32_t FrameArchiveReader::getFps()
+{
+  return header.fps;
+}
+
+uint32_t FrameArchiveReader::getFrameCount()
+{
+  return header.frameCount;
+}
+
+size_t FrameArchiveReader::getFrameLength()
+{
+  return (size_t)header.width * header.height * 4;
+}
+
+bool FrameArchiveReader::readFrame(uint32_t frameNumber, uint8_t* dest, string& error)
+{
+  if ((data == nullptr) || (frameNumber >= header.frameCount))
+  {
+    error = "Frame " + to_string(frameNumber) + " is not in " + archivePath;
+    return false;
+  }
+
+  // Locate the block and make sure it lies before the index
+  FrameArchiveIndexEntry entry;
+  framearchive::parseIndexEntry(data + header.indexOffset +
+    (uint64_t)frameNumber * FRAME_ARCHIVE_INDEX_ENTRY_SIZE, entry);
+  if ((entry.offset < FRAME_ARCHIVE_HEADER_SIZE) || (entry.offset > header.indexOffset) ||
+    (entry.length > (header.indexOffset - entry.offset)))
+  {
+    error = "Invalid index entry for frame " + to_string(frameNumber);
+    return false;
+  }
+
+  // Copy or decompress the block into the destination
+  size_t frameLength = getFrameLength();
+  if (entry.compression == FRAME_ARCHIVE_COMPRESSION_NONE)
+  {
+    if (entry.length != frameLength)
+    {
+      error = "Invalid block length for frame " + to_string(frameNumber);
+      return false;
+    }
+    memcpy(dest, data + entry.offset, frameLength);
+  }
+  else if (entry.compression == FRAME_ARCHIVE_COMPRESSION_LZ4)
+  {
+    if (!lz4::decompress(data + entry.offset, entry.length, dest, (uint32_t)frameLength))
+    {
+      error = "Failed to decompress frame " + to_string(frameNumber);
+      return false;
+    }
+  }
+  else
+  {
+    error = "Unsupported compression for frame " + to_string(frameNumber);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include "FrameArchive.h"
+
+// The FrameArchiveReader class memory-maps a frame archive and decodes individual frames
+// by number. Random access is cheap because the index gives the location of every block
+class FrameArchiveReader
+{
+public:
+  FrameArchiveReader(std::string archivePath, bool sequential);
+  virtual ~FrameArchiveReader();
+
+  bool open(std::string& error);
+  void close();
+
+  uint32_t getWidth();
+  uint32_t getHeight();
+  uint32_t getFps();
+  uint32_t getFrameCount();
+  size_t getFrameLength();
+
+  // Decode the given frame into the destination buffer, which must hold at least
+  // getFrameLength() bytes
+  bool readFrame(uint32_t frameNumber, uint8_t* dest, std::string& error);
+
+private:
+  std::string archivePath;
+  bool sequential;
+  const uint8_t* data = nullptr;
+  uint64_t length = 0;
+  uint64_t mapId = 0;
+  FrameArchiveHeader header;
+};
@@ -0,0 +1,150 @@
+#include "FrameArchiveWriter.h"
+#include "Lz4.h"
+
+using namespace std;
+
+FrameArchiveWriter::FrameArchiveWriter(string path, uint32_t compression) :
+  RecordStage("framearchive"),
+  archivePath(path)
+{
+  header.width = 0;
+  header.height = 0;
+  header.fps = 0;
+  header.pixelFormat = FRAME_ARCHIVE_FORMAT_BGRA;
+  header.compression = compression;
+  header.alignment = FRAME_ARCHIVE_ALIGNMENT;
+  header.frameCount = 0;
+  header.indexOffset = 0;
+}
+
+bool FrameArchiveWriter::open(uint32_t width, uint32_t height, uint32_t fps,
+  string& error)
+{
+  file.open(archivePath, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+  {
+    error = "Failed to create " + archivePath;
+    return false;
+  }
+
+  // Write the header with a zero frame count and index offset. These are filled in
+  // when the archive is closed
+  header.width = width;
+  header.height = height;
+  header.fps = fps;
+  uint8_t buffer[FRAME_ARCHIVE_HEADER_SIZE];
+  framearchive::formatHeader(header, buffer);
+  file.write((const char*)buffer, FRAME_ARCHIVE_HEADER_SIZE);
+  position = FRAME_ARCHIVE_HEADER_SIZE;
+
+  // Allocate the compression buffer once up front
+  if (header.compression == FRAME_ARCHIVE_COMPRESSION_LZ4)
+  {
+    compressBuffer.resize(lz4::compressBound(width * height * 4));
+  }
+  if (!file.good())
+  {
+    error = "Failed to write " + archivePath;
+    return false;
+  }
+  return true;
+}
+
+bool FrameArchiveWriter::processFrame(shared_ptr<FrameWrapper> wrapper,
+  const uint8_t* data, size_t length, string& error)
+{
+  if (length != ((size_t)header.width * header.height * 4))
+  {
+    error = "Unexpected frame length";
+    return false;
+  }
+
+  // A repeated frame points at the block already written for the frame before it
+  if (wrapper->repeatFrame && !index.empty())
+  {
+    index.push_back(index.back());
+    return true;
+  }
+
+  // Compress the frame and fall back to storing it raw if that doesn't save space
+  FrameArchiveIndexEntry entry;
+  entry.offset = position;
+  entry.compression = FRAME_ARCHIVE_COMPRESSION_NONE;
+  const uint8_t* block = data;
+  size_t blockLength = length;
+  if (header.compression == FRAME_ARCHIVE_COMPRESSION_LZ4)
+  {
+    uint32_t compressedLength = lz4::compress(data, (uint32_t)length,
+      compressBuffer.data(), (uint32_t)compressBuffer.size());
+    if ((compressedLength != 0) && (compressedLength < length))
+    {
+      entry.compression = FRAME_ARCHIVE_COMPRESSION_LZ4;
+      block = compressBuffer.data();
+      blockLength = compressedLength;
+    }
+  }
+  entry.length = (uint32_t)blockLength;
+  if (!writeBlock(block, blockLength, error))
+  {
+    return false;
+  }
+  index.push_back(entry);
+  return true;
+}
+
+bool FrameArchiveWriter::close(string& error)
+{
+  if (!file.is_open())
+  {
+    return true;
+  }
+
+  // Append the index to the end of the file
+  header.frameCount = (uint32_t)index.size();
+  header.indexOffset = position;
+  for (auto it = index.begin(); it != index.end(); ++it)
+  {
+    uint8_t buffer[FRAME_ARCHIVE_INDEX_ENTRY_SIZE];
+    framearchive::formatIndexEntry(*it, buffer);
+    file.write((const char*)buffer, FRAME_ARCHIVE_INDEX_ENTRY_SIZE);
+    position += FRAME_ARCHIVE_INDEX_ENTRY_SIZE;
+  }
+
+  // Rewrite the header now that the frame count and index offset are known
+  uint8_t buffer[FRAME_ARCHIVE_HEADER_SIZE];
+  framearchive::formatHeader(header, buffer);
+  file.seekp(0);
+  file.write((const char*)buffer, FRAME_ARCHIVE_HEADER_SIZE);
+  bool success = file.good();
+  file.close();
+  index.clear();
+  if (!success)
+  {
+    error = "Failed to finalize " + archivePath;
+    return false;
+  }
+  return true;
+}
+
+uint64_t FrameArchiveWriter::getBytesWritten()
+{
+  return position;
+}
+
+bool FrameArchiveWriter::writeBlock(const uint8_t* data, size_t length, string& error)
+{
+  // Write the block followed by enough padding to align the next one
+  static const uint8_t padding[FRAME_ARCHIVE_ALIGNMENT] = { 0 };
+  file.write((const char*)data, length);
+  position += length;
+  size_t paddingLength = (size_t)((FRAME_ARCHIVE_ALIGNMENT -
+    (position % FRAME_ARCHIVE_ALIGNMENT)) % FRAME_ARCHIVE_ALIGNMENT);
+  file.write((const char*)padding, paddingLength);
+  position += paddingLength;
+  if (!file.good())
+  {
+    error = "Failed to write " + archivePath;
+    return false;
+  }
+  return true;
+}
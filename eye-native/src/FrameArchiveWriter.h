@@ -0,0 +1,33 @@
+#pragma once
+
+#include <fstream>
+#include <vector>
+#include "FrameArchive.h"
+#include "RecordStage.h"
+
+// The FrameArchiveWriter class is a record stage that appends each frame to a frame
+// archive as a compressed block and writes the index and final header on close
+class FrameArchiveWriter : public RecordStage
+{
+public:
+  FrameArchiveWriter(std::string archivePath, uint32_t compression);
+  virtual ~FrameArchiveWriter() {};
+
+  bool open(uint32_t width, uint32_t height, uint32_t fps, std::string& error) override;
+  bool processFrame(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length, std::string& error) override;
+  bool close(std::string& error) override;
+
+  uint64_t getBytesWritten();
+
+private:
+  bool writeBlock(const uint8_t* data, size_t length, std::string& error);
+
+private:
+  std::string archivePath;
+  std::ofstream file;
+  FrameArchiveHeader header;
+  uint64_t position = 0;
+  std::vector<uint8_t> compressBuffer;
+  std::vector<FrameArchiveIndexEntry> index;
+};
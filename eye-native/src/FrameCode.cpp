@@ -0,0 +1,128 @@
+#include "FrameCode.h"
+#include "Color.h"
+#include <cmath>
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+
+// Smallest difference in gray level between the reference cells that can be decoded
+#define MIN_CONTRAST 32
+
+// Fraction of each cell ignored around its edges when decoding, where the camera blurs
+// neighboring cells together. Each cell is sampled in this many columns and only the
+// inner ones are used
+#define DECODE_MARGIN 0.2
+#define SAMPLES_PER_CELL 5
+
+FrameCode::FrameCode(uint32_t xi, uint32_t yi, uint32_t size, uint32_t b) :
+  x(xi),
+  y(yi),
+  cellSize(size),
+  bits(b)
+{
+}
+
+uint32_t FrameCode::getCellCount(uint32_t bits)
+{
+  // Two reference cells, the code, and the parity cell
+  return bits + 3;
+}
+
+bool FrameCode::fits(uint32_t width, uint32_t height)
+{
+  return ((uint64_t)x + (uint64_t)getCellCount(bits) * cellSize <= width) &&
+    ((uint64_t)y + cellSize <= height);
+}
+
+void FrameCode::paint(uint8_t* frame, uint32_t width, uint32_t height, uint32_t number)
+{
+  // Lay out the cell values and paint each row of the strip
+  uint32_t gray = number ^ (number >> 1);
+  uint32_t cellCount = getCellCount(bits), parity = 0;
+  vector<bool> cells(cellCount);
+  cells[0] = true;
+  cells[1] = false;
+  for (uint32_t i = 0; i < bits; ++i)
+  {
+    cells[2 + i] = ((gray >> (bits - 1 - i)) & 1) != 0;
+    parity ^= cells[2 + i] ? 1 : 0;
+  }
+  cells[cellCount - 1] = (parity != 0);
+  uint32_t white = color::toPixel(255, 255, 255), black = color::toPixel(0, 0, 0);
+  for (uint32_t row = y; row < y + cellSize; ++row)
+  {
+    uint8_t* dest = frame + ((size_t)row * width + x) * 4;
+    for (uint32_t i = 0; i < cellCount; ++i)
+    {
+      color::fillPixels(dest + (size_t)i * cellSize * 4, cells[i] ? white : black,
+        cellSize);
+    }
+  }
+}
+
+int64_t FrameCode::decode(const Mat& image, double x, double y, double cellWidth,
+  double cellHeight, uint32_t bits)
+{
+  // Crop the strip, leaving out the blurred rows at its top and bottom
+  uint32_t cellCount = getCellCount(bits);
+  Rect strip((int)floor(x), (int)floor(y + cellHeight * DECODE_MARGIN),
+    (int)ceil(cellWidth * cellCount), (int)ceil(cellHeight * (1 - 2 * DECODE_MARGIN)));
+  if ((strip.width < (int)cellCount * SAMPLES_PER_CELL) || (strip.height < 1) ||
+    ((strip & Rect(0, 0, image.cols, image.rows)) != strip))
+  {
+    return -1;
+  }
+  Mat grayStrip;
+  if (image.channels() == 1)
+  {
+    grayStrip = image(strip);
+  }
+  else
+  {
+    cvtColor(image(strip), grayStrip, (image.channels() == 4) ? COLOR_BGRA2GRAY :
+      COLOR_BGR2GRAY);
+  }
+
+  // Average the strip down to a few samples per cell in a single vectorized pass and
+  // keep the inner samples of each cell
+  Mat samples;
+  resize(grayStrip, samples, Size((int)cellCount * SAMPLES_PER_CELL, 1), 0, 0, INTER_AREA);
+  const uint8_t* sample = samples.ptr<uint8_t>(0);
+  vector<int> level(cellCount);
+  for (uint32_t i = 0; i < cellCount; ++i)
+  {
+    const uint8_t* cell = sample + i * SAMPLES_PER_CELL;
+    int sum = 0;
+    for (int j = 1; j < SAMPLES_PER_CELL - 1; ++j)
+    {
+      sum += cell[j];
+    }
+    level[i] = sum / (SAMPLES_PER_CELL - 2);
+  }
+  int white = level[0], black = level[1];
+  if (white - black < MIN_CONTRAST)
+  {
+    return -1;
+  }
+
+  // Threshold the code and parity cells and convert from Gray code
+  int threshold = (white + black) / 2;
+  uint32_t gray = 0, parity = 0;
+  for (uint32_t i = 0; i < bits; ++i)
+  {
+    uint32_t bit = (level[2 + i] > threshold) ? 1 : 0;
+    gray = (gray << 1) | bit;
+    parity ^= bit;
+  }
+  if (parity != ((level[cellCount - 1] > threshold) ? 1u : 0u))
+  {
+    return -1;
+  }
+  uint32_t number = gray;
+  for (uint32_t shift = 1; shift < 32; shift <<= 1)
+  {
+    number ^= number >> shift;
+  }
+  return number;
+}
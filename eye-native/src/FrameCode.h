@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <opencv2/core/core.hpp>
+
+// The FrameCode class paints the frame number into a horizontal strip of square cells so
+// camera or photodiode array footage of the projector can be aligned to source frames
+// offline. The strip starts with a white and a black reference cell that give the
+// decoder its threshold, followed by the frame number in Gray code with the most
+// significant bit first and an even parity cell. Gray code means a capture that blends
+// two consecutive frames differs from either in at most one cell, so it decodes to one
+// of them rather than to an unrelated number.
+class FrameCode
+{
+public:
+  FrameCode(uint32_t x, uint32_t y, uint32_t cellSize, uint32_t bits);
+  virtual ~FrameCode() {};
+
+  // Returns the number of cells in a strip for the given number of bits
+  static uint32_t getCellCount(uint32_t bits);
+
+  // Returns true if the strip fits in a frame of the given size
+  bool fits(uint32_t width, uint32_t height);
+
+  // Paints the code for the frame number into a BGRA frame
+  void paint(uint8_t* frame, uint32_t width, uint32_t height, uint32_t number);
+
+  // Decodes the frame number from the strip at the given position in a captured image,
+  // which may be gray, BGR, or BGRA. The cell size is given separately for each axis in
+  // image pixels since the camera rarely matches the projector. Returns -1 if the
+  // reference cells lack contrast or the parity doesn't match
+  static int64_t decode(const cv::Mat& image, double x, double y, double cellWidth,
+    double cellHeight, uint32_t bits);
+
+private:
+  uint32_t x;
+  uint32_t y;
+  uint32_t cellSize;
+  uint32_t bits;
+};
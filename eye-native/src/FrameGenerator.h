@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+// The FrameGenerator class is the interface for stimuli that are rendered natively
+// instead of being drawn by the stimulus window and captured. A generator is opened once
+// the output dimensions are known and then asked for each of its frames by number. The
+// output is BGRA at the output dimensions. Frames must depend only on their number so
+// renderFrame() can be called for several frames at once from different threads.
+class FrameGenerator
+{
+public:
+  FrameGenerator(std::string name, uint32_t count) :
+    generatorName(name),
+    frameCount(count)
+  {
+  };
+  virtual ~FrameGenerator() {};
+
+  std::string getName()
+  {
+    return generatorName;
+  }
+
+  uint32_t getFrameCount()
+  {
+    return frameCount;
+  }
+
+  virtual bool open(uint32_t width, uint32_t height, std::string& error) = 0;
+  virtual void renderFrame(uint32_t frameNumber, uint8_t* dest) = 0;
+
+  // Returns true if the given frame is identical to the one before it. Such frames are
+  // not rendered and share the buffer of the frame they repeat
+  virtual bool isRepeatFrame(uint32_t frameNumber)
+  {
+    return false;
+  }
+
+protected:
+  std::string generatorName;
+  uint32_t frameCount;
+};
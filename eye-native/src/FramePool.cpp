@@ -0,0 +1,76 @@
+#include "FramePool.h"
+#include <chrono>
+
+using namespace std;
+
+FramePool::FramePool(size_t length, uint32_t count) :
+  bufferLength(length),
+  bufferCount(count),
+  limit(count)
+{
+}
+
+FramePool::~FramePool()
+{
+  for (auto it = allBuffers.begin(); it != allBuffers.end(); ++it)
+  {
+    delete [] *it;
+  }
+}
+
+size_t FramePool::getBufferLength()
+{
+  return bufferLength;
+}
+
+uint32_t FramePool::getBufferCount()
+{
+  return bufferCount;
+}
+
+uint8_t* FramePool::acquire(int timeout)
+{
+  unique_lock<mutex> lock(poolMutex);
+  auto available = [this]
+  {
+    return (acquiredCount < limit) &&
+      (!freeBuffers.empty() || (allBuffers.size() < bufferCount));
+  };
+  if (!available() && (timeout > 0))
+  {
+    poolEvent.wait_for(lock, chrono::milliseconds(timeout), available);
+  }
+  if (!available())
+  {
+    return nullptr;
+  }
+  if (freeBuffers.empty())
+  {
+    uint8_t* buffer = new uint8_t[bufferLength];
+    allBuffers.push_back(buffer);
+    freeBuffers.push_back(buffer);
+  }
+  uint8_t* buffer = freeBuffers.back();
+  freeBuffers.pop_back();
+  acquiredCount += 1;
+  return buffer;
+}
+
+void FramePool::release(uint8_t* buffer)
+{
+  {
+    unique_lock<mutex> lock(poolMutex);
+    freeBuffers.push_back(buffer);
+    acquiredCount -= 1;
+  }
+  poolEvent.notify_one();
+}
+
+void FramePool::setLimit(uint32_t l)
+{
+  {
+    unique_lock<mutex> lock(poolMutex);
+    limit = l;
+  }
+  poolEvent.notify_all();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// The FramePool class owns up to a fixed number of equally sized frame buffers that are
+// handed out to producers and returned when the frame has been encoded. Reusing buffers
+// avoids allocating and faulting in several megabytes per frame, and because the pool
+// never grows past its count, a producer that gets ahead of the encoder blocks instead
+// of consuming memory. Buffers are allocated the first time they're needed so a pool
+// sized for the worst case only costs what its producer actually gets ahead by.
+class FramePool
+{
+public:
+  FramePool(size_t bufferLength, uint32_t bufferCount);
+  virtual ~FramePool();
+
+  size_t getBufferLength();
+  uint32_t getBufferCount();
+
+  // Waits up to the timeout in milliseconds for a free buffer. Returns null if none
+  // became available
+  uint8_t* acquire(int timeout);
+
+  // Returns a buffer to the pool
+  void release(uint8_t* buffer);
+
+  // Limits how many buffers can be handed out at once, which may be fewer than the pool
+  // holds. Raising the limit wakes a producer waiting for a buffer
+  void setLimit(uint32_t limit);
+
+private:
+  size_t bufferLength;
+  uint32_t bufferCount;
+  std::vector<uint8_t*> allBuffers;
+  std::vector<uint8_t*> freeBuffers;
+  uint32_t limit;
+  uint32_t acquiredCount = 0;
+  std::mutex poolMutex;
+  std::condition_variable poolEvent;
+};
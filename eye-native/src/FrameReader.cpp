@@ -0,0 +1,97 @@
+#include "FrameReader.h"
+#include "Platform.h"
+
+using namespace std;
+
+FrameReader::FrameReader(string name, uint64_t f, uint32_t w, uint32_t h,
+    shared_ptr<FramePool> pool, shared_ptr<Queue<shared_ptr<FrameWrapper>>> outputQueue) :
+  Thread(name),
+  file(f),
+  width(w),
+  height(h),
+  framePool(pool),
+  outputFrameQueue(outputQueue)
+{
+}
+
+bool FrameReader::isFinished()
+{
+  unique_lock<mutex> lock(finishedMutex);
+  return finished;
+}
+
+uint32_t FrameReader::run()
+{
+  size_t frameLength = (size_t)width * height * 4;
+  uint32_t frameNumber = 0;
+  while (!checkForExit())
+  {
+    // Wait for a free buffer. This blocks while the frames downstream hold them all
+    uint8_t* buffer = framePool->acquire(10);
+    if (buffer == nullptr)
+    {
+      continue;
+    }
+
+    // Fill the buffer and hand it off as a frame. The wrapper returns the buffer to the
+    // pool when the last reference to the frame is released
+    if (!readFrame(buffer, frameLength))
+    {
+      framePool->release(buffer);
+      break;
+    }
+    shared_ptr<FrameWrapper> wrapper(new FrameWrapper(frameNumber++));
+    wrapper->nativeFrame = buffer;
+    wrapper->nativeLength = frameLength;
+    wrapper->nativeWidth = width;
+    wrapper->nativeHeight = height;
+    wrapper->framePool = framePool;
+    outputFrameQueue->addItem(wrapper);
+  }
+  {
+    unique_lock<mutex> lock(finishedMutex);
+    finished = true;
+  }
+  return 0;
+}
+
+bool FrameReader::readFrame(uint8_t* buffer, size_t length)
+{
+  size_t filled = 0;
+  while (filled < length)
+  {
+    if (checkForExit())
+    {
+      return false;
+    }
+
+    // Block until data arrives, waking periodically to check for exit
+    int32_t ret = platform::waitForData(file, 10);
+    if (ret == -1)
+    {
+      printf("[FrameReader] ERROR: Failed to wait for data\n");
+      return false;
+    }
+    else if (ret == 0)
+    {
+      continue;
+    }
+
+    // Read as much of the rest of the frame as the pipe holds. A read of zero bytes
+    // means the other end has closed
+    bool closed = false;
+    size_t remaining = length - filled;
+    uint32_t maxLength = (remaining > 0x7FFFFFFF) ? 0x7FFFFFFF : (uint32_t)remaining;
+    ret = platform::read(file, buffer + filled, maxLength, closed);
+    if (ret <= 0)
+    {
+      if ((ret == -1) && !closed)
+      {
+        printf("[FrameReader] ERROR: Failed to read from pipe\n");
+      }
+      return false;
+    }
+    filled += ret;
+  }
+  return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include "FramePool.h"
+#include "FrameWrapper.h"
+#include "Queue.hpp"
+#include "Thread.h"
+
+// The FrameReader class reads a stream of raw BGRA frames from a pipe and delivers them
+// as complete frames. Each frame is read straight from the pipe into a buffer taken from
+// the pool, so the bytes are never copied after the kernel hands them over, and the
+// reader blocks while every buffer is in use rather than letting decoded video pile up.
+// Frames are numbered from zero in the order they're read. A partial frame left when
+// the pipe closes is discarded.
+class FrameReader : public Thread
+{
+public:
+  FrameReader(std::string name, uint64_t file, uint32_t width, uint32_t height,
+    std::shared_ptr<FramePool> framePool,
+    std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue);
+  virtual ~FrameReader() {};
+
+  // Returns true once the pipe has closed or failed and no more frames will arrive
+  bool isFinished();
+
+  uint32_t run();
+
+private:
+  bool readFrame(uint8_t* buffer, size_t length);
+
+private:
+  uint64_t file;
+  uint32_t width;
+  uint32_t height;
+  std::shared_ptr<FramePool> framePool;
+  std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue;
+  bool finished = false;
+  std::mutex finishedMutex;
+};
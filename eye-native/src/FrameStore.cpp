@@ -0,0 +1,334 @@
+#include "FrameStore.h"
+#include "Blake2b.h"
+#include "FrameArchive.h"
+#include "Lz4.h"
+#include "Platform.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+using namespace std;
+
+// Magic number and version used to identify objects and manifests
+#define MAGIC_NUMBER 0x53455945
+#define VERSION 1
+
+// Extension used for manifest files and temporary objects
+#define MANIFEST_EXTENSION ".manifest"
+#define TEMP_EXTENSION ".tmp"
+
+// Name of the lock file in the root of the store
+#define LOCK_FILE_NAME "store.lock"
+
+// Number of hex digits in a hash and in the name of the directory that holds it
+#define HASH_LENGTH 64
+#define PREFIX_LENGTH 2
+
+static bool endsWith(string value, string suffix)
+{
+  return (value.size() >= suffix.size()) &&
+    (value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+string framestore::hashFrame(uint32_t width, uint32_t height, const uint8_t* data,
+  size_t length)
+{
+  Blake2b hash;
+  uint32_t dimensions[2] = { width, height };
+  hash.update((const uint8_t*)dimensions, sizeof(dimensions));
+  hash.update(data, length);
+  uint8_t digest[32];
+  hash.finish(digest);
+  return Blake2b::toHex(digest, sizeof(digest));
+}
+
+string framestore::getObjectPath(string storePath, string hash)
+{
+  return storePath + "/objects/" + hash.substr(0, PREFIX_LENGTH) + "/" +
+    hash.substr(PREFIX_LENGTH);
+}
+
+string framestore::getManifestPath(string storePath, string runName)
+{
+  return storePath + "/manifests/" + runName + MANIFEST_EXTENSION;
+}
+
+string framestore::formatManifestHeader(uint32_t width, uint32_t height, uint32_t fps)
+{
+  stringstream header;
+  header << "eyeframes " << VERSION << " " << width << " " << height << " " << fps <<
+    "\n";
+  return header.str();
+}
+
+bool framestore::createDirectories(string storePath, string& error)
+{
+  if (!platform::createDirectory(storePath) ||
+    !platform::createDirectory(storePath + "/objects") ||
+    !platform::createDirectory(storePath + "/manifests"))
+  {
+    error = "Failed to create frame store in " + storePath;
+    return false;
+  }
+  return true;
+}
+
+bool framestore::lockStore(string storePath, bool exclusive, uint64_t& lockId,
+  string& error)
+{
+  if (!platform::lockFile(storePath + "/" + LOCK_FILE_NAME, exclusive, lockId))
+  {
+    error = exclusive ? "Frame store is in use by a recording" :
+      "Frame store is being garbage collected";
+    return false;
+  }
+  return true;
+}
+
+void framestore::unlockStore(uint64_t lockId)
+{
+  platform::unlockFile(lockId);
+}
+
+bool framestore::writeObject(string storePath, string hash, string tempSuffix,
+  uint32_t width, uint32_t height, uint32_t compression, const uint8_t* block,
+  uint32_t blockLength, string& error)
+{
+  if (!platform::createDirectory(storePath + "/objects/" + hash.substr(0, PREFIX_LENGTH)))
+  {
+    error = "Failed to create object directory for " + hash;
+    return false;
+  }
+
+  // Write the object under a temporary name and rename it into place so other runs
+  // never see a partially written object
+  string objectPath = getObjectPath(storePath, hash);
+  string tempPath = objectPath + "." + tempSuffix + TEMP_EXTENSION;
+  {
+    ofstream file(tempPath, ios::out | ios::binary | ios::trunc);
+    if (!file.is_open())
+    {
+      error = "Failed to create " + tempPath;
+      return false;
+    }
+    uint8_t header[FRAME_STORE_OBJECT_HEADER_SIZE];
+    uint32_t magicNumber = MAGIC_NUMBER, version = VERSION;
+    memset(header, 0, sizeof(header));
+    memcpy(&header[0], &magicNumber, sizeof(uint32_t));
+    memcpy(&header[4], &version, sizeof(uint32_t));
+    memcpy(&header[8], &width, sizeof(uint32_t));
+    memcpy(&header[12], &height, sizeof(uint32_t));
+    memcpy(&header[16], &compression, sizeof(uint32_t));
+    memcpy(&header[20], &blockLength, sizeof(uint32_t));
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)block, blockLength);
+    if (!file.good())
+    {
+      file.close();
+      platform::deleteFile(tempPath);
+      error = "Failed to write " + tempPath;
+      return false;
+    }
+  }
+  if (!platform::renameFile(tempPath, objectPath))
+  {
+    platform::deleteFile(tempPath);
+    error = "Failed to rename " + tempPath;
+    return false;
+  }
+  return true;
+}
+
+bool framestore::readObject(string storePath, string hash, uint32_t width,
+  uint32_t height, uint8_t* dest, string& error)
+{
+  string objectPath = getObjectPath(storePath, hash);
+  ifstream file(objectPath, ios::in | ios::binary);
+  if (!file.is_open())
+  {
+    error = "Frame " + hash + " is not in the store";
+    return false;
+  }
+
+  // Parse and verify the header
+  uint8_t header[FRAME_STORE_OBJECT_HEADER_SIZE];
+  uint32_t magicNumber, version, objectWidth, objectHeight, compression, blockLength;
+  if (!file.read((char*)header, sizeof(header)))
+  {
+    error = "Truncated object " + objectPath;
+    return false;
+  }
+  memcpy(&magicNumber, &header[0], sizeof(uint32_t));
+  memcpy(&version, &header[4], sizeof(uint32_t));
+  memcpy(&objectWidth, &header[8], sizeof(uint32_t));
+  memcpy(&objectHeight, &header[12], sizeof(uint32_t));
+  memcpy(&compression, &header[16], sizeof(uint32_t));
+  memcpy(&blockLength, &header[20], sizeof(uint32_t));
+  if ((magicNumber != MAGIC_NUMBER) || (version != VERSION) || (objectWidth != width) ||
+    (objectHeight != height))
+  {
+    error = "Invalid object header in " + objectPath;
+    return false;
+  }
+
+  // Read the block and copy or decompress it into the destination
+  uint32_t frameLength = width * height * 4;
+  vector<uint8_t> block(blockLength);
+  if (!file.read((char*)block.data(), blockLength))
+  {
+    error = "Truncated object " + objectPath;
+    return false;
+  }
+  if ((compression == FRAME_ARCHIVE_COMPRESSION_NONE) && (blockLength == frameLength))
+  {
+    memcpy(dest, block.data(), frameLength);
+  }
+  else if ((compression != FRAME_ARCHIVE_COMPRESSION_LZ4) ||
+    !lz4::decompress(block.data(), blockLength, dest, frameLength))
+  {
+    error = "Failed to decode object " + objectPath;
+    return false;
+  }
+  return true;
+}
+
+bool framestore::readManifest(string manifestPath, uint32_t& width, uint32_t& height,
+  uint32_t& fps, vector<string>& hashes, string& error)
+{
+  ifstream file(manifestPath);
+  if (!file.is_open())
+  {
+    error = "Failed to open " + manifestPath;
+    return false;
+  }
+
+  // Parse the header line
+  string line, tag;
+  uint32_t version = 0;
+  if (!getline(file, line))
+  {
+    error = "Empty manifest " + manifestPath;
+    return false;
+  }
+  stringstream header(line);
+  header >> tag >> version >> width >> height >> fps;
+  if (header.fail() || (tag != "eyeframes") || (version != VERSION))
+  {
+    error = "Invalid manifest header in " + manifestPath;
+    return false;
+  }
+
+  // Read one hash per line
+  hashes.clear();
+  while (getline(file, line))
+  {
+    if (line.empty())
+    {
+      continue;
+    }
+    if (line.size() != HASH_LENGTH)
+    {
+      // A partial last line is left behind when a recording is interrupted
+      if (file.peek() == EOF)
+      {
+        break;
+      }
+      error = "Invalid hash in " + manifestPath;
+      return false;
+    }
+    hashes.push_back(line);
+  }
+  return true;
+}
+
+static bool deleteUnreferenced(string storePath, uint32_t& removedCount,
+  uint64_t& removedBytes, uint32_t& keptCount, string& error)
+{
+  // Gather the hashes referenced by every manifest. Refuse to continue if any manifest
+  // can't be read because deleting its frames would be irreversible
+  vector<string> manifests;
+  if (!platform::listDirectory(storePath + "/manifests", manifests))
+  {
+    error = "Failed to list manifests in " + storePath;
+    return false;
+  }
+  unordered_set<string> referenced;
+  for (auto it = manifests.begin(); it != manifests.end(); ++it)
+  {
+    if (!endsWith(*it, MANIFEST_EXTENSION))
+    {
+      continue;
+    }
+    uint32_t width, height, fps;
+    vector<string> hashes;
+    if (!framestore::readManifest(storePath + "/manifests/" + *it, width, height, fps,
+      hashes, error))
+    {
+      return false;
+    }
+    referenced.insert(hashes.begin(), hashes.end());
+  }
+
+  // Walk the objects and delete those that aren't referenced, along with any temporary
+  // files left behind by an interrupted recording
+  vector<string> prefixes;
+  if (!platform::listDirectory(storePath + "/objects", prefixes))
+  {
+    error = "Failed to list objects in " + storePath;
+    return false;
+  }
+  for (auto prefix = prefixes.begin(); prefix != prefixes.end(); ++prefix)
+  {
+    string directory = storePath + "/objects/" + *prefix;
+    vector<string> objects;
+    if ((prefix->size() != PREFIX_LENGTH) || !platform::listDirectory(directory, objects))
+    {
+      continue;
+    }
+    for (auto object = objects.begin(); object != objects.end(); ++object)
+    {
+      string hash = *prefix + *object;
+      if (!endsWith(*object, TEMP_EXTENSION) && (referenced.count(hash) != 0))
+      {
+        keptCount += 1;
+        continue;
+      }
+      string objectPath = directory + "/" + *object;
+      uint64_t size = 0, modifiedTimeUsec;
+      platform::getFileInfo(objectPath, size, modifiedTimeUsec);
+      if (platform::deleteFile(objectPath))
+      {
+        removedCount += 1;
+        removedBytes += size;
+      }
+    }
+  }
+  return true;
+}
+
+bool framestore::collectGarbage(string storePath, uint32_t& removedCount,
+  uint64_t& removedBytes, uint32_t& keptCount, string& error)
+{
+  removedCount = 0;
+  removedBytes = 0;
+  keptCount = 0;
+
+  uint64_t size, modifiedTimeUsec, lockId;
+  if (!platform::getFileInfo(storePath + "/manifests", size, modifiedTimeUsec))
+  {
+    error = "No frame store in " + storePath;
+    return false;
+  }
+
+  // Hold the store exclusively so no recording, in this process or another, can add an
+  // object or reference an existing one while the manifests are being read
+  if (!lockStore(storePath, true, lockId, error))
+  {
+    return false;
+  }
+  bool success = deleteUnreferenced(storePath, removedCount, removedBytes, keptCount,
+    error);
+  unlockStore(lockId);
+  return success;
+}
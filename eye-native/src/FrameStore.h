@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// These functions manage the frame store, a content-addressed directory that is shared
+// across runs and programs. Each unique frame is stored once under the hash of its
+// contents so frames that are rendered again and again only cost a reference. The store
+// is laid out as follows:
+//
+// - objects/<first two hex digits>/<remaining hex digits>: one file per unique frame
+//   - Magic number (uint32_t)
+//   - Version (uint32_t)
+//   - Width (uint32_t)
+//   - Height (uint32_t)
+//   - Compression (uint32_t), one of the frame archive codecs
+//   - Stored length (uint32_t)
+//   - Reserved (8 bytes)
+//   - Frame block (variable)
+// - manifests/<run name>.manifest: one text file per run. The first line is
+//   "eyeframes <version> <width> <height> <fps>" and every following line holds the
+//   hash of the next frame in the run
+// - store.lock: an empty file that recordings lock shared while they write to the store
+//   and garbage collection locks exclusively, so the two never overlap even when they
+//   run in different processes
+//
+// The hash of a frame is the 32-byte BLAKE2b digest of its width and height (uint32_t
+// each) followed by its BGRA pixels, written as 64 lowercase hex digits.
+
+// The number of bytes in the header of each object
+#define FRAME_STORE_OBJECT_HEADER_SIZE 32
+
+namespace framestore
+{
+  std::string hashFrame(uint32_t width, uint32_t height, const uint8_t* data,
+    size_t length);
+
+  std::string getObjectPath(std::string storePath, std::string hash);
+  std::string getManifestPath(std::string storePath, std::string runName);
+
+  std::string formatManifestHeader(uint32_t width, uint32_t height, uint32_t fps);
+  bool createDirectories(std::string storePath, std::string& error);
+  bool lockStore(std::string storePath, bool exclusive, uint64_t& lockId,
+    std::string& error);
+  void unlockStore(uint64_t lockId);
+  bool writeObject(std::string storePath, std::string hash, std::string tempSuffix,
+    uint32_t width, uint32_t height, uint32_t compression, const uint8_t* block,
+    uint32_t blockLength, std::string& error);
+  bool readObject(std::string storePath, std::string hash, uint32_t width,
+    uint32_t height, uint8_t* dest, std::string& error);
+  bool readManifest(std::string manifestPath, uint32_t& width, uint32_t& height,
+    uint32_t& fps, std::vector<std::string>& hashes, std::string& error);
+
+  // Delete every object that is not referenced by a manifest. Fails without deleting
+  // anything if a recording holds the store lock
+  bool collectGarbage(std::string storePath, uint32_t& removedCount,
+    uint64_t& removedBytes, uint32_t& keptCount, std::string& error);
+}
@@ -0,0 +1,148 @@
+#include "FrameStoreWriter.h"
+#include "FrameArchive.h"
+#include "FrameStore.h"
+#include "Lz4.h"
+#include "Platform.h"
+#include <cstring>
+
+using namespace std;
+
+FrameStoreWriter::FrameStoreWriter(string store, string run, uint32_t codec) :
+  RecordStage("framestore"),
+  storePath(store),
+  runName(run),
+  compression(codec)
+{
+}
+
+bool FrameStoreWriter::open(uint32_t wid, uint32_t hgt, uint32_t fps, string& error)
+{
+  width = wid;
+  height = hgt;
+  if (!framestore::createDirectories(storePath, error))
+  {
+    return false;
+  }
+
+  // Hold a shared lock on the store until the recording finishes so garbage collection
+  // can't delete an object between finding it in the store and referencing it
+  if (!framestore::lockStore(storePath, false, storeLock, error))
+  {
+    return false;
+  }
+  storeLocked = true;
+
+  // Create the manifest and write its header line
+  string manifestPath = framestore::getManifestPath(storePath, runName);
+  manifest.open(manifestPath, ios::out | ios::trunc);
+  if (!manifest.is_open())
+  {
+    error = "Failed to create " + manifestPath;
+    string closeError;
+    close(closeError);
+    return false;
+  }
+  manifest << framestore::formatManifestHeader(width, height, fps);
+  manifest.flush();
+
+  // Allocate the working buffers once up front
+  size_t frameLength = (size_t)width * height * 4;
+  if (compression == FRAME_ARCHIVE_COMPRESSION_LZ4)
+  {
+    compressBuffer.resize(lz4::compressBound((uint32_t)frameLength));
+  }
+  previousFrame.resize(frameLength);
+  previousHash.clear();
+  return manifest.good();
+}
+
+bool FrameStoreWriter::processFrame(shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+  size_t length, string& error)
+{
+  if (length != previousFrame.size())
+  {
+    error = "Unexpected frame length";
+    return false;
+  }
+
+  // Stimuli hold each frame for many refreshes so compare against the previous frame
+  // before paying for the hash
+  string hash;
+  if (!previousHash.empty() && (wrapper->repeatFrame ||
+    (memcmp(previousFrame.data(), data, length) == 0)))
+  {
+    hash = previousHash;
+  }
+  else
+  {
+    hash = framestore::hashFrame(width, height, data, length);
+    memcpy(previousFrame.data(), data, length);
+    previousHash = hash;
+  }
+
+  // Store the frame if neither this run nor an earlier one has already done so
+  if (knownHashes.count(hash) == 0)
+  {
+    uint64_t size, modifiedTimeUsec;
+    if (!platform::getFileInfo(framestore::getObjectPath(storePath, hash), size,
+      modifiedTimeUsec) && !storeFrame(hash, data, length, error))
+    {
+      return false;
+    }
+    knownHashes.insert(hash);
+  }
+
+  // Flush each line so the manifest protects its frames even if the run is interrupted
+  manifest << hash << "\n";
+  manifest.flush();
+  if (!manifest.good())
+  {
+    error = "Failed to write manifest";
+    return false;
+  }
+  return true;
+}
+
+bool FrameStoreWriter::close(string& error)
+{
+  // Release the store once the manifest is closed
+  bool success = true;
+  if (manifest.is_open())
+  {
+    manifest.close();
+    knownHashes.clear();
+    if (manifest.fail())
+    {
+      error = "Failed to close manifest";
+      success = false;
+    }
+  }
+  if (storeLocked)
+  {
+    framestore::unlockStore(storeLock);
+    storeLocked = false;
+  }
+  return success;
+}
+
+bool FrameStoreWriter::storeFrame(string hash, const uint8_t* data, size_t length,
+  string& error)
+{
+  // Compress the frame and fall back to storing it raw if that doesn't save space
+  uint32_t codec = FRAME_ARCHIVE_COMPRESSION_NONE;
+  const uint8_t* block = data;
+  uint32_t blockLength = (uint32_t)length;
+  if (compression == FRAME_ARCHIVE_COMPRESSION_LZ4)
+  {
+    uint32_t compressedLength = lz4::compress(data, (uint32_t)length,
+      compressBuffer.data(), (uint32_t)compressBuffer.size());
+    if ((compressedLength != 0) && (compressedLength < length))
+    {
+      codec = FRAME_ARCHIVE_COMPRESSION_LZ4;
+      block = compressBuffer.data();
+      blockLength = compressedLength;
+    }
+  }
+  return framestore::writeObject(storePath, hash, runName, width, height, codec, block,
+    blockLength, error);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <fstream>
+#include <unordered_set>
+#include <vector>
+#include "RecordStage.h"
+
+// The FrameStoreWriter class is a record stage that hashes each frame, adds frames the
+// store hasn't seen before, and appends every hash to the run's manifest. Repeated
+// frames cost a hash and a manifest line, and consecutive identical frames skip even
+// the hash.
+class FrameStoreWriter : public RecordStage
+{
+public:
+  FrameStoreWriter(std::string storePath, std::string runName, uint32_t compression);
+  virtual ~FrameStoreWriter() {};
+
+  bool open(uint32_t width, uint32_t height, uint32_t fps, std::string& error) override;
+  bool processFrame(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length, std::string& error) override;
+  bool close(std::string& error) override;
+
+private:
+  bool storeFrame(std::string hash, const uint8_t* data, size_t length,
+    std::string& error);
+
+private:
+  std::string storePath;
+  std::string runName;
+  uint32_t compression;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::ofstream manifest;
+  std::vector<uint8_t> compressBuffer;
+  std::vector<uint8_t> previousFrame;
+  std::string previousHash;
+  std::unordered_set<std::string> knownHashes;
+  uint64_t storeLock = 0;
+  bool storeLocked = false;
+};
@@ -4,6 +4,8 @@ FrameWrapper::FrameWrapper(uint32_t num) :
   number(num),
   timestampMs(0),
   fps(0),
+  videoIndex(0),
+  recordIndex(0),
   electronFrame(0),
   electronLength(0),
   electronWidth(0),
@@ -11,15 +13,23 @@ FrameWrapper::FrameWrapper(uint32_t num) :
   nativeFrame(0),
   nativeLength(0),
   nativeWidth(0),
-  nativeHeight(0)
+  nativeHeight(0),
+  repeatFrame(false)
 {
 }
 
 FrameWrapper::~FrameWrapper()
 {
-  if (nativeFrame != 0)
+  if ((nativeFrame != 0) && (sourceFrame == nullptr))
   {
-    delete [] nativeFrame;
+    if (framePool != nullptr)
+    {
+      framePool->release(nativeFrame);
+    }
+    else
+    {
+      delete [] nativeFrame;
+    }
     nativeFrame = 0;
   }
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <stddef.h>
+#include "FramePool.h"
 
 class FrameWrapper
 {
@@ -14,6 +16,13 @@ public:
   uint64_t timestampMs;
   uint32_t fps;
 
+  // Index of the video in the playlist that the frame came from during playback
+  uint32_t videoIndex;
+
+  // Position of the frame in the video being recorded, assigned by the record thread.
+  // Frame numbers keep counting across recordings so they can't be used for this
+  uint32_t recordIndex;
+
   // A pointer to the raw frame bytes from the Electron framework, the
   // buffer length, and the frame dimensions. Data is encoded in the BGRA
   // colorspace. This memory is owned by the framework and should not be
@@ -31,4 +40,14 @@ public:
   size_t nativeLength;
   uint32_t nativeWidth;
   uint32_t nativeHeight;
+
+  // The pool that the native frame was taken from, if any. The buffer is returned to
+  // the pool rather than deleted when the wrapper is released
+  std::shared_ptr<FramePool> framePool;
+
+  // Set when the frame is known to be identical to the one before it so stages can
+  // reuse their previous result. A repeated frame may share the native buffer of the
+  // frame it repeats, in which case that frame is held here and owns the buffer
+  bool repeatFrame;
+  std::shared_ptr<FrameWrapper> sourceFrame;
 };
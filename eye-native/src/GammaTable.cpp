@@ -0,0 +1,169 @@
+#include "GammaTable.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+// Number of entries in a table
+#define TABLE_SIZE 256
+
+// Dither thresholds of the 2 x 2 Bayer matrix in the order of the dither positions
+static const double DITHER_THRESHOLDS[4] = { 0.125, 0.625, 0.875, 0.375 };
+
+GammaTable::GammaTable()
+{
+  uint32_t values[3][TABLE_SIZE];
+  for (uint32_t i = 0; i < TABLE_SIZE; ++i)
+  {
+    values[0][i] = values[1][i] = values[2][i] = i;
+  }
+  build(values, 8);
+}
+
+shared_ptr<GammaTable> GammaTable::load(string path, string& error)
+{
+  ifstream file(path);
+  if (!file.is_open())
+  {
+    error = "Failed to open " + path;
+    return nullptr;
+  }
+
+  // Read the precision and levels. Values are kept in red, green, blue order until the
+  // table is built
+  uint32_t bits = 8, count = 0;
+  uint32_t values[3][TABLE_SIZE];
+  string line;
+  while (getline(file, line))
+  {
+    size_t start = line.find_first_not_of(" \t\r");
+    if ((start == string::npos) || (line[start] == '#'))
+    {
+      continue;
+    }
+    stringstream stream(line.substr(start));
+    if (line.compare(start, 4, "bits") == 0)
+    {
+      string tag;
+      stream >> tag >> bits;
+      if (stream.fail() || (count > 0) || ((bits != 8) && (bits != 10) && (bits != 16)))
+      {
+        error = "Invalid precision in " + path;
+        return nullptr;
+      }
+      continue;
+    }
+    if (count == TABLE_SIZE)
+    {
+      error = "Too many levels in " + path;
+      return nullptr;
+    }
+    int64_t red, green, blue;
+    stream >> red;
+    if (!(stream >> green >> blue))
+    {
+      green = blue = red;
+    }
+    int64_t maxValue = ((int64_t)1 << bits) - 1;
+    if ((red < 0) || (green < 0) || (blue < 0) || (red > maxValue) ||
+      (green > maxValue) || (blue > maxValue))
+    {
+      error = "Invalid level on line " + to_string(count + 1) + " of " + path;
+      return nullptr;
+    }
+    values[2][count] = (uint32_t)red;
+    values[1][count] = (uint32_t)green;
+    values[0][count] = (uint32_t)blue;
+    count += 1;
+  }
+  if (count != TABLE_SIZE)
+  {
+    error = "Expected 256 levels in " + path;
+    return nullptr;
+  }
+  shared_ptr<GammaTable> table(new GammaTable());
+  table->build(values, bits);
+  return table;
+}
+
+uint32_t GammaTable::getBits()
+{
+  return bits;
+}
+
+bool GammaTable::isIdentity()
+{
+  return identity;
+}
+
+void GammaTable::apply(uint8_t* frame, uint32_t width, uint32_t height)
+{
+  if (identity)
+  {
+    return;
+  }
+
+  // Without dithering every pixel uses the same table so the frame is one long run
+  if (bits == 8)
+  {
+    const uint8_t* blue = levels[0][0];
+    const uint8_t* green = levels[0][1];
+    const uint8_t* red = levels[0][2];
+    uint8_t* end = frame + (size_t)width * height * 4;
+    for (uint8_t* pixel = frame; pixel < end; pixel += 4)
+    {
+      pixel[0] = blue[pixel[0]];
+      pixel[1] = green[pixel[1]];
+      pixel[2] = red[pixel[2]];
+    }
+    return;
+  }
+
+  // Otherwise look up two pixels at a time so the dither position of each is fixed
+  // within the inner loop
+  for (uint32_t y = 0; y < height; ++y)
+  {
+    uint8_t* pixel = frame + (size_t)y * width * 4;
+    const uint8_t (*even)[TABLE_SIZE] = levels[(y & 1) * 2];
+    const uint8_t (*odd)[TABLE_SIZE] = levels[(y & 1) * 2 + 1];
+    uint32_t x = 0;
+    for (; x + 1 < width; x += 2, pixel += 8)
+    {
+      pixel[0] = even[0][pixel[0]];
+      pixel[1] = even[1][pixel[1]];
+      pixel[2] = even[2][pixel[2]];
+      pixel[4] = odd[0][pixel[4]];
+      pixel[5] = odd[1][pixel[5]];
+      pixel[6] = odd[2][pixel[6]];
+    }
+    if (x < width)
+    {
+      pixel[0] = even[0][pixel[0]];
+      pixel[1] = even[1][pixel[1]];
+      pixel[2] = even[2][pixel[2]];
+    }
+  }
+}
+
+bool GammaTable::build(const uint32_t values[3][TABLE_SIZE], uint32_t precision)
+{
+  // Scale the levels to 8 bits, dithering tables with more precision
+  bits = precision;
+  identity = true;
+  double scale = 255.0 / (double)((1u << bits) - 1);
+  for (uint32_t position = 0; position < 4; ++position)
+  {
+    double threshold = (bits == 8) ? 0.5 : DITHER_THRESHOLDS[position];
+    for (uint32_t channel = 0; channel < 3; ++channel)
+    {
+      for (uint32_t i = 0; i < TABLE_SIZE; ++i)
+      {
+        double level = floor(values[channel][i] * scale + threshold);
+        levels[position][channel][i] = (uint8_t)min(level, 255.0);
+        identity &= (levels[position][channel][i] == i);
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+// The GammaTable class corrects frames for the measured transfer curve of a projector
+// by looking up the output level of each channel in a table loaded from a calibration
+// file. Correction is applied to BGRA frames in place, either as they're recorded or
+// just before they're displayed, so the same video can be shown on rigs with different
+// calibrations without being rendered again.
+//
+// A calibration file is a text file with an optional "bits <n>" line giving the
+// precision of the table, 8, 10, or 16 bits, followed by 256 lines of output levels for
+// input levels 0 through 255. Each line holds either one level used for all channels or
+// separate red, green, and blue levels. Blank lines and lines starting with "#" are
+// ignored. Frames are 8 bits per channel, so tables with more precision are applied
+// with a 2 x 2 ordered dither that keeps the extra precision on average across
+// neighboring pixels.
+class GammaTable
+{
+public:
+  GammaTable();
+  virtual ~GammaTable() {};
+
+  static std::shared_ptr<GammaTable> load(std::string path, std::string& error);
+
+  uint32_t getBits();
+  bool isIdentity();
+
+  // Corrects a BGRA frame in place. Alpha is left unchanged
+  void apply(uint8_t* frame, uint32_t width, uint32_t height);
+
+private:
+  bool build(const uint32_t values[3][256], uint32_t bits);
+
+private:
+  uint32_t bits = 8;
+  bool identity = true;
+
+  // Output level for each dither position, (x & 1) + 2 * (y & 1), each channel in BGR
+  // order, and each input level
+  uint8_t levels[4][3][256];
+};
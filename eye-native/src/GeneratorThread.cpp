@@ -0,0 +1,132 @@
+#include "GeneratorThread.h"
+#include <opencv2/core/core.hpp>
+
+using namespace std;
+using namespace cv;
+
+GeneratorThread::GeneratorThread(shared_ptr<Queue<shared_ptr<FrameWrapper>>> outputQueue,
+    uint32_t wid, uint32_t hgt) :
+  Thread("generator"),
+  workQueue(new Queue<Work>()),
+  outputFrameQueue(outputQueue),
+  width(wid),
+  height(hgt)
+{
+  // Size the pool so one batch can be rendered while the previous one is encoded
+  batchSize = (uint32_t)max(getNumThreads(), 1);
+  framePool = shared_ptr<FramePool>(new FramePool((size_t)width * height * 4,
+    batchSize * 2));
+}
+
+void GeneratorThread::queueGenerator(shared_ptr<FrameGenerator> generator,
+  uint32_t firstFrameId)
+{
+  Work work;
+  work.generator = generator;
+  work.firstFrameId = firstFrameId;
+  workQueue->addItem(work);
+}
+
+void GeneratorThread::queueFrame(shared_ptr<FrameWrapper> wrapper)
+{
+  Work work;
+  work.firstFrameId = wrapper->number;
+  work.frame = wrapper;
+  workQueue->addItem(work);
+}
+
+uint32_t GeneratorThread::run()
+{
+  while (!checkForExit())
+  {
+    Work work;
+    if (!workQueue->waitItem(&work, 10))
+    {
+      continue;
+    }
+    if (work.frame != nullptr)
+    {
+      outputFrameQueue->addItem(work.frame);
+    }
+    else
+    {
+      runGenerator(work.generator, work.firstFrameId);
+    }
+  }
+  return 0;
+}
+
+bool GeneratorThread::terminate(uint32_t timeout /*= 100*/)
+{
+  // Allow the batch in progress to finish rendering
+  return Thread::terminate(5000);
+}
+
+void GeneratorThread::runGenerator(shared_ptr<FrameGenerator> generator,
+  uint32_t firstFrameId)
+{
+  string error;
+  if (!generator->open(width, height, error))
+  {
+    fprintf(stderr, "[GeneratorThread] ERROR: Failed to open %s generator: %s\n",
+      generator->getName().c_str(), error.c_str());
+    return;
+  }
+  uint32_t frameCount = generator->getFrameCount();
+  uint32_t nextFrame = 0;
+  shared_ptr<FrameWrapper> lastRendered;
+  while ((nextFrame < frameCount) && !checkForExit())
+  {
+    // Take a buffer from the pool for each frame in the batch that needs rendering.
+    // This blocks while the encoder is behind. Repeated frames share the buffer of the
+    // last rendered frame instead
+    uint32_t count = min(batchSize, frameCount - nextFrame);
+    vector<shared_ptr<FrameWrapper>> wrappers, rendered;
+    while ((wrappers.size() < count) && !checkForExit())
+    {
+      uint32_t frameNumber = nextFrame + (uint32_t)wrappers.size();
+      shared_ptr<FrameWrapper> wrapper(new FrameWrapper(firstFrameId + frameNumber));
+      wrapper->nativeWidth = width;
+      wrapper->nativeHeight = height;
+      wrapper->nativeLength = framePool->getBufferLength();
+      if ((lastRendered != nullptr) && generator->isRepeatFrame(frameNumber))
+      {
+        wrapper->nativeFrame = lastRendered->nativeFrame;
+        wrapper->repeatFrame = true;
+        wrapper->sourceFrame = lastRendered;
+      }
+      else
+      {
+        uint8_t* buffer = framePool->acquire(50);
+        if (buffer == nullptr)
+        {
+          continue;
+        }
+        wrapper->nativeFrame = buffer;
+        wrapper->framePool = framePool;
+        rendered.push_back(wrapper);
+        lastRendered = wrapper;
+      }
+      wrappers.push_back(wrapper);
+    }
+    if (wrappers.size() < count)
+    {
+      break;
+    }
+
+    // Render the new frames in parallel and queue the batch in order
+    parallel_for_(Range(0, (int)rendered.size()), [&](const Range& range)
+    {
+      for (int i = range.start; i < range.end; ++i)
+      {
+        generator->renderFrame(rendered[i]->number - firstFrameId,
+          rendered[i]->nativeFrame);
+      }
+    });
+    for (auto it = wrappers.begin(); it != wrappers.end(); ++it)
+    {
+      outputFrameQueue->addItem(*it);
+    }
+    nextFrame += count;
+  }
+}
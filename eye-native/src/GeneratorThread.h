@@ -0,0 +1,47 @@
+#pragma once
+
+#include "FrameGenerator.h"
+#include "FramePool.h"
+#include "FrameWrapper.h"
+#include "Queue.hpp"
+#include "Thread.h"
+
+// The GeneratorThread class renders natively generated stimuli into pooled frame buffers
+// and feeds them to the record thread. Frames captured from the stimulus window are
+// passed through the same thread once it exists so that captured and generated frames
+// reach the encoder in the order they were queued. Each batch of generated frames is
+// rendered in parallel, one frame per worker, and then queued in frame order. Frames
+// that repeat the previous one are not rendered and share its buffer.
+class GeneratorThread : public Thread
+{
+public:
+  GeneratorThread(std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue,
+    uint32_t width, uint32_t height);
+  virtual ~GeneratorThread() {};
+
+  void queueGenerator(std::shared_ptr<FrameGenerator> generator, uint32_t firstFrameId);
+  void queueFrame(std::shared_ptr<FrameWrapper> wrapper);
+
+  uint32_t run() override;
+
+  bool terminate(uint32_t timeout = 100) override;
+
+private:
+  void runGenerator(std::shared_ptr<FrameGenerator> generator, uint32_t firstFrameId);
+
+private:
+  // Work is either a generator with the ID of its first frame or a captured frame
+  struct Work
+  {
+    std::shared_ptr<FrameGenerator> generator;
+    uint32_t firstFrameId;
+    std::shared_ptr<FrameWrapper> frame;
+  };
+
+  std::shared_ptr<Queue<Work>> workQueue;
+  std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue;
+  uint32_t width;
+  uint32_t height;
+  uint32_t batchSize;
+  std::shared_ptr<FramePool> framePool;
+};
@@ -0,0 +1,158 @@
+#include "GlyphAtlas.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Number of samples along each axis of a pixel
+#define SUPERSAMPLING 4
+
+// The Sloan grid and stroke width in grid units
+#define GRID 5.0
+#define STROKE 1.0
+
+static bool rect(double u, double v, double left, double top, double right,
+  double bottom)
+{
+  return (u >= left) && (u < right) && (v >= top) && (v < bottom);
+}
+
+static bool ring(double u, double v, double centerU, double centerV, double radiusU,
+  double radiusV)
+{
+  // Elliptical ring with the given outer radii and a stroke of one unit
+  double du = u - centerU, dv = v - centerV;
+  double outer = (du * du) / (radiusU * radiusU) + (dv * dv) / (radiusV * radiusV);
+  double innerU = radiusU - STROKE, innerV = radiusV - STROKE;
+  double inner = (du * du) / (innerU * innerU) + (dv * dv) / (innerV * innerV);
+  return (outer <= 1.0) && (inner >= 1.0);
+}
+
+static bool band(double u, double v, double startU, double startV, double endU,
+  double endV)
+{
+  // Diagonal stroke one unit wide centered on the line through the two points
+  double du = endU - startU, dv = endV - startV;
+  double distance = fabs((u - startU) * dv - (v - startV) * du) / sqrt(du * du + dv * dv);
+  return distance <= STROKE / 2;
+}
+
+static bool covers(char letter, double u, double v)
+{
+  switch (letter)
+  {
+  case 'C':
+    return ring(u, v, 2.5, 2.5, 2.5, 2.5) && !((u > 2.5) && (fabs(v - 2.5) < 0.5));
+  case 'D':
+    return rect(u, v, 0, 0, 1, 5) || ((u < 2.5) && (rect(u, v, 0, 0, 2.5, 1) ||
+      rect(u, v, 0, 4, 2.5, 5))) || ((u >= 2.5) && ring(u, v, 2.5, 2.5, 2.5, 2.5));
+  case 'H':
+    return rect(u, v, 0, 0, 1, 5) || rect(u, v, 4, 0, 5, 5) || rect(u, v, 0, 2, 5, 3);
+  case 'K':
+    return rect(u, v, 0, 0, 1, 5) || ((u >= 1) && band(u, v, 1, 3.6, 4.6, 0)) ||
+      ((u >= 2) && (v >= 2) && band(u, v, 1.6, 1.6, 4.6, 5));
+  case 'N':
+    return rect(u, v, 0, 0, 1, 5) || rect(u, v, 4, 0, 5, 5) ||
+      ((u >= 0.5) && (u <= 4.5) && band(u, v, 0.6, 0, 4.4, 5));
+  case 'O':
+    return ring(u, v, 2.5, 2.5, 2.5, 2.5);
+  case 'R':
+    return rect(u, v, 0, 0, 1, 5) || ((u < 3) && (rect(u, v, 0, 0, 3, 1) ||
+      rect(u, v, 0, 2, 3, 3))) || ((u >= 3) && (v < 3) && ring(u, v, 3, 1.5, 2, 1.5)) ||
+      ((v >= 3) && (u >= 1.5) && band(u, v, 2.2, 2.5, 4.6, 5));
+  case 'S':
+    return (ring(u, v, 2.5, 1.5, 2.5, 1.5) && !((u > 2.5) && (v > 1.5)) &&
+      !((u > 3.5) && (v > 1.2))) || (ring(u, v, 2.5, 3.5, 2.5, 1.5) &&
+      !((u < 2.5) && (v < 3.5)) && !((u < 1.5) && (v < 3.8)));
+  case 'V':
+    return band(u, v, 0.5, 0, 2.5, 5) || band(u, v, 4.5, 0, 2.5, 5);
+  case 'Z':
+    return rect(u, v, 0, 0, 5, 1) || rect(u, v, 0, 4, 5, 5) ||
+      ((v >= 0.5) && (v <= 4.5) && band(u, v, 4.5, 1, 0.5, 4));
+  }
+  return false;
+}
+
+GlyphAtlas::GlyphAtlas(uint32_t s) :
+  size(s)
+{
+}
+
+bool GlyphAtlas::isSupported(char letter)
+{
+  return string("CDHKNORSVZ").find(letter) != string::npos;
+}
+
+const uint8_t* GlyphAtlas::getGlyph(char letter)
+{
+  if (!isSupported(letter))
+  {
+    return nullptr;
+  }
+  auto it = glyphs.find(letter);
+  if (it != glyphs.end())
+  {
+    return it->second.data();
+  }
+
+  // Count the samples of each pixel that fall inside the letter
+  vector<uint8_t> mask((size_t)size * size);
+  double scale = GRID / (size * SUPERSAMPLING);
+  for (uint32_t y = 0; y < size; ++y)
+  {
+    for (uint32_t x = 0; x < size; ++x)
+    {
+      uint32_t count = 0;
+      for (uint32_t sy = 0; sy < SUPERSAMPLING; ++sy)
+      {
+        double v = (y * SUPERSAMPLING + sy + 0.5) * scale;
+        for (uint32_t sx = 0; sx < SUPERSAMPLING; ++sx)
+        {
+          double u = (x * SUPERSAMPLING + sx + 0.5) * scale;
+          count += covers(letter, u, v) ? 1 : 0;
+        }
+      }
+      mask[(size_t)y * size + x] = (uint8_t)((count * 255 + SUPERSAMPLING *
+        SUPERSAMPLING / 2) / (SUPERSAMPLING * SUPERSAMPLING));
+    }
+  }
+  glyphs[letter] = mask;
+  return glyphs[letter].data();
+}
+
+uint32_t GlyphAtlas::getSize()
+{
+  return size;
+}
+
+bool GlyphAtlas::composite(char letter, int32_t left, int32_t top, uint32_t pixel,
+  uint8_t* frame, uint32_t width, uint32_t height)
+{
+  const uint8_t* glyph = getGlyph(letter);
+  if (glyph == nullptr)
+  {
+    return false;
+  }
+
+  // Clip the glyph to the frame
+  int32_t x0 = max(left, 0), x1 = min(left + (int32_t)size, (int32_t)width);
+  int32_t y0 = max(top, 0), y1 = min(top + (int32_t)size, (int32_t)height);
+  uint8_t color[4] = { (uint8_t)pixel, (uint8_t)(pixel >> 8), (uint8_t)(pixel >> 16),
+    255 };
+
+  // Blend each channel as (color * alpha + background * (255 - alpha)) / 255 with
+  // rounding. The inner loop is branch-free so the compiler can vectorize it
+  for (int32_t y = y0; y < y1; ++y)
+  {
+    const uint8_t* alpha = glyph + (size_t)(y - top) * size + (x0 - left);
+    uint8_t* dest = frame + ((size_t)y * width + x0) * 4;
+    int32_t count = x1 - x0;
+    for (int32_t i = 0; i < count * 4; ++i)
+    {
+      uint32_t a = alpha[i >> 2];
+      uint32_t value = color[i & 3] * a + dest[i] * (255 - a) + 128;
+      dest[i] = (uint8_t)((value + (value >> 8)) >> 8);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// The GlyphAtlas class rasterizes the ten Sloan letters used by the acuity programs (C,
+// D, H, K, N, O, R, S, V, and Z) into antialiased alpha masks of a given size. Sloan
+// optotypes are defined on a 5 x 5 grid with a stroke one grid unit wide, so they are
+// drawn here from that geometry rather than from a font, which makes the result the same
+// on every machine. Each glyph is as wide and as tall as the size in pixels, matching a
+// "<size>px Sloan" canvas font, and is rasterized once with 4 x 4 supersampling.
+//
+// The composite() function blends a glyph into a BGRA frame. Stimuli that show letters
+// build their frame once from the atlas so the cost per frame is a copy.
+class GlyphAtlas
+{
+public:
+  GlyphAtlas(uint32_t size);
+  virtual ~GlyphAtlas() {};
+
+  static bool isSupported(char letter);
+
+  // Returns the alpha mask of the given letter, rasterizing it on first use, or null if
+  // the letter isn't supported. The mask is size x size bytes
+  const uint8_t* getGlyph(char letter);
+
+  uint32_t getSize();
+
+  // Blends the letter into the frame with its top left corner at the given position in
+  // the given color, clipping it to the frame. Returns false if the letter isn't
+  // supported
+  bool composite(char letter, int32_t left, int32_t top, uint32_t pixel, uint8_t* frame,
+    uint32_t width, uint32_t height);
+
+private:
+  uint32_t size;
+  std::map<char, std::vector<uint8_t>> glyphs;
+};
@@ -0,0 +1,181 @@
+#include "GratingGenerator.h"
+#include "Color.h"
+#include <cmath>
+#include <cstring>
+#include <opencv2/core/core.hpp>
+
+using namespace std;
+using namespace cv;
+
+// Positions along the pattern are tracked in 32.32 fixed point
+#define FIXED_ONE 4294967296.0
+#define FIXED_ONE_INT ((int64_t)1 << 32)
+#define FIXED_SHIFT 32
+
+// Number of pixels rendered between reductions of the index into the pattern, which is
+// also how far the padding extends on either side of it
+#define CHUNK_PIXELS 256
+
+static const double PI = 3.14159265358979323846;
+
+GratingGenerator::GratingGenerator(uint32_t count, uint32_t f, bool sine, double s,
+    double w, double a, string bar, string background) :
+  FrameGenerator(sine ? "sinusoidalgrating" : "grating", count),
+  fps(f),
+  sinusoidal(sine),
+  speed(s),
+  barWidth(w),
+  angle(a),
+  barColor(bar),
+  backgroundColor(background)
+{
+}
+
+bool GratingGenerator::open(uint32_t wid, uint32_t hgt, string& error)
+{
+  uint8_t barRed, barGreen, barBlue, backRed, backGreen, backBlue;
+  if (!color::parse(barColor, barRed, barGreen, barBlue))
+  {
+    error = "Unknown color " + barColor;
+    return false;
+  }
+  if (!color::parse(backgroundColor, backRed, backGreen, backBlue))
+  {
+    error = "Unknown color " + backgroundColor;
+    return false;
+  }
+  if ((fps == 0) || !(barWidth >= 1.0))
+  {
+    error = "Invalid grating parameters";
+    return false;
+  }
+  width = wid;
+  height = hgt;
+  diagonal = sqrt((double)width * width + (double)height * height);
+  cosAngle = cos(angle);
+  sinAngle = sin(angle);
+  backgroundPixel = color::toPixel(backRed, backGreen, backBlue);
+
+  // Compute one period of the pattern the way the renderers fill their pattern canvas,
+  // which is two bar widths wide in whole pixels
+  uint32_t length = (uint32_t)(barWidth * 2);
+  profile.resize(length);
+  for (uint32_t x = 0; x < length; ++x)
+  {
+    if (sinusoidal)
+    {
+      double scale = sin(x / barWidth * PI);
+      double red = (barRed - backRed) / 2.0, green = (barGreen - backGreen) / 2.0,
+        blue = (barBlue - backBlue) / 2.0;
+      profile[x] = color::toPixel((uint8_t)floor(red * scale + backRed + red + 0.5),
+        (uint8_t)floor(green * scale + backGreen + green + 0.5),
+        (uint8_t)floor(blue * scale + backBlue + blue + 0.5));
+    }
+    else
+    {
+      profile[x] = (x + 0.5 < barWidth) ? color::toPixel(barRed, barGreen, barBlue) :
+        backgroundPixel;
+    }
+  }
+
+  // Repeat the period for a chunk's worth of pixels on either side
+  paddedProfile.resize(length + 2 * CHUNK_PIXELS);
+  uint32_t offset = CHUNK_PIXELS % length;
+  for (uint32_t x = 0; x < paddedProfile.size(); ++x)
+  {
+    paddedProfile[x] = profile[(x + length - offset) % length];
+  }
+  return true;
+}
+
+void GratingGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  // The renderers translate the pattern by two bar widths less the distance travelled
+  double timeDelta = frameNumber * (1.0 / fps);
+  double position = fmod(speed * timeDelta, 2 * barWidth);
+  double shift = 2 * barWidth - position;
+
+  // Rows are identical when the bars are vertical, in which case the first row of each
+  // band is rendered and copied
+  bool identicalRows = (fabs(sinAngle) * height < 1e-6);
+  parallel_for_(Range(0, (int)height), [&](const Range& range)
+  {
+    for (int y = range.start; y < range.end; ++y)
+    {
+      uint32_t* row = (uint32_t*)(dest + (size_t)y * width * 4);
+      if (identicalRows && (y > range.start))
+      {
+        memcpy(row, row - width, (size_t)width * 4);
+        continue;
+      }
+
+      // Map the center of the first pixel in the row into pattern space by undoing the
+      // rotation about the center of the frame
+      double dx = 0.5 - width / 2.0;
+      double dy = y + 0.5 - height / 2.0;
+      renderRow(row, dx * cosAngle - dy * sinAngle + diagonal / 2, shift);
+    }
+  });
+}
+
+void GratingGenerator::renderRow(uint32_t* row, double start, double shift)
+{
+  // The renderers only fill the pattern between two bar widths before the origin and
+  // the diagonal after it, so pixels outside that span keep the background color
+  double first = start - shift;
+  double step = cosAngle;
+  double lower = -2 * barWidth, upper = diagonal;
+  uint32_t xStart = 0, xEnd = width;
+  if (step == 0.0)
+  {
+    if ((first < lower) || (first >= upper))
+    {
+      xEnd = 0;
+    }
+  }
+  else
+  {
+    double a = (lower - first) / step, b = (upper - first) / step;
+    double low = max(0.0, ceil(min(a, b))), high = min((double)width, ceil(max(a, b)));
+    xStart = (uint32_t)min(low, (double)width);
+    xEnd = (uint32_t)max(high, (double)xStart);
+  }
+  color::fillPixels((uint8_t*)row, backgroundPixel, xStart);
+  color::fillPixels((uint8_t*)(row + xEnd), backgroundPixel, width - xEnd);
+
+  // Walk the profile in fixed point a chunk at a time. The step is at most one pixel so
+  // within a chunk the index moves by less than the padding, and each pixel is a plain
+  // lookup relative to the start of the chunk
+  int64_t length = (int64_t)profile.size();
+  double position = first + xStart * step;
+  double whole = floor(position);
+  int64_t index = (int64_t)fmod(whole, (double)length);
+  if (index < 0)
+  {
+    index += length;
+  }
+  int64_t fraction = (int64_t)((position - whole) * FIXED_ONE);
+  int64_t fixedStep = (int64_t)llround(step * FIXED_ONE);
+  const uint32_t* pattern = paddedProfile.data() + CHUNK_PIXELS;
+  for (uint32_t x = xStart; x < xEnd; x += CHUNK_PIXELS)
+  {
+    uint32_t count = min((uint32_t)CHUNK_PIXELS, xEnd - x);
+    const uint32_t* chunk = pattern + index;
+    uint32_t* output = row + x;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      output[i] = chunk[(fraction + (int64_t)i * fixedStep) >> FIXED_SHIFT];
+    }
+
+    // Carry the position over to the next chunk and bring the index back into the
+    // period
+    int64_t end = fraction + (int64_t)count * fixedStep;
+    index += end >> FIXED_SHIFT;
+    fraction = end & (FIXED_ONE_INT - 1);
+    index %= length;
+    if (index < 0)
+    {
+      index += length;
+    }
+  }
+}
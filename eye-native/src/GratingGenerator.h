@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The GratingGenerator class renders the Grating and SinusoidalGrating stimuli. Both
+// tile the plane with a pattern that is two bar widths long, rotated by the angle
+// around the center of the frame and moving at the given speed in pixels per second.
+// The square pattern is one bar width of the bar color followed by one of the background
+// color. The sinusoidal pattern ramps from the background color to the bar color and
+// back along a sine. This matches GratingRenderer and SinusoidalGratingRenderer in the
+// stimulus window.
+//
+// One period of the pattern is computed once as a row of pixels. Each output row then
+// walks that profile in fixed point along the rotated axis, so a frame costs one table
+// lookup per pixel, and the rows are split into bands that are rendered in parallel.
+// The profile is padded with a chunk's worth of wrapped pixels on either side so each
+// chunk of a row is a branch-free lookup that never has to wrap the index.
+class GratingGenerator : public FrameGenerator
+{
+public:
+  GratingGenerator(uint32_t frameCount, uint32_t fps, bool sinusoidal, double speed,
+    double barWidth, double angle, std::string barColor, std::string backgroundColor);
+  virtual ~GratingGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+
+private:
+  void renderRow(uint32_t* row, double start, double shift);
+
+private:
+  uint32_t fps;
+  bool sinusoidal;
+  double speed;
+  double barWidth;
+  double angle;
+  std::string barColor;
+  std::string backgroundColor;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  double diagonal = 0.0;
+  double cosAngle = 0.0;
+  double sinAngle = 0.0;
+  uint32_t backgroundPixel = 0;
+
+  // One period of the pattern with the padding on either side
+  std::vector<uint32_t> profile;
+  std::vector<uint32_t> paddedProfile;
+};
@@ -0,0 +1,278 @@
+#include "ImageCache.h"
+#include "Color.h"
+#include "ImageDecodeThread.h"
+#include "Platform.h"
+#include <cmath>
+#include <sstream>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+
+ImageCache::ImageCache(uint64_t bytes, uint32_t workerCount) :
+  maxBytes(bytes)
+{
+  for (uint32_t i = 0; i < max(workerCount, 1u); ++i)
+  {
+    shared_ptr<ImageDecodeThread> worker(new ImageDecodeThread(this));
+    worker->spawn();
+    workers.push_back(worker);
+  }
+}
+
+ImageCache::~ImageCache()
+{
+  // Let the images being decoded finish before the cache goes away
+  for (auto it = workers.begin(); it != workers.end(); ++it)
+  {
+    if ((*it)->isRunning())
+    {
+      (*it)->terminate(5000);
+    }
+  }
+}
+
+bool ImageCache::prefetch(ImageRequest request, uint32_t width, uint32_t height,
+  string& error)
+{
+  string key;
+  if (!makeKey(request, width, height, key, error))
+  {
+    return false;
+  }
+  findOrQueue(key, request, width, height);
+  return true;
+}
+
+shared_ptr<const vector<uint8_t>> ImageCache::get(ImageRequest request, uint32_t width,
+  uint32_t height, string& error)
+{
+  string key;
+  if (!makeKey(request, width, height, key, error))
+  {
+    return nullptr;
+  }
+  shared_ptr<Entry> entry = findOrQueue(key, request, width, height);
+
+  // Wait for the image to be decoded and count whether it was ready in time
+  unique_lock<mutex> lock(cacheMutex);
+  if (entry->complete)
+  {
+    hits += 1;
+  }
+  else
+  {
+    misses += 1;
+    completeEvent.wait(lock, [&entry] { return entry->complete; });
+  }
+  if (entry->frame == nullptr)
+  {
+    // Forget failures so the image is tried again next time
+    error = entry->error;
+    auto it = entries.find(key);
+    if ((it != entries.end()) && (it->second == entry))
+    {
+      recentlyUsed.erase(entry->position);
+      entries.erase(it);
+    }
+    return nullptr;
+  }
+  return entry->frame;
+}
+
+void ImageCache::getStatistics(uint32_t& hitCount, uint32_t& missCount,
+  uint32_t& entryCount, uint64_t& bytes)
+{
+  unique_lock<mutex> lock(cacheMutex);
+  hitCount = hits;
+  missCount = misses;
+  entryCount = (uint32_t)entries.size();
+  bytes = totalBytes;
+}
+
+bool ImageCache::decodeNext(uint32_t timeout)
+{
+  shared_ptr<Entry> entry;
+  if (!decodeQueue.waitItem(&entry, timeout))
+  {
+    return false;
+  }
+
+  // Decode outside the lock so the workers run in parallel
+  shared_ptr<vector<uint8_t>> frame(new vector<uint8_t>());
+  string error;
+  bool success = decode(entry->request, entry->width, entry->height, *frame, error);
+  {
+    unique_lock<mutex> lock(cacheMutex);
+    entry->complete = true;
+    if (success)
+    {
+      entry->frame = frame;
+      auto it = entries.find(entry->key);
+      if ((it != entries.end()) && (it->second == entry))
+      {
+        totalBytes += frame->size();
+        evict();
+      }
+    }
+    else
+    {
+      entry->error = error;
+    }
+  }
+  completeEvent.notify_all();
+  return true;
+}
+
+bool ImageCache::makeKey(ImageRequest request, uint32_t width, uint32_t height,
+  string& key, string& error)
+{
+  uint64_t size, modifiedTimeUsec;
+  if (!platform::getFileInfo(request.path, size, modifiedTimeUsec))
+  {
+    error = "Failed to find image " + request.path;
+    return false;
+  }
+  stringstream stream;
+  stream.precision(17);
+  stream << request.path << "|" << size << "|" << modifiedTimeUsec << "|" << width <<
+    "x" << height << "|" << request.fixationX << "," << request.fixationY << "|" <<
+    request.scaleX << "," << request.scaleY << "|" << request.backgroundColor;
+  key = stream.str();
+  return true;
+}
+
+shared_ptr<ImageCache::Entry> ImageCache::findOrQueue(string key, ImageRequest request,
+  uint32_t width, uint32_t height)
+{
+  unique_lock<mutex> lock(cacheMutex);
+
+  // Move an existing entry to the front of the list
+  auto it = entries.find(key);
+  if (it != entries.end())
+  {
+    recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->second->position);
+    return it->second;
+  }
+
+  // Otherwise add a new entry and queue it for decoding
+  shared_ptr<Entry> entry(new Entry());
+  entry->key = key;
+  entry->request = request;
+  entry->width = width;
+  entry->height = height;
+  recentlyUsed.push_front(key);
+  entry->position = recentlyUsed.begin();
+  entries[key] = entry;
+  decodeQueue.addItem(entry);
+  return entry;
+}
+
+void ImageCache::evict()
+{
+  // Drop the least recently used frames until the cache fits, skipping entries that are
+  // still being decoded. The most recently used frame is always kept
+  auto it = recentlyUsed.end();
+  while ((totalBytes > maxBytes) && (it != recentlyUsed.begin()))
+  {
+    --it;
+    if (it == recentlyUsed.begin())
+    {
+      break;
+    }
+    shared_ptr<Entry> entry = entries[*it];
+    if (!entry->complete || (entry->frame == nullptr))
+    {
+      continue;
+    }
+    totalBytes -= entry->frame->size();
+    entries.erase(*it);
+    it = recentlyUsed.erase(it);
+  }
+}
+
+bool ImageCache::decode(ImageRequest request, uint32_t width, uint32_t height,
+  vector<uint8_t>& frame, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(request.backgroundColor, red, green, blue))
+  {
+    error = "Unknown color " + request.backgroundColor;
+    return false;
+  }
+  uint32_t backgroundPixel = color::toPixel(red, green, blue);
+
+  // Decode the image and convert it to 8-bit BGRA
+  Mat image = imread(request.path, IMREAD_UNCHANGED);
+  if (image.empty())
+  {
+    error = "Failed to decode " + request.path;
+    return false;
+  }
+  if (image.depth() == CV_16U)
+  {
+    image.convertTo(image, CV_8U, 1.0 / 256.0);
+  }
+  else if (image.depth() != CV_8U)
+  {
+    error = "Unsupported pixel format in " + request.path;
+    return false;
+  }
+  bool hasAlpha = (image.channels() == 4);
+  if (image.channels() == 1)
+  {
+    cvtColor(image, image, COLOR_GRAY2BGRA);
+  }
+  else if (image.channels() == 3)
+  {
+    cvtColor(image, image, COLOR_BGR2BGRA);
+  }
+
+  // Fill the background and work out where the scaled image lands
+  frame.resize((size_t)width * height * 4);
+  color::fillPixels(frame.data(), backgroundPixel, (size_t)width * height);
+  Mat output(height, width, CV_8UC4, frame.data());
+  int scaledWidth = (int)floor(image.cols * fabs(request.scaleX) + 0.5);
+  int scaledHeight = (int)floor(image.rows * fabs(request.scaleY) + 0.5);
+  int left = (int)floor(width / 2.0 - request.fixationX + 0.5);
+  int top = (int)floor(height / 2.0 - request.fixationY + 0.5);
+  Rect placed(left, top, scaledWidth, scaledHeight);
+  Rect visible = placed & Rect(0, 0, width, height);
+  if (visible.empty())
+  {
+    return true;
+  }
+
+  // Scale once with area averaging when shrinking and bilinear interpolation when
+  // enlarging, then crop to the part that's on screen
+  Mat scaled;
+  bool shrinking = (scaledWidth < image.cols) && (scaledHeight < image.rows);
+  resize(image, scaled, Size(scaledWidth, scaledHeight), 0, 0,
+    shrinking ? INTER_AREA : INTER_LINEAR);
+  Mat source = scaled(Rect(visible.x - left, visible.y - top, visible.width,
+    visible.height));
+  Mat dest = output(visible);
+  if (!hasAlpha)
+  {
+    source.copyTo(dest);
+    return true;
+  }
+
+  // Blend transparent images over the background like the canvas does
+  for (int y = 0; y < source.rows; ++y)
+  {
+    const uint8_t* src = source.ptr<uint8_t>(y);
+    uint8_t* dst = dest.ptr<uint8_t>(y);
+    for (int x = 0; x < source.cols; ++x, src += 4, dst += 4)
+    {
+      uint32_t alpha = src[3];
+      for (int c = 0; c < 3; ++c)
+      {
+        uint32_t value = src[c] * alpha + dst[c] * (255 - alpha) + 128;
+        dst[c] = (uint8_t)((value + (value >> 8)) >> 8);
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Queue.hpp"
+
+class ImageDecodeThread;
+
+// The ImageRequest structure describes how an Image stimulus places its picture in the
+// frame. The fixation point of the image is drawn at the center of the frame and the
+// image is scaled independently in each direction, matching ImageRenderer in the
+// stimulus window
+struct ImageRequest
+{
+  std::string path;
+  double fixationX = 0;
+  double fixationY = 0;
+  double scaleX = 1;
+  double scaleY = 1;
+  std::string backgroundColor;
+};
+
+// The ImageCache class decodes images with OpenCV on a pool of worker threads, scales
+// and places them on the background once, and keeps the finished BGRA frames in memory
+// so an image shown many times is only decoded once. Entries are keyed by the image
+// path, its size and modification time, the frame dimensions, and the placement, so an
+// image that changes on disk is decoded again.
+//
+// The cache is bounded by the total size of the finished frames and evicts the least
+// recently used ones first. Frames are handed out as shared pointers so an evicted frame
+// stays valid for as long as a stimulus is still using it. Callers prefetch the images
+// of upcoming stimuli so they're ready by the time they're shown.
+class ImageCache
+{
+public:
+  ImageCache(uint64_t maxBytes, uint32_t workerCount);
+  virtual ~ImageCache();
+
+  // Queues the image to be decoded in the background if it isn't cached already.
+  // Returns false if the image can't be found
+  bool prefetch(ImageRequest request, uint32_t width, uint32_t height,
+    std::string& error);
+
+  // Returns the frame for the image, waiting for it to be decoded if needed, or null
+  // if it can't be decoded
+  std::shared_ptr<const std::vector<uint8_t>> get(ImageRequest request, uint32_t width,
+    uint32_t height, std::string& error);
+
+  void getStatistics(uint32_t& hits, uint32_t& misses, uint32_t& entries,
+    uint64_t& bytes);
+
+  // Called by the worker threads to decode the next queued image, if any
+  bool decodeNext(uint32_t timeout);
+
+private:
+  struct Entry
+  {
+    std::string key;
+    ImageRequest request;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool complete = false;
+    std::shared_ptr<const std::vector<uint8_t>> frame;
+    std::string error;
+    std::list<std::string>::iterator position;
+  };
+
+  bool makeKey(ImageRequest request, uint32_t width, uint32_t height, std::string& key,
+    std::string& error);
+  std::shared_ptr<Entry> findOrQueue(std::string key, ImageRequest request,
+    uint32_t width, uint32_t height);
+  void evict();
+  static bool decode(ImageRequest request, uint32_t width, uint32_t height,
+    std::vector<uint8_t>& frame, std::string& error);
+
+private:
+  uint64_t maxBytes;
+  uint64_t totalBytes = 0;
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+  std::mutex cacheMutex;
+  std::condition_variable completeEvent;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+  std::list<std::string> recentlyUsed;
+  Queue<std::shared_ptr<Entry>> decodeQueue;
+  std::vector<std::shared_ptr<ImageDecodeThread>> workers;
+};
@@ -0,0 +1,19 @@
+#include "ImageDecodeThread.h"
+#include "ImageCache.h"
+
+using namespace std;
+
+ImageDecodeThread::ImageDecodeThread(ImageCache* cache) :
+  Thread("imagedecode"),
+  imageCache(cache)
+{
+}
+
+uint32_t ImageDecodeThread::run()
+{
+  while (!checkForExit())
+  {
+    imageCache->decodeNext(10);
+  }
+  return 0;
+}
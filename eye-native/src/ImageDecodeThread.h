@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Thread.h"
+
+class ImageCache;
+
+// The ImageDecodeThread class is one of the workers of an ImageCache. It decodes queued
+// images until it's terminated
+class ImageDecodeThread : public Thread
+{
+public:
+  ImageDecodeThread(ImageCache* cache);
+  virtual ~ImageDecodeThread() {};
+
+  uint32_t run() override;
+
+private:
+  ImageCache* imageCache;
+};
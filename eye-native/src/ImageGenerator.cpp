@@ -0,0 +1,28 @@
+#include "ImageGenerator.h"
+#include <cstring>
+
+using namespace std;
+
+ImageGenerator::ImageGenerator(uint32_t count, shared_ptr<ImageCache> cache,
+    ImageRequest req) :
+  FrameGenerator("image", count),
+  imageCache(cache),
+  request(req)
+{
+}
+
+bool ImageGenerator::open(uint32_t width, uint32_t height, string& error)
+{
+  frame = imageCache->get(request, width, height, error);
+  return (frame != nullptr);
+}
+
+void ImageGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  memcpy(dest, frame->data(), frame->size());
+}
+
+bool ImageGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (frameNumber > 0);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "FrameGenerator.h"
+#include "ImageCache.h"
+
+// The ImageGenerator class renders the Image stimulus from an ImageCache. The frame is
+// taken from the cache when the generator is opened, waiting for it to be decoded if it
+// wasn't prefetched, and every frame after the first is marked as a repeat.
+class ImageGenerator : public FrameGenerator
+{
+public:
+  ImageGenerator(uint32_t frameCount, std::shared_ptr<ImageCache> imageCache,
+    ImageRequest request);
+  virtual ~ImageGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  std::shared_ptr<ImageCache> imageCache;
+  ImageRequest request;
+  std::shared_ptr<const std::vector<uint8_t>> frame;
+};
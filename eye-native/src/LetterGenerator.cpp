@@ -0,0 +1,60 @@
+#include "LetterGenerator.h"
+#include "Color.h"
+#include "GlyphAtlas.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+LetterGenerator::LetterGenerator(uint32_t count, string l, double left, double baseline,
+    double s, string col, string background) :
+  FrameGenerator("letter", count),
+  letter(l),
+  x(left),
+  y(baseline),
+  size(s),
+  color(col),
+  backgroundColor(background)
+{
+}
+
+bool LetterGenerator::open(uint32_t width, uint32_t height, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(color, red, green, blue))
+  {
+    error = "Unknown color " + color;
+    return false;
+  }
+  uint32_t pixel = color::toPixel(red, green, blue);
+  if (!color::parse(backgroundColor, red, green, blue))
+  {
+    error = "Unknown color " + backgroundColor;
+    return false;
+  }
+  uint32_t backgroundPixel = color::toPixel(red, green, blue);
+  if ((letter.size() != 1) || !GlyphAtlas::isSupported(letter[0]) || !(size >= 1.0))
+  {
+    error = "Unsupported letter " + letter;
+    return false;
+  }
+
+  // Fill the background and blend in the letter, which sits on the baseline
+  frame.resize((size_t)width * height * 4);
+  color::fillPixels(frame.data(), backgroundPixel, (size_t)width * height);
+  GlyphAtlas atlas((uint32_t)floor(size + 0.5));
+  atlas.composite(letter[0], (int32_t)floor(x + 0.5),
+    (int32_t)floor(y + 0.5) - (int32_t)atlas.getSize(), pixel, frame.data(), width,
+    height);
+  return true;
+}
+
+void LetterGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  memcpy(dest, frame.data(), frame.size());
+}
+
+bool LetterGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (frameNumber > 0);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The LetterGenerator class renders the Letter stimulus, a single Sloan letter of the
+// given size whose left edge is at x and whose baseline is at y. This matches
+// LetterRenderer in the stimulus window. The frame is composed once from a GlyphAtlas
+// when the generator is opened and every frame after the first is marked as a repeat.
+class LetterGenerator : public FrameGenerator
+{
+public:
+  LetterGenerator(uint32_t frameCount, std::string letter, double x, double y,
+    double size, std::string color, std::string backgroundColor);
+  virtual ~LetterGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  std::string letter;
+  double x;
+  double y;
+  double size;
+  std::string color;
+  std::string backgroundColor;
+  std::vector<uint8_t> frame;
+};
@@ -0,0 +1,172 @@
+#include "LuminanceTraceWriter.h"
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+
+// Magic number and version used to identify binary traces
+#define MAGIC_NUMBER 0x4C455945
+#define VERSION 1
+
+// Number of statistics recorded for each cell
+#define STATS_PER_CELL 4
+
+LuminanceTraceWriter::LuminanceTraceWriter(string path, bool bin, uint32_t rows,
+    uint32_t columns) :
+  RecordStage("luminance"),
+  tracePath(path),
+  binary(bin),
+  gridRows(rows),
+  gridColumns(columns)
+{
+}
+
+string LuminanceTraceWriter::getTracePath(string videoPath, bool binary)
+{
+  // Replace the extension of the video file, if any
+  string extension = binary ? ".luminance" : ".luminance.csv";
+  size_t dotPos = videoPath.find_last_of('.');
+  size_t slashPos = videoPath.find_last_of("/\\");
+  if ((dotPos != string::npos) && ((slashPos == string::npos) || (dotPos > slashPos)))
+  {
+    return videoPath.substr(0, dotPos) + extension;
+  }
+  return videoPath + extension;
+}
+
+bool LuminanceTraceWriter::open(uint32_t wid, uint32_t hgt, uint32_t fps, string& error)
+{
+  width = wid;
+  height = hgt;
+  measured = false;
+  if ((gridRows > height) || (gridColumns > width))
+  {
+    error = "Luminance grid is finer than the frame";
+    return false;
+  }
+  file.open(tracePath, binary ? (ios::out | ios::binary | ios::trunc) :
+    (ios::out | ios::trunc));
+  if (!file.is_open())
+  {
+    error = "Failed to create " + tracePath;
+    return false;
+  }
+
+  // Lay out the cells with the whole frame first
+  cells.clear();
+  cells.push_back(Rect(0, 0, width, height));
+  if ((gridRows > 0) && (gridColumns > 0))
+  {
+    for (uint32_t row = 0; row < gridRows; ++row)
+    {
+      for (uint32_t column = 0; column < gridColumns; ++column)
+      {
+        int x0 = (int)(column * width / gridColumns);
+        int x1 = (int)((column + 1) * width / gridColumns);
+        int y0 = (int)(row * height / gridRows);
+        int y1 = (int)((row + 1) * height / gridRows);
+        cells.push_back(Rect(x0, y0, x1 - x0, y1 - y0));
+      }
+    }
+  }
+  record.resize(cells.size() * STATS_PER_CELL);
+
+  // Write the header
+  if (binary)
+  {
+    uint32_t header[LUMINANCE_TRACE_HEADER_SIZE / sizeof(uint32_t)] = { MAGIC_NUMBER,
+      VERSION, width, height, fps, gridRows, gridColumns, 0 };
+    file.write((const char*)header, LUMINANCE_TRACE_HEADER_SIZE);
+  }
+  else
+  {
+    file << "frame,cell,mean,contrast,min,max\n";
+  }
+  if (!file.good())
+  {
+    error = "Failed to write " + tracePath;
+    return false;
+  }
+  return true;
+}
+
+bool LuminanceTraceWriter::processFrame(shared_ptr<FrameWrapper> wrapper,
+  const uint8_t* data, size_t length, string& error)
+{
+  if (length != ((size_t)width * height * 4))
+  {
+    error = "Unexpected frame length";
+    return false;
+  }
+
+  // Convert the frame to luminance once and reduce each cell. A repeated frame has the
+  // same statistics as the last one
+  if (!wrapper->repeatFrame || !measured)
+  {
+    Mat frame(height, width, CV_8UC4, (void*)data);
+    cvtColor(frame, grayFrame, COLOR_BGRA2GRAY);
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+      measureCell(cells[i], &record[i * STATS_PER_CELL]);
+    }
+    measured = true;
+  }
+
+  // Append the record to the trace
+  if (binary)
+  {
+    file.write((const char*)&wrapper->recordIndex, sizeof(uint32_t));
+    file.write((const char*)record.data(), record.size() * sizeof(float));
+  }
+  else
+  {
+    stringstream lines;
+    lines << setprecision(6);
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+      const float* stats = &record[i * STATS_PER_CELL];
+      lines << wrapper->recordIndex << "," << i << "," << stats[0] << "," << stats[1] <<
+        "," << stats[2] << "," << stats[3] << "\n";
+    }
+    file << lines.str();
+  }
+  if (!file.good())
+  {
+    error = "Failed to write " + tracePath;
+    return false;
+  }
+  return true;
+}
+
+bool LuminanceTraceWriter::close(string& error)
+{
+  if (!file.is_open())
+  {
+    return true;
+  }
+  file.close();
+  if (file.fail())
+  {
+    error = "Failed to close " + tracePath;
+    return false;
+  }
+  return true;
+}
+
+void LuminanceTraceWriter::measureCell(Rect cell, float* stats)
+{
+  // OpenCV's reductions are vectorized so two passes over the cell are still cheap
+  // compared to encoding the frame
+  Mat region = grayFrame(cell);
+  Scalar mean, stdDev;
+  double minValue, maxValue;
+  meanStdDev(region, mean, stdDev);
+  minMaxLoc(region, &minValue, &maxValue);
+  stats[0] = (float)(mean[0] / 255.0);
+  stats[1] = (float)(stdDev[0] / 255.0);
+  stats[2] = (float)(minValue / 255.0);
+  stats[3] = (float)(maxValue / 255.0);
+}
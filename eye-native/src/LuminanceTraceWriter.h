@@ -0,0 +1,64 @@
+#pragma once
+
+#include <fstream>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "RecordStage.h"
+
+// The LuminanceTraceWriter class is a record stage that computes the mean luminance,
+// RMS contrast, minimum, and maximum of every frame, optionally for each cell of a grid
+// as well, and streams them to a trace file next to the video. Luminance is the Rec. 601
+// weighted gray level and all statistics are normalized to the range 0 to 1, with RMS
+// contrast defined as the standard deviation of the normalized luminance.
+//
+// Cell 0 always covers the whole frame and cells 1 through rows * columns follow in
+// row-major order. The CSV format has one line per frame and cell with the columns
+// "frame,cell,mean,contrast,min,max", where the frame is its index in the video counting
+// from zero. The binary format is laid out as follows:
+//
+// - Header (32 bytes):
+//   - Magic number (uint32_t)
+//   - Version (uint32_t)
+//   - Width (uint32_t)
+//   - Height (uint32_t)
+//   - Frame rate (uint32_t)
+//   - Grid rows (uint32_t)
+//   - Grid columns (uint32_t)
+//   - Reserved (uint32_t)
+// - Records, one per frame:
+//   - Index of the frame in the video (uint32_t)
+//   - Mean, contrast, min, and max (4 floats) for each cell
+
+// The number of bytes in the header of a binary trace
+#define LUMINANCE_TRACE_HEADER_SIZE 32
+
+class LuminanceTraceWriter : public RecordStage
+{
+public:
+  LuminanceTraceWriter(std::string tracePath, bool binary, uint32_t gridRows,
+    uint32_t gridColumns);
+  virtual ~LuminanceTraceWriter() {};
+
+  static std::string getTracePath(std::string videoPath, bool binary);
+
+  bool open(uint32_t width, uint32_t height, uint32_t fps, std::string& error) override;
+  bool processFrame(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length, std::string& error) override;
+  bool close(std::string& error) override;
+
+private:
+  void measureCell(cv::Rect cell, float* stats);
+
+private:
+  std::string tracePath;
+  bool binary;
+  uint32_t gridRows;
+  uint32_t gridColumns;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::ofstream file;
+  cv::Mat grayFrame;
+  std::vector<cv::Rect> cells;
+  std::vector<float> record;
+  bool measured = false;
+};
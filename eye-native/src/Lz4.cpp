@@ -0,0 +1,258 @@
+#include "Lz4.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Constants from the LZ4 block format specification. Every match is at least four
+// bytes long, the last five bytes of a block are always literals, and the last match
+// must start at least twelve bytes before the end of the block
+#define MIN_MATCH 4
+#define LAST_LITERALS 5
+#define MF_LIMIT 12
+#define MAX_OFFSET 65535
+
+// Size of the compressor's hash table in bits
+#define HASH_BITS 16
+
+// Number of failed searches after which the compressor starts skipping ahead faster
+// through incompressible data
+#define SKIP_TRIGGER 6
+
+static inline uint32_t read32(const uint8_t* data)
+{
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static inline uint64_t read64(const uint8_t* data)
+{
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static inline uint32_t hashSequence(uint32_t sequence)
+{
+  return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static uint8_t* writeLength(uint8_t* output, uint32_t length)
+{
+  // Lengths of 15 or more continue in extra bytes after the token
+  length -= 15;
+  while (length >= 255)
+  {
+    *output++ = 255;
+    length -= 255;
+  }
+  *output++ = (uint8_t)length;
+  return output;
+}
+
+uint32_t lz4::compressBound(uint32_t sourceLength)
+{
+  return sourceLength + (sourceLength / 255) + 16;
+}
+
+uint32_t lz4::compress(const uint8_t* source, uint32_t sourceLength, uint8_t* dest,
+  uint32_t destCapacity)
+{
+  const uint8_t* input = source;
+  const uint8_t* inputEnd = source + sourceLength;
+  const uint8_t* anchor = source;
+  uint8_t* output = dest;
+  uint8_t* outputEnd = dest + destCapacity;
+
+  // Blocks that are too short to contain a match are stored as a single literal run
+  if (sourceLength > MF_LIMIT)
+  {
+    // The hash table maps each four-byte sequence to the position where it was last
+    // seen. It is cleared for every block so the output is deterministic
+    thread_local vector<uint32_t> hashTable(1 << HASH_BITS);
+    fill(hashTable.begin(), hashTable.end(), 0);
+    const uint8_t* matchStartLimit = inputEnd - MF_LIMIT;
+    const uint8_t* matchEndLimit = inputEnd - LAST_LITERALS;
+    uint32_t searchCount = 1 << SKIP_TRIGGER;
+    while (input < matchStartLimit)
+    {
+      // Look up the previous occurrence of the next four bytes
+      uint32_t sequence = read32(input);
+      uint32_t hash = hashSequence(sequence);
+      uint32_t position = (uint32_t)(input - source);
+      uint32_t candidate = hashTable[hash];
+      hashTable[hash] = position;
+      if ((candidate >= position) || ((position - candidate) > MAX_OFFSET) ||
+        (read32(source + candidate) != sequence))
+      {
+        input += searchCount++ >> SKIP_TRIGGER;
+        continue;
+      }
+      searchCount = 1 << SKIP_TRIGGER;
+
+      // Extend the match backwards into the pending literals and then forwards as far
+      // as possible, comparing eight bytes at a time where we can
+      const uint8_t* match = source + candidate;
+      while ((input > anchor) && (match > source) && (input[-1] == match[-1]))
+      {
+        input -= 1;
+        match -= 1;
+      }
+      const uint8_t* matchEnd = input + MIN_MATCH;
+      const uint8_t* reference = match + MIN_MATCH;
+      while (((matchEnd + 8) <= matchEndLimit) && (read64(matchEnd) == read64(reference)))
+      {
+        matchEnd += 8;
+        reference += 8;
+      }
+      while ((matchEnd < matchEndLimit) && (*matchEnd == *reference))
+      {
+        matchEnd += 1;
+        reference += 1;
+      }
+
+      // Emit the sequence: token, literal length, literals, offset, and match length
+      uint32_t literalLength = (uint32_t)(input - anchor);
+      uint32_t matchLength = (uint32_t)(matchEnd - input) - MIN_MATCH;
+      if ((output + 1 + (literalLength / 255) + 1 + literalLength + 2 +
+        (matchLength / 255) + 1) > outputEnd)
+      {
+        return 0;
+      }
+      uint8_t* token = output++;
+      *token = (uint8_t)((min(literalLength, 15U) << 4) | min(matchLength, 15U));
+      if (literalLength >= 15)
+      {
+        output = writeLength(output, literalLength);
+      }
+      memcpy(output, anchor, literalLength);
+      output += literalLength;
+      uint32_t offset = (uint32_t)(input - match);
+      *output++ = (uint8_t)(offset & 0xFF);
+      *output++ = (uint8_t)(offset >> 8);
+      if (matchLength >= 15)
+      {
+        output = writeLength(output, matchLength);
+      }
+      input = matchEnd;
+      anchor = input;
+
+      // Remember a position inside the match to improve the odds of finding the next one
+      if (input < matchStartLimit)
+      {
+        hashTable[hashSequence(read32(input - 2))] = (uint32_t)(input - 2 - source);
+      }
+    }
+  }
+
+  // Emit the final literal run
+  uint32_t literalLength = (uint32_t)(inputEnd - anchor);
+  if ((output + 1 + (literalLength / 255) + 1 + literalLength) > outputEnd)
+  {
+    return 0;
+  }
+  uint8_t* token = output++;
+  *token = (uint8_t)(min(literalLength, 15U) << 4);
+  if (literalLength >= 15)
+  {
+    output = writeLength(output, literalLength);
+  }
+  memcpy(output, anchor, literalLength);
+  output += literalLength;
+  return (uint32_t)(output - dest);
+}
+
+bool lz4::decompress(const uint8_t* source, uint32_t sourceLength, uint8_t* dest,
+  uint32_t destLength)
+{
+  const uint8_t* input = source;
+  const uint8_t* inputEnd = source + sourceLength;
+  uint8_t* output = dest;
+  uint8_t* outputEnd = dest + destLength;
+  while (input < inputEnd)
+  {
+    // Read the token and the literal length
+    uint32_t token = *input++;
+    size_t literalLength = token >> 4;
+    if (literalLength == 15)
+    {
+      uint8_t extra;
+      do
+      {
+        if (input >= inputEnd)
+        {
+          return false;
+        }
+        extra = *input++;
+        literalLength += extra;
+      } while (extra == 255);
+    }
+
+    // Copy the literals. The last sequence in the block consists of literals only
+    if ((literalLength > (size_t)(inputEnd - input)) ||
+      (literalLength > (size_t)(outputEnd - output)))
+    {
+      return false;
+    }
+    memcpy(output, input, literalLength);
+    output += literalLength;
+    input += literalLength;
+    if (input == inputEnd)
+    {
+      break;
+    }
+
+    // Read the offset and match length
+    if ((inputEnd - input) < 2)
+    {
+      return false;
+    }
+    size_t offset = (size_t)input[0] | ((size_t)input[1] << 8);
+    input += 2;
+    if ((offset == 0) || (offset > (size_t)(output - dest)))
+    {
+      return false;
+    }
+    size_t matchLength = token & 0x0F;
+    if (matchLength == 15)
+    {
+      uint8_t extra;
+      do
+      {
+        if (input >= inputEnd)
+        {
+          return false;
+        }
+        extra = *input++;
+        matchLength += extra;
+      } while (extra == 255);
+    }
+    matchLength += MIN_MATCH;
+    if (matchLength > (size_t)(outputEnd - output))
+    {
+      return false;
+    }
+
+    // Copy the match. When it overlaps the output the copied region repeats with a
+    // period of the offset, so copy in chunks that double in size each time
+    const uint8_t* match = output - offset;
+    if (offset >= matchLength)
+    {
+      memcpy(output, match, matchLength);
+      output += matchLength;
+    }
+    else
+    {
+      while (matchLength > 0)
+      {
+        size_t chunk = min((size_t)(output - match), matchLength);
+        memcpy(output, match, chunk);
+        output += chunk;
+        matchLength -= chunk;
+      }
+    }
+  }
+  return (output == outputEnd);
+}
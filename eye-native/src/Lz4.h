@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// These functions implement the LZ4 block format (https://github.com/lz4/lz4) which is
+// used to losslessly compress raw frames. Stimulus frames are dominated by large runs
+// of identical pixels so even this simple greedy compressor achieves high ratios while
+// comfortably keeping up with the frame rate. Only single blocks are handled, the LZ4
+// frame format with its checksums and block headers is not supported.
+
+namespace lz4
+{
+  // Returns the largest number of bytes that compressing the given number of bytes
+  // can produce
+  uint32_t compressBound(uint32_t sourceLength);
+
+  // Compresses the source into the destination buffer and returns the number of bytes
+  // written or zero if the destination buffer is too small
+  uint32_t compress(const uint8_t* source, uint32_t sourceLength, uint8_t* dest,
+    uint32_t destCapacity);
+
+  // Decompresses the source into the destination buffer. Returns false if the block is
+  // malformed or does not decompress to exactly the destination length
+  bool decompress(const uint8_t* source, uint32_t sourceLength, uint8_t* dest,
+    uint32_t destLength);
+}
@@ -0,0 +1,529 @@
+#include "MkvReader.h"
+#include "Platform.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// EBML and Matroska element IDs, including their length marker bits
+#define ID_EBML 0x1A45DFA3
+#define ID_DOC_TYPE 0x4282
+#define ID_SEGMENT 0x18538067
+#define ID_SEEK_HEAD 0x114D9B74
+#define ID_SEEK 0x4DBB
+#define ID_SEEK_ID 0x53AB
+#define ID_SEEK_POSITION 0x53AC
+#define ID_INFO 0x1549A966
+#define ID_TIMESTAMP_SCALE 0x2AD7B1
+#define ID_DURATION 0x4489
+#define ID_TRACKS 0x1654AE6B
+#define ID_TRACK_ENTRY 0xAE
+#define ID_TRACK_UID 0x73C5
+#define ID_TRACK_TYPE 0x83
+#define ID_DEFAULT_DURATION 0x23E383
+#define ID_VIDEO 0xE0
+#define ID_PIXEL_WIDTH 0xB0
+#define ID_PIXEL_HEIGHT 0xBA
+#define ID_CLUSTER 0x1F43B675
+#define ID_TAGS 0x1254C367
+#define ID_TAG 0x7373
+#define ID_TARGETS 0x63C0
+#define ID_TAG_TRACK_UID 0x63C5
+#define ID_SIMPLE_TAG 0x67C8
+#define ID_TAG_NAME 0x45A3
+#define ID_TAG_STRING 0x4487
+
+// Track type of video tracks
+#define TRACK_TYPE_VIDEO 1
+
+MkvReader::MkvReader(string p) :
+  path(p)
+{
+}
+
+bool MkvReader::parseInfo(string& error)
+{
+  if (!parseFile(error))
+  {
+    return false;
+  }
+  if (!foundVideoTrack || (width == 0) || (height == 0))
+  {
+    error = "No video track found in " + path;
+    return false;
+  }
+  if (defaultDurationNs == 0)
+  {
+    error = "Video track in " + path + " has no default frame duration";
+    return false;
+  }
+  resolveTags();
+  if (frameCount == 0)
+  {
+    error = "Unable to determine the length of " + path;
+    return false;
+  }
+  return true;
+}
+
+uint32_t MkvReader::getWidth()
+{
+  return width;
+}
+
+uint32_t MkvReader::getHeight()
+{
+  return height;
+}
+
+uint32_t MkvReader::getFps()
+{
+  if (defaultDurationNs == 0)
+  {
+    return 0;
+  }
+  return (uint32_t)round(1000000000.0 / (double)defaultDurationNs);
+}
+
+uint32_t MkvReader::getFrameCount()
+{
+  return frameCount;
+}
+
+uint64_t MkvReader::getDurationUsec()
+{
+  return durationUsec;
+}
+
+bool MkvReader::parseFile(string& error)
+{
+  if (!platform::mapFile(path, false, fileData, fileSize, mapId))
+  {
+    error = "Failed to open " + path;
+    return false;
+  }
+
+  // Make sure the EBML header describes a Matroska or WebM document
+  uint32_t id, headerSize;
+  uint64_t size;
+  bool unknownSize, result = false;
+  if (readElementHeader(0, fileSize, id, size, headerSize, unknownSize) &&
+    (id == ID_EBML) && !unknownSize)
+  {
+    string docType;
+    uint64_t position = headerSize, end = headerSize + size;
+    uint32_t childId, childHeaderSize;
+    uint64_t childSize;
+    while (readElementHeader(position, end, childId, childSize, childHeaderSize,
+      unknownSize) && !unknownSize)
+    {
+      if (childId == ID_DOC_TYPE)
+      {
+        docType = readString(position + childHeaderSize, childSize);
+      }
+      position += childHeaderSize + childSize;
+    }
+
+    // Walk the first segment
+    if ((docType == "matroska") || (docType == "webm"))
+    {
+      position = end;
+      if (readElementHeader(position, fileSize, id, size, headerSize, unknownSize) &&
+        (id == ID_SEGMENT))
+      {
+        uint64_t segmentEnd = unknownSize ? fileSize : (position + headerSize + size);
+        result = parseSegment(position + headerSize, segmentEnd, error);
+      }
+      else
+      {
+        error = "No segment found in " + path;
+      }
+    }
+    else
+    {
+      error = "Unsupported document type in " + path;
+    }
+  }
+  else
+  {
+    error = "Missing EBML header in " + path;
+  }
+  platform::unmapFile(fileData, fileSize, mapId);
+  fileData = nullptr;
+  return result;
+}
+
+bool MkvReader::parseSegment(uint64_t start, uint64_t end, string& error)
+{
+  // Stop at the first cluster since everything we need is normally ahead of the media
+  // data. Tags are the exception and are found through the seek head
+  bool parsedTags = false;
+  uint64_t position = start;
+  while (position < end)
+  {
+    uint32_t id, headerSize;
+    uint64_t size;
+    bool unknownSize;
+    if (!readElementHeader(position, end, id, size, headerSize, unknownSize))
+    {
+      error = "Malformed element header in " + path;
+      return false;
+    }
+    if ((id == ID_CLUSTER) || unknownSize)
+    {
+      break;
+    }
+    uint64_t bodyStart = position + headerSize;
+    uint64_t bodyEnd = bodyStart + size;
+    if (id == ID_SEEK_HEAD)
+    {
+      parseSeekHead(bodyStart, bodyEnd, start);
+    }
+    else if (id == ID_INFO)
+    {
+      parseSegmentInfo(bodyStart, bodyEnd);
+    }
+    else if (id == ID_TRACKS)
+    {
+      parseTracks(bodyStart, bodyEnd);
+    }
+    else if (id == ID_TAGS)
+    {
+      parseTags(bodyStart, bodyEnd);
+      parsedTags = true;
+    }
+    position = bodyEnd;
+  }
+  if (!parsedTags && (tagsPosition > position) && (tagsPosition < end))
+  {
+    uint32_t id, headerSize;
+    uint64_t size;
+    bool unknownSize;
+    if (readElementHeader(tagsPosition, end, id, size, headerSize, unknownSize) &&
+      (id == ID_TAGS) && !unknownSize)
+    {
+      parseTags(tagsPosition + headerSize, tagsPosition + headerSize + size);
+    }
+  }
+  return true;
+}
+
+void MkvReader::parseSeekHead(uint64_t start, uint64_t end, uint64_t segmentStart)
+{
+  uint32_t id, headerSize;
+  uint64_t size;
+  bool unknownSize;
+  for (uint64_t position = start; readElementHeader(position, end, id, size, headerSize,
+    unknownSize) && !unknownSize; position += headerSize + size)
+  {
+    if (id != ID_SEEK)
+    {
+      continue;
+    }
+
+    // Seek positions are relative to the start of the segment's data
+    uint64_t seekId = 0, seekPosition = 0;
+    uint64_t seekEnd = position + headerSize + size;
+    uint32_t childId, childHeaderSize;
+    uint64_t childSize;
+    for (uint64_t child = position + headerSize; readElementHeader(child, seekEnd, childId,
+      childSize, childHeaderSize, unknownSize) && !unknownSize;
+      child += childHeaderSize + childSize)
+    {
+      if (childId == ID_SEEK_ID)
+      {
+        seekId = readUnsigned(child + childHeaderSize, childSize);
+      }
+      else if (childId == ID_SEEK_POSITION)
+      {
+        seekPosition = readUnsigned(child + childHeaderSize, childSize);
+      }
+    }
+    if ((seekId == ID_TAGS) && (tagsPosition == 0))
+    {
+      tagsPosition = segmentStart + seekPosition;
+    }
+  }
+}
+
+void MkvReader::parseSegmentInfo(uint64_t start, uint64_t end)
+{
+  uint32_t id, headerSize;
+  uint64_t size;
+  bool unknownSize;
+  for (uint64_t position = start; readElementHeader(position, end, id, size, headerSize,
+    unknownSize) && !unknownSize; position += headerSize + size)
+  {
+    if (id == ID_TIMESTAMP_SCALE)
+    {
+      timestampScale = readUnsigned(position + headerSize, size);
+    }
+    else if (id == ID_DURATION)
+    {
+      duration = readFloat(position + headerSize, size);
+    }
+  }
+}
+
+void MkvReader::parseTracks(uint64_t start, uint64_t end)
+{
+  uint32_t id, headerSize;
+  uint64_t size;
+  bool unknownSize;
+  for (uint64_t position = start; !foundVideoTrack && readElementHeader(position, end,
+    id, size, headerSize, unknownSize) && !unknownSize; position += headerSize + size)
+  {
+    if (id != ID_TRACK_ENTRY)
+    {
+      continue;
+    }
+
+    // Collect the fields of this track and keep them if it's a video track
+    uint64_t type = 0, uid = 0, defaultDuration = 0;
+    uint32_t pixelWidth = 0, pixelHeight = 0;
+    uint64_t entryEnd = position + headerSize + size;
+    uint32_t childId, childHeaderSize;
+    uint64_t childSize;
+    for (uint64_t child = position + headerSize; readElementHeader(child, entryEnd,
+      childId, childSize, childHeaderSize, unknownSize) && !unknownSize;
+      child += childHeaderSize + childSize)
+    {
+      uint64_t body = child + childHeaderSize;
+      if (childId == ID_TRACK_TYPE)
+      {
+        type = readUnsigned(body, childSize);
+      }
+      else if (childId == ID_TRACK_UID)
+      {
+        uid = readUnsigned(body, childSize);
+      }
+      else if (childId == ID_DEFAULT_DURATION)
+      {
+        defaultDuration = readUnsigned(body, childSize);
+      }
+      else if (childId == ID_VIDEO)
+      {
+        uint32_t videoId, videoHeaderSize;
+        uint64_t videoSize;
+        for (uint64_t video = body; readElementHeader(video, body + childSize, videoId,
+          videoSize, videoHeaderSize, unknownSize) && !unknownSize;
+          video += videoHeaderSize + videoSize)
+        {
+          if (videoId == ID_PIXEL_WIDTH)
+          {
+            pixelWidth = (uint32_t)readUnsigned(video + videoHeaderSize, videoSize);
+          }
+          else if (videoId == ID_PIXEL_HEIGHT)
+          {
+            pixelHeight = (uint32_t)readUnsigned(video + videoHeaderSize, videoSize);
+          }
+        }
+      }
+    }
+    if (type == TRACK_TYPE_VIDEO)
+    {
+      foundVideoTrack = true;
+      trackUid = uid;
+      width = pixelWidth;
+      height = pixelHeight;
+      defaultDurationNs = defaultDuration;
+    }
+  }
+}
+
+void MkvReader::parseTags(uint64_t start, uint64_t end)
+{
+  uint32_t id, headerSize;
+  uint64_t size;
+  bool unknownSize;
+  for (uint64_t position = start; readElementHeader(position, end, id, size, headerSize,
+    unknownSize) && !unknownSize; position += headerSize + size)
+  {
+    if (id != ID_TAG)
+    {
+      continue;
+    }
+
+    // Gather the simple tags along with the track they describe, if any
+    uint64_t tagUid = 0;
+    uint64_t tagEnd = position + headerSize + size;
+    uint32_t childId, childHeaderSize;
+    uint64_t childSize;
+    for (uint64_t child = position + headerSize; readElementHeader(child, tagEnd, childId,
+      childSize, childHeaderSize, unknownSize) && !unknownSize;
+      child += childHeaderSize + childSize)
+    {
+      uint64_t body = child + childHeaderSize;
+      uint32_t fieldId, fieldHeaderSize;
+      uint64_t fieldSize;
+      if (childId == ID_TARGETS)
+      {
+        for (uint64_t field = body; readElementHeader(field, body + childSize, fieldId,
+          fieldSize, fieldHeaderSize, unknownSize) && !unknownSize;
+          field += fieldHeaderSize + fieldSize)
+        {
+          if (fieldId == ID_TAG_TRACK_UID)
+          {
+            tagUid = readUnsigned(field + fieldHeaderSize, fieldSize);
+          }
+        }
+      }
+      else if (childId == ID_SIMPLE_TAG)
+      {
+        SimpleTag tag;
+        tag.trackUid = tagUid;
+        for (uint64_t field = body; readElementHeader(field, body + childSize, fieldId,
+          fieldSize, fieldHeaderSize, unknownSize) && !unknownSize;
+          field += fieldHeaderSize + fieldSize)
+        {
+          if (fieldId == ID_TAG_NAME)
+          {
+            tag.name = readString(field + fieldHeaderSize, fieldSize);
+          }
+          else if (fieldId == ID_TAG_STRING)
+          {
+            tag.value = readString(field + fieldHeaderSize, fieldSize);
+          }
+        }
+        tags.push_back(tag);
+      }
+    }
+  }
+}
+
+void MkvReader::resolveTags()
+{
+  // Muxers such as mkvmerge and ffmpeg write statistics tags for each track. The frame
+  // count is exact and the duration is used when the segment doesn't declare one
+  uint64_t durationNs = (uint64_t)(duration * (double)timestampScale);
+  for (auto it = tags.begin(); it != tags.end(); ++it)
+  {
+    if ((it->trackUid != 0) && (it->trackUid != trackUid))
+    {
+      continue;
+    }
+    if (it->name == "NUMBER_OF_FRAMES")
+    {
+      frameCount = (uint32_t)strtoul(it->value.c_str(), nullptr, 10);
+    }
+    else if ((it->name == "DURATION") && (durationNs == 0))
+    {
+      // Formatted as HH:MM:SS.nnnnnnnnn
+      unsigned hours = 0, minutes = 0;
+      double seconds = 0;
+      if (sscanf(it->value.c_str(), "%u:%u:%lf", &hours, &minutes, &seconds) == 3)
+      {
+        durationNs = (uint64_t)(((hours * 60.0 + minutes) * 60.0 + seconds) * 1e9);
+      }
+    }
+  }
+  durationUsec = durationNs / 1000;
+  if ((frameCount == 0) && (defaultDurationNs != 0))
+  {
+    frameCount = (uint32_t)round((double)durationNs / (double)defaultDurationNs);
+  }
+  else if (durationUsec == 0)
+  {
+    durationUsec = (uint64_t)frameCount * defaultDurationNs / 1000;
+  }
+}
+
+bool MkvReader::readElementHeader(uint64_t position, uint64_t end, uint32_t& id,
+  uint64_t& size, uint32_t& headerSize, bool& unknownSize)
+{
+  // IDs are variable-length integers of up to four bytes that keep their marker bits
+  if ((position >= end) || (fileData[position] == 0))
+  {
+    return false;
+  }
+  uint32_t idLength = 1;
+  while (!(fileData[position] & (0x80 >> (idLength - 1))))
+  {
+    idLength += 1;
+  }
+  if ((idLength > 4) || ((position + idLength) >= end))
+  {
+    return false;
+  }
+  id = 0;
+  for (uint32_t i = 0; i < idLength; ++i)
+  {
+    id = (id << 8) | fileData[position + i];
+  }
+
+  // Sizes are variable-length integers of up to eight bytes with the marker removed. A
+  // size with every bit set means the element runs to the end of its parent
+  uint64_t sizePosition = position + idLength;
+  uint8_t first = fileData[sizePosition];
+  if (first == 0)
+  {
+    return false;
+  }
+  uint32_t sizeLength = 1;
+  while (!(first & (0x80 >> (sizeLength - 1))))
+  {
+    sizeLength += 1;
+  }
+  if ((sizePosition + sizeLength) > end)
+  {
+    return false;
+  }
+  size = first & (0xFF >> sizeLength);
+  bool allOnes = (size == (uint64_t)(0xFF >> sizeLength));
+  for (uint32_t i = 1; i < sizeLength; ++i)
+  {
+    uint8_t value = fileData[sizePosition + i];
+    size = (size << 8) | value;
+    allOnes = allOnes && (value == 0xFF);
+  }
+  headerSize = idLength + sizeLength;
+  unknownSize = allOnes;
+  if (unknownSize)
+  {
+    size = end - position - headerSize;
+  }
+  return (size <= (end - position - headerSize));
+}
+
+uint64_t MkvReader::readUnsigned(uint64_t position, uint64_t size)
+{
+  uint64_t value = 0;
+  for (uint64_t i = 0; (i < size) && (i < 8); ++i)
+  {
+    value = (value << 8) | fileData[position + i];
+  }
+  return value;
+}
+
+double MkvReader::readFloat(uint64_t position, uint64_t size)
+{
+  uint64_t bits = readUnsigned(position, size);
+  if (size == 4)
+  {
+    uint32_t bits32 = (uint32_t)bits;
+    float value;
+    memcpy(&value, &bits32, sizeof(value));
+    return value;
+  }
+  if (size == 8)
+  {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  return 0;
+}
+
+string MkvReader::readString(uint64_t position, uint64_t size)
+{
+  // Strings may be padded with trailing zeros
+  string value((const char*)fileData + position, (size_t)size);
+  size_t nullPos = value.find('\0');
+  if (nullPos != string::npos)
+  {
+    value.resize(nullPos);
+  }
+  return value;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The MkvReader class reads the properties of the first video track in a Matroska or
+// WebM file without touching the media data. The file is memory-mapped and the
+// top-level elements of the segment are walked until the first cluster. Only SeekHead,
+// Info, Tracks, and Tags are parsed. Tags are usually written after the clusters and
+// are reached through the SeekHead.
+//
+// Matroska has no sample table, so the frame count comes from the NUMBER_OF_FRAMES
+// statistics tag when the muxer wrote one and otherwise from the duration divided by
+// the track's default frame duration.
+class MkvReader
+{
+public:
+  MkvReader(std::string path);
+  virtual ~MkvReader() {};
+
+  bool parseInfo(std::string& error);
+
+  uint32_t getWidth();
+  uint32_t getHeight();
+  uint32_t getFps();
+  uint32_t getFrameCount();
+  uint64_t getDurationUsec();
+
+private:
+  struct SimpleTag
+  {
+    uint64_t trackUid;
+    std::string name;
+    std::string value;
+  };
+
+  bool parseFile(std::string& error);
+  bool parseSegment(uint64_t start, uint64_t end, std::string& error);
+  void parseSeekHead(uint64_t start, uint64_t end, uint64_t segmentStart);
+  void parseSegmentInfo(uint64_t start, uint64_t end);
+  void parseTracks(uint64_t start, uint64_t end);
+  void parseTags(uint64_t start, uint64_t end);
+  void resolveTags();
+
+  bool readElementHeader(uint64_t position, uint64_t end, uint32_t& id, uint64_t& size,
+    uint32_t& headerSize, bool& unknownSize);
+  uint64_t readUnsigned(uint64_t position, uint64_t size);
+  double readFloat(uint64_t position, uint64_t size);
+  std::string readString(uint64_t position, uint64_t size);
+
+private:
+  std::string path;
+  const uint8_t* fileData = nullptr;
+  uint64_t fileSize = 0;
+  uint64_t mapId = 0;
+  uint64_t tagsPosition = 0;
+
+  // Fields collected from the segment and its first video track
+  uint64_t timestampScale = 1000000;
+  double duration = 0;
+  bool foundVideoTrack = false;
+  uint64_t trackUid = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint64_t defaultDurationNs = 0;
+  uint32_t frameCount = 0;
+  uint64_t durationUsec = 0;
+  std::vector<SimpleTag> tags;
+};
@@ -0,0 +1,441 @@
+#include "Mp4Reader.h"
+#include "Platform.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+Mp4Reader::Mp4Reader(string p) :
+  path(p)
+{
+}
+
+bool Mp4Reader::parse(string& error)
+{
+  infoOnly = false;
+  if (!parseFile(error))
+  {
+    return false;
+  }
+  return buildSamples(error);
+}
+
+bool Mp4Reader::parseInfo(string& error)
+{
+  infoOnly = true;
+  if (!parseFile(error))
+  {
+    return false;
+  }
+  if ((sampleCount == 0) || (timescale == 0) || timeToSample.empty())
+  {
+    error = "Video track in " + path + " has no sample tables";
+    return false;
+  }
+  return true;
+}
+
+uint32_t Mp4Reader::getTimescale()
+{
+  return timescale;
+}
+
+uint32_t Mp4Reader::getWidth()
+{
+  return width;
+}
+
+uint32_t Mp4Reader::getHeight()
+{
+  return height;
+}
+
+uint32_t Mp4Reader::getSampleCount()
+{
+  return sampleCount;
+}
+
+uint32_t Mp4Reader::getFps()
+{
+  // Variable frame rate files are played back at the rate most of their frames use
+  uint32_t commonCount = 0, commonDelta = 0;
+  for (auto it = timeToSample.begin(); it != timeToSample.end(); ++it)
+  {
+    if ((it->first > commonCount) && (it->second != 0))
+    {
+      commonCount = it->first;
+      commonDelta = it->second;
+    }
+  }
+  if (commonDelta == 0)
+  {
+    return 0;
+  }
+  return (uint32_t)round((double)timescale / (double)commonDelta);
+}
+
+uint64_t Mp4Reader::getDurationUsec()
+{
+  if (timescale == 0)
+  {
+    return 0;
+  }
+  uint64_t ticks = 0;
+  for (auto it = timeToSample.begin(); it != timeToSample.end(); ++it)
+  {
+    ticks += (uint64_t)it->first * it->second;
+  }
+  return (uint64_t)((double)ticks * 1000000.0 / (double)timescale);
+}
+
+vector<Mp4Sample>& Mp4Reader::getSamples()
+{
+  return samples;
+}
+
+uint32_t Mp4Reader::findSyncSample(uint32_t frameNumber)
+{
+  if (samples.empty())
+  {
+    return 0;
+  }
+  uint32_t index = min(frameNumber, (uint32_t)samples.size() - 1);
+  while ((index > 0) && !samples[index].sync)
+  {
+    index -= 1;
+  }
+  return index;
+}
+
+bool Mp4Reader::parseFile(string& error)
+{
+  // Map the file rather than reading it so only the pages that hold the boxes we visit
+  // are loaded. The sample tables are scattered through the movie box, hence random
+  // rather than sequential access
+  if (!platform::mapFile(path, false, fileData, fileSize, mapId))
+  {
+    error = "Failed to open " + path;
+    return false;
+  }
+
+  // Walk the top-level boxes and everything beneath the movie box
+  bool result = parseContainer(0, fileSize, error);
+  platform::unmapFile(fileData, fileSize, mapId);
+  fileData = nullptr;
+  if (!result)
+  {
+    return false;
+  }
+  if (!foundVideoTrack)
+  {
+    error = "No video track found in " + path;
+    return false;
+  }
+  return true;
+}
+
+bool Mp4Reader::parseContainer(uint64_t start, uint64_t end, string& error)
+{
+  uint64_t position = start;
+  while (position < end)
+  {
+    uint64_t boxSize;
+    uint32_t headerSize;
+    string boxType;
+    if (!readBoxHeader(position, end, boxSize, headerSize, boxType))
+    {
+      error = "Malformed box header in " + path;
+      return false;
+    }
+    uint64_t bodyStart = position + headerSize;
+    uint64_t bodyEnd = position + boxSize;
+    if ((boxType == "moov") || (boxType == "mdia") || (boxType == "minf") ||
+      (boxType == "stbl") || (boxType == "edts"))
+    {
+      if (!parseContainer(bodyStart, bodyEnd, error))
+      {
+        return false;
+      }
+    }
+    else if (boxType == "trak")
+    {
+      if (!foundVideoTrack && !parseTrack(bodyStart, bodyEnd, error))
+      {
+        return false;
+      }
+    }
+    else if ((boxType == "mdhd") || (boxType == "hdlr") || (boxType == "stsd") ||
+      (boxType == "stts") || (boxType == "stsz") || (!infoOnly && ((boxType == "elst") ||
+      (boxType == "ctts") || (boxType == "stss") || (boxType == "stsc") ||
+      (boxType == "stco") || (boxType == "co64"))))
+    {
+      if ((bodyEnd - bodyStart) < 8)
+      {
+        error = "Failed to read " + boxType + " box from " + path;
+        return false;
+      }
+      const uint8_t* data = fileData + bodyStart;
+      uint8_t version = data[0];
+      const uint8_t* body = data + 4;
+      size_t bodyLength = (size_t)(bodyEnd - bodyStart) - 4;
+      uint32_t count = readUint32(body);
+      if (boxType == "mdhd")
+      {
+        size_t offset = (version == 1) ? 16 : 8;
+        if (bodyLength >= offset + 4)
+        {
+          timescale = readUint32(body + offset);
+        }
+      }
+      else if (boxType == "hdlr")
+      {
+        if (bodyLength >= 8)
+        {
+          string handler((const char*)body + 4, 4);
+          if (handler == "vide")
+          {
+            foundVideoTrack = true;
+          }
+        }
+      }
+      else if (boxType == "stsd")
+      {
+        // The dimensions follow the common fields of the first visual sample entry
+        if ((count > 0) && (bodyLength >= 40))
+        {
+          width = ((uint32_t)body[36] << 8) | body[37];
+          height = ((uint32_t)body[38] << 8) | body[39];
+        }
+      }
+      else if (boxType == "elst")
+      {
+        // Use the media time of the first non-empty edit
+        size_t entrySize = (version == 1) ? 16 : 8;
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * entrySize <= bodyLength); ++i)
+        {
+          const uint8_t* entry = body + 4 + i * entrySize;
+          int64_t mediaTime = (version == 1) ? (int64_t)readUint64(entry + 8) :
+            (int64_t)(int32_t)readUint32(entry + 4);
+          if (mediaTime != -1)
+          {
+            editMediaTime = mediaTime;
+            break;
+          }
+        }
+      }
+      else if (boxType == "stts")
+      {
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * 8 <= bodyLength); ++i)
+        {
+          timeToSample.push_back(make_pair(readUint32(body + 4 + i * 8),
+            readUint32(body + 8 + i * 8)));
+        }
+      }
+      else if (boxType == "ctts")
+      {
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * 8 <= bodyLength); ++i)
+        {
+          compositionOffsets.push_back(make_pair(readUint32(body + 4 + i * 8),
+            (int32_t)readUint32(body + 8 + i * 8)));
+        }
+      }
+      else if (boxType == "stss")
+      {
+        allSamplesSync = false;
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * 4 <= bodyLength); ++i)
+        {
+          syncSamples.push_back(readUint32(body + 4 + i * 4));
+        }
+      }
+      else if (boxType == "stsz")
+      {
+        // The first field is the uniform sample size and the second is the count
+        uint32_t sampleSize = count;
+        sampleCount = (bodyLength >= 8) ? readUint32(body + 4) : 0;
+        for (uint32_t i = 0; !infoOnly && (i < sampleCount); ++i)
+        {
+          if (sampleSize != 0)
+          {
+            sampleSizes.push_back(sampleSize);
+          }
+          else if (8 + (i + 1) * 4 <= bodyLength)
+          {
+            sampleSizes.push_back(readUint32(body + 8 + i * 4));
+          }
+        }
+      }
+      else if (boxType == "stsc")
+      {
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * 12 <= bodyLength); ++i)
+        {
+          sampleToChunk.push_back(make_pair(readUint32(body + 4 + i * 12),
+            readUint32(body + 8 + i * 12)));
+        }
+      }
+      else if (boxType == "stco")
+      {
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * 4 <= bodyLength); ++i)
+        {
+          chunkOffsets.push_back(readUint32(body + 4 + i * 4));
+        }
+      }
+      else if (boxType == "co64")
+      {
+        for (uint32_t i = 0; (i < count) && (4 + (i + 1) * 8 <= bodyLength); ++i)
+        {
+          chunkOffsets.push_back(readUint64(body + 4 + i * 8));
+        }
+      }
+    }
+    position = bodyEnd;
+  }
+  return true;
+}
+
+bool Mp4Reader::parseTrack(uint64_t start, uint64_t end, string& error)
+{
+  // Parse the track and discard everything we collected if it turns out not to be
+  // a video track
+  if (!parseContainer(start, end, error))
+  {
+    return false;
+  }
+  if (!foundVideoTrack)
+  {
+    timescale = 0;
+    width = 0;
+    height = 0;
+    sampleCount = 0;
+    editMediaTime = 0;
+    timeToSample.clear();
+    compositionOffsets.clear();
+    syncSamples.clear();
+    allSamplesSync = true;
+    sampleSizes.clear();
+    sampleToChunk.clear();
+    chunkOffsets.clear();
+  }
+  return true;
+}
+
+bool Mp4Reader::readBoxHeader(uint64_t position, uint64_t end, uint64_t& boxSize,
+  uint32_t& headerSize, string& boxType)
+{
+  if ((position + 8) > end)
+  {
+    return false;
+  }
+  const uint8_t* header = fileData + position;
+  boxSize = readUint32(header);
+  boxType = string((const char*)header + 4, 4);
+  headerSize = 8;
+  if (boxSize == 1)
+  {
+    // A 64-bit size follows the type
+    if ((position + 16) > end)
+    {
+      return false;
+    }
+    boxSize = readUint64(header + 8);
+    headerSize = 16;
+  }
+  else if (boxSize == 0)
+  {
+    // The box extends to the end of its parent
+    boxSize = end - position;
+  }
+  return ((boxSize >= headerSize) && ((position + boxSize) <= end));
+}
+
+bool Mp4Reader::buildSamples(string& error)
+{
+  sampleCount = (uint32_t)sampleSizes.size();
+  if ((sampleCount == 0) || chunkOffsets.empty() || sampleToChunk.empty())
+  {
+    error = "Video track in " + path + " has no sample tables";
+    return false;
+  }
+  samples.resize(sampleCount);
+
+  // Decode timestamps from the time-to-sample table
+  int64_t dts = 0;
+  uint32_t sample = 0;
+  for (auto it = timeToSample.begin(); it != timeToSample.end(); ++it)
+  {
+    for (uint32_t i = 0; (i < it->first) && (sample < sampleCount); ++i, ++sample)
+    {
+      samples[sample].pts = dts;
+      dts += it->second;
+    }
+  }
+  for (; sample < sampleCount; ++sample)
+  {
+    samples[sample].pts = dts;
+  }
+
+  // Apply the composition offsets and the edit list to get presentation timestamps
+  sample = 0;
+  for (auto it = compositionOffsets.begin(); it != compositionOffsets.end(); ++it)
+  {
+    for (uint32_t i = 0; (i < it->first) && (sample < sampleCount); ++i, ++sample)
+    {
+      samples[sample].pts += it->second;
+    }
+  }
+  for (sample = 0; sample < sampleCount; ++sample)
+  {
+    samples[sample].pts -= editMediaTime;
+    samples[sample].size = sampleSizes[sample];
+    samples[sample].sync = allSamplesSync;
+  }
+  for (auto it = syncSamples.begin(); it != syncSamples.end(); ++it)
+  {
+    if ((*it >= 1) && (*it <= sampleCount))
+    {
+      samples[*it - 1].sync = true;
+    }
+  }
+
+  // Walk the chunks to calculate the file offset of each sample
+  sample = 0;
+  for (size_t entry = 0; entry < sampleToChunk.size(); ++entry)
+  {
+    uint32_t firstChunk = sampleToChunk[entry].first;
+    uint32_t lastChunk = (entry + 1 < sampleToChunk.size()) ?
+      sampleToChunk[entry + 1].first : (uint32_t)chunkOffsets.size() + 1;
+    uint32_t samplesPerChunk = sampleToChunk[entry].second;
+    for (uint32_t chunk = firstChunk; (chunk < lastChunk) &&
+      (chunk <= chunkOffsets.size()); ++chunk)
+    {
+      uint64_t offset = chunkOffsets[chunk - 1];
+      for (uint32_t i = 0; (i < samplesPerChunk) && (sample < sampleCount); ++i, ++sample)
+      {
+        samples[sample].offset = offset;
+        offset += samples[sample].size;
+      }
+    }
+  }
+  if (sample != sampleCount)
+  {
+    error = "Sample-to-chunk table in " + path + " does not cover every sample";
+    return false;
+  }
+
+  // Sort the samples into presentation order
+  stable_sort(samples.begin(), samples.end(), [](const Mp4Sample& a, const Mp4Sample& b)
+  {
+    return a.pts < b.pts;
+  });
+  return true;
+}
+
+uint32_t Mp4Reader::readUint32(const uint8_t* data)
+{
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+    ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+uint64_t Mp4Reader::readUint64(const uint8_t* data)
+{
+  return ((uint64_t)readUint32(data) << 32) | (uint64_t)readUint32(data + 4);
+}
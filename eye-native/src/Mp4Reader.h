@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A single sample (i.e. encoded frame) from the video track of an MP4 file. The
+// presentation timestamp is expressed in the track's timescale and has any edit list
+// offset already applied so the first frame is displayed at zero
+struct Mp4Sample
+{
+  uint64_t offset;
+  uint32_t size;
+  int64_t pts;
+  bool sync;
+};
+
+// The Mp4Reader class reads the sample tables of the first video track in an MP4 file
+// without touching the media data. Only the boxes needed to locate each sample are
+// parsed: mdhd, hdlr, stsd, elst, stts, ctts, stss, stsz, stsc, and stco/co64. The file
+// is memory-mapped so only the pages holding those boxes are read from disk.
+//
+// parseInfo() is a lighter pass for probing a video before playback. It reads just
+// mdhd, hdlr, stsd, stts, and the header of stsz, and skips building the sample list.
+class Mp4Reader
+{
+public:
+  Mp4Reader(std::string path);
+  virtual ~Mp4Reader() {};
+
+  bool parse(std::string& error);
+  bool parseInfo(std::string& error);
+
+  uint32_t getTimescale();
+  uint32_t getWidth();
+  uint32_t getHeight();
+  uint32_t getSampleCount();
+
+  // The nominal frame rate is rounded from the most common sample duration
+  uint32_t getFps();
+  uint64_t getDurationUsec();
+
+  // Samples are returned in presentation order, i.e. index N is the Nth frame displayed
+  std::vector<Mp4Sample>& getSamples();
+
+  // Return the index of the closest sync sample at or before the given frame
+  uint32_t findSyncSample(uint32_t frameNumber);
+
+private:
+  bool parseFile(std::string& error);
+  bool parseContainer(uint64_t start, uint64_t end, std::string& error);
+  bool parseTrack(uint64_t start, uint64_t end, std::string& error);
+  bool readBoxHeader(uint64_t position, uint64_t end, uint64_t& boxSize,
+    uint32_t& headerSize, std::string& boxType);
+  bool buildSamples(std::string& error);
+
+  static uint32_t readUint32(const uint8_t* data);
+  static uint64_t readUint64(const uint8_t* data);
+
+private:
+  std::string path;
+  bool infoOnly = false;
+  const uint8_t* fileData = nullptr;
+  uint64_t fileSize = 0;
+  uint64_t mapId = 0;
+
+  // Fields collected from the first video track
+  bool foundVideoTrack = false;
+  uint32_t timescale = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t sampleCount = 0;
+  int64_t editMediaTime = 0;
+  std::vector<std::pair<uint32_t, uint32_t>> timeToSample;
+  std::vector<std::pair<uint32_t, int32_t>> compositionOffsets;
+  std::vector<uint32_t> syncSamples;
+  bool allSamplesSync = true;
+  std::vector<uint32_t> sampleSizes;
+  std::vector<std::pair<uint32_t, uint32_t>> sampleToChunk;
+  std::vector<uint64_t> chunkOffsets;
+
+  std::vector<Mp4Sample> samples;
+};
@@ -1,11 +1,44 @@
 #include "Native.h"
+#include "BarGenerator.h"
 #include "CalibrationThread.h"
+#include "CheckerboardGenerator.h"
+#include "ChirpGenerator.h"
+#include "Color.h"
+#include "DryRunAnalyzer.h"
+#include "EyeChartGenerator.h"
+#include "FfmpegPlaybackProcess.h"
+#include "FrameCode.h"
+#include "FrameArchiveReader.h"
+#include "FrameArchiveWriter.h"
+#include "FrameStore.h"
+#include "FrameStoreWriter.h"
+#include "GammaTable.h"
+#include "GeneratorThread.h"
+#include "GlyphAtlas.h"
+#include "GratingGenerator.h"
+#include "ImageCache.h"
+#include "ImageGenerator.h"
+#include "LetterGenerator.h"
+#include "LuminanceTraceWriter.h"
+#include "PlaybackPrepareThread.h"
 #include "Platform.h"
 #include "PlaybackThread.h"
+#include "PresentationLog.h"
 #include "PreviewReceiveThread.h"
+#include "ProbeCache.h"
+#include "ProjectorThread.h"
 #include "RecordThread.h"
+#include "SimulatedEventSource.h"
+#include "SolidGenerator.h"
+#include "Stimuli.h"
+#include "SyncPatch.h"
+#include "SyncTracker.h"
+#include "TensorExportWriter.h"
+#include "TiledLetterGenerator.h"
+#include "WhiteNoiseGenerator.h"
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <chrono>
 #include <stdio.h>
 
 using namespace std;
@@ -15,14 +48,78 @@ using namespace cv;
 string gFfmpegPath, gFfprobePath;
 wrapper::JsCallback* gLogCallback = 0;
 bool gInitialized = false, gRecording = false, gPlaying = false, gCalibrating = false;
-uint32_t gNextFrameId = 0, gWidth = 0, gHeight = 0;
+uint32_t gNextFrameId = 0, gWidth = 0, gHeight = 0, gFps = 0;
+uint32_t gRecordFirstFrameId = 0;
+bool gNativeLetters = false;
 shared_ptr<Queue<shared_ptr<FrameWrapper>>> gPendingFrameQueue(new Queue<shared_ptr<FrameWrapper>>());
 shared_ptr<Queue<shared_ptr<FrameWrapper>>> gCompletedFrameQueue(new Queue<shared_ptr<FrameWrapper>>());
 shared_ptr<Queue<Mat*>> gPendingPreviewQueue(new Queue<Mat*>());
+vector<pair<uint32_t, uint32_t>> gStimulusBoundaries;
+string gFrameArchivePath;
+uint32_t gFrameArchiveCompression = FRAME_ARCHIVE_COMPRESSION_LZ4;
+string gFrameStorePath, gFrameStoreRunName;
+uint32_t gFrameStoreCompression = FRAME_ARCHIVE_COMPRESSION_LZ4;
+bool gLuminanceTrace = false, gLuminanceTraceBinary = false;
+uint32_t gLuminanceGridRows = 0, gLuminanceGridColumns = 0;
+bool gTensorExport = false, gTensorFloat = false;
+uint32_t gTensorWidth = 0, gTensorHeight = 0, gTensorFramesPerShard = 0;
+bool gDryRun = false;
+uint8_t gDryRunGamutMin[3] = { 0, 0, 0 }, gDryRunGamutMax[3] = { 255, 255, 255 };
+shared_ptr<DryRunAnalyzer> gDryRunAnalyzer(nullptr);
+shared_ptr<GammaTable> gRecordGammaTable(nullptr), gPlaybackGammaTable(nullptr);
+shared_ptr<SyncPatch> gSyncPatch(nullptr);
+shared_ptr<ExternalEventSource> gSyncEventSource(nullptr);
+shared_ptr<SyncTracker> gSyncTracker(nullptr);
+shared_ptr<FrameCode> gRecordFrameCode(nullptr), gPlaybackFrameCode(nullptr);
+uint32_t gDecoderLookahead = 1;
+uint32_t gPlaybackBufferMegabytes = DEFAULT_PLAYBACK_BUFFER_MEGABYTES;
+bool gDecodeToDisplay = false;
+uint32_t gStarvationPolicy = STARVATION_POLICY_DRIFT;
+string gPresentationLogPath;
+shared_ptr<ProbeCache> gProbeCache(nullptr);
+shared_ptr<PlaybackCache> gPlaybackCache(nullptr);
 shared_ptr<RecordThread> gRecordThread(nullptr);
+shared_ptr<GeneratorThread> gGeneratorThread(nullptr);
 shared_ptr<PlaybackThread> gPlaybackThread(nullptr);
 shared_ptr<PreviewReceiveThread> gPreviewReceiveThread(nullptr);
 shared_ptr<CalibrationThread> gCalibrationThread(nullptr);
+shared_ptr<PlaybackPrepareThread> gPlaybackPrepareThread(nullptr);
+shared_ptr<ImageCache> gImageCache(nullptr);
+vector<shared_ptr<RecordThread>> gFinishingRecordThreads;
+
+// Default size of the decoded image cache
+#define DEFAULT_IMAGE_CACHE_MEGABYTES 1024
+
+// Largest number of videos that can be decoded ahead of the one playing
+#define MAX_DECODER_LOOKAHEAD 8
+
+// How long the decode benchmark waits for a frame before checking if decoding is over
+#define BENCHMARK_IDLE_MS 100
+
+// Releases the record threads of earlier recordings that have finished
+static void pruneFinishingRecordThreads()
+{
+  for (auto it = gFinishingRecordThreads.begin(); it != gFinishingRecordThreads.end(); )
+  {
+    if ((*it)->isRunning())
+    {
+      ++it;
+      continue;
+    }
+    it = gFinishingRecordThreads.erase(it);
+  }
+}
+
+// Waits for the record threads of earlier recordings to finish their files
+static void joinFinishingRecordThreads()
+{
+  for (auto it = gFinishingRecordThreads.begin(); it != gFinishingRecordThreads.end();
+    ++it)
+  {
+    (*it)->join();
+  }
+  gFinishingRecordThreads.clear();
+}
 
 void native::initialize(Napi::Env env, string ffmpegPath, string ffprobePath,
   wrapper::JsCallback* logCallback)
@@ -45,14 +142,62 @@ string native::createVideoOutput(Napi::Env env, int width, int height, int fps,
   {
     return "Recording already in progress";
   }
+
+  // A previous recording may still be finishing its files, which could include this
+  // output or the frame store, and its thread still shares the frame queues
+  joinFinishingRecordThreads();
   gWidth = width;
   gHeight = height;
+  gFps = fps;
+
+  // Frame IDs keep counting across recordings. Remember where this one starts so a
+  // frame's index in the video can be worked out when it's queued
+  gRecordFirstFrameId = gNextFrameId;
+
+  // Create the optional stages that the record thread will run on each frame
+  vector<shared_ptr<RecordStage>> stages;
+  if (!gFrameArchivePath.empty())
+  {
+    stages.push_back(shared_ptr<RecordStage>(new FrameArchiveWriter(gFrameArchivePath,
+      gFrameArchiveCompression)));
+  }
+  if (!gFrameStorePath.empty())
+  {
+    stages.push_back(shared_ptr<RecordStage>(new FrameStoreWriter(gFrameStorePath,
+      gFrameStoreRunName, gFrameStoreCompression)));
+  }
+  if (gLuminanceTrace)
+  {
+    stages.push_back(shared_ptr<RecordStage>(new LuminanceTraceWriter(
+      LuminanceTraceWriter::getTracePath(outputPath, gLuminanceTraceBinary),
+      gLuminanceTraceBinary, gLuminanceGridRows, gLuminanceGridColumns)));
+  }
+  if (gTensorExport)
+  {
+    stages.push_back(shared_ptr<RecordStage>(new TensorExportWriter(outputPath,
+      gTensorWidth, gTensorHeight, gTensorFloat, gTensorFramesPerShard)));
+  }
+  if ((gRecordFrameCode != nullptr) && !gRecordFrameCode->fits(width, height))
+  {
+    return "Frame code does not fit in the frame";
+  }
+  gDryRunAnalyzer = nullptr;
+  if (gDryRun)
+  {
+    gDryRunAnalyzer = shared_ptr<DryRunAnalyzer>(new DryRunAnalyzer(gDryRunGamutMin,
+      gDryRunGamutMax, gStimulusBoundaries));
+    stages.push_back(gDryRunAnalyzer);
+  }
 
   // Spawn the recording thread that will create the ffmpeg process, feed it frames as
   // we place them in the pending frames queue, optionally transmit those frames to the
-  // renderer process, and finally move them into the completed frames queue
+  // renderer process, and finally move them into the completed frames queue. A dry run
+  // skips ffmpeg and the preview
   gRecordThread = shared_ptr<RecordThread>(new RecordThread(gPendingFrameQueue,
-    gCompletedFrameQueue, gFfmpegPath, gWidth, gHeight, fps, outputPath));
+    gCompletedFrameQueue, gFfmpegPath, gWidth, gHeight, fps, outputPath,
+    gStimulusBoundaries, stages, gDryRun));
+  gRecordThread->setGammaTable(gRecordGammaTable);
+  gRecordThread->setFrameCode(gRecordFrameCode);
   gRecordThread->spawn();
 
   gRecording = true;
@@ -90,85 +235,1178 @@ int32_t native::queueNextFrame(Napi::Env env, uint8_t* frame, size_t length, int
     wrapper->nativeWidth = gWidth;
     wrapper->nativeHeight = gHeight;
   }
-  gPendingFrameQueue->addItem(wrapper);
+  if (gGeneratorThread != nullptr)
+  {
+    gGeneratorThread->queueFrame(wrapper);
+  }
+  else
+  {
+    gPendingFrameQueue->addItem(wrapper);
+  }
   return wrapper->number;
 }
 
-vector<int32_t> native::checkCompletedFrames(Napi::Env env)
+static int32_t queueGenerator(shared_ptr<FrameGenerator> generator)
 {
-  // Return an array of all frames that we're done with and free the associated memory
-  vector<int32_t> ret;
-  shared_ptr<FrameWrapper> wrapper;
-  while (gCompletedFrameQueue->waitItem(&wrapper, 0))
+  // Spawn the generator thread the first time a stimulus is generated. From then on
+  // captured frames are routed through it as well so they stay in order
+  if (gGeneratorThread == nullptr)
   {
-    ret.push_back(wrapper->number);
+    gGeneratorThread = shared_ptr<GeneratorThread>(new GeneratorThread(gPendingFrameQueue,
+      gWidth, gHeight));
+    gGeneratorThread->spawn();
   }
-  return ret;
+
+  // Reserve a frame ID for each frame the generator will produce
+  uint32_t firstFrameId = gNextFrameId;
+  gNextFrameId += generator->getFrameCount();
+  gGeneratorThread->queueGenerator(generator, firstFrameId);
+  return firstFrameId;
 }
 
-void native::closeVideoOutput(Napi::Env env)
+int32_t native::queueWhiteNoise(Napi::Env env, uint32_t frameCount, uint32_t rows,
+  uint32_t columns, bool color, uint32_t seed)
 {
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
   if (!gRecording)
   {
-    return;
+    return -1;
   }
-  if (gRecordThread != nullptr)
+  if ((frameCount == 0) || (rows == 0) || (columns == 0))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new WhiteNoiseGenerator(frameCount,
+    rows, columns, color, seed)));
+}
+
+int32_t native::queueGrating(Napi::Env env, uint32_t frameCount, bool sinusoidal,
+  double speed, double barWidth, double angle, string barColor, string backgroundColor)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || !(barWidth >= 1.0) ||
+    !color::parse(barColor, red, green, blue) ||
+    !color::parse(backgroundColor, red, green, blue))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new GratingGenerator(frameCount, gFps,
+    sinusoidal, speed, barWidth, angle, barColor, backgroundColor)));
+}
+
+int32_t native::queueChirp(Napi::Env env, uint32_t frameCount, double f0, double f1,
+  double a0, double a1, double t1, double phi)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  if ((frameCount == 0) || !(t1 > 0.0))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new ChirpGenerator(frameCount, gFps,
+    f0, f1, a0, a1, t1, phi)));
+}
+
+int32_t native::queueSolid(Napi::Env env, uint32_t frameCount, string color)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || !color::parse(color, red, green, blue))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new SolidGenerator(frameCount, color)));
+}
+
+int32_t native::queueCheckerboard(Napi::Env env, uint32_t frameCount, string color,
+  string alternateColor, double size, double angle)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || !(size >= 1.0) || !color::parse(color, red, green, blue) ||
+    !color::parse(alternateColor, red, green, blue))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new CheckerboardGenerator(frameCount,
+    color, alternateColor, size, angle)));
+}
+
+int32_t native::queueBar(Napi::Env env, uint32_t frameCount, double speed,
+  double barWidth, double angle, string barColor, string backgroundColor)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || !color::parse(barColor, red, green, blue) ||
+    !color::parse(backgroundColor, red, green, blue))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new BarGenerator(frameCount, gFps,
+    speed, barWidth, angle, barColor, backgroundColor)));
+}
+
+int32_t native::queueLetter(Napi::Env env, uint32_t frameCount, string letter, double x,
+  double y, double size, string color, string backgroundColor)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || (letter.size() != 1) || !GlyphAtlas::isSupported(letter[0]) ||
+    !(size >= 1.0) || !color::parse(color, red, green, blue) ||
+    !color::parse(backgroundColor, red, green, blue))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new LetterGenerator(frameCount, letter,
+    x, y, size, color, backgroundColor)));
+}
+
+int32_t native::queueTiledLetter(Napi::Env env, uint32_t frameCount, string letter,
+  double size, double padding, string color, double angle, string backgroundColor)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || (letter.size() != 1) || !GlyphAtlas::isSupported(letter[0]) ||
+    !(size >= 1.0) || !(padding >= 0.0) || !color::parse(color, red, green, blue) ||
+    !color::parse(backgroundColor, red, green, blue))
+  {
+    return -1;
+  }
+  return queueGenerator(shared_ptr<FrameGenerator>(new TiledLetterGenerator(frameCount,
+    letter, size, padding, color, angle, backgroundColor)));
+}
+
+int32_t native::queueEyeChart(Napi::Env env, uint32_t frameCount,
+  vector<string> letterMatrix, double size, double padding, string color,
+  string backgroundColor)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
+  {
+    return -1;
+  }
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || !(size >= 1.0) || !(padding >= 0.0) ||
+    !color::parse(color, red, green, blue) ||
+    !color::parse(backgroundColor, red, green, blue))
   {
-    if (gRecordThread->isRunning())
+    return -1;
+  }
+  for (auto row = letterMatrix.begin(); row != letterMatrix.end(); ++row)
+  {
+    for (auto letter = row->begin(); letter != row->end(); ++letter)
     {
-      gRecordThread->terminate();
+      if (!GlyphAtlas::isSupported(*letter))
+      {
+        return -1;
+      }
     }
-    gRecordThread = nullptr;
   }
-  gRecording = false;
+  return queueGenerator(shared_ptr<FrameGenerator>(new EyeChartGenerator(frameCount,
+    letterMatrix, size, padding, color, backgroundColor)));
 }
 
-string native::beginVideoPlayback(Napi::Env env, int32_t x, int32_t y,
-  vector<string> videos, bool scaleToFit, wrapper::JsCallback* durationCallback,
-  wrapper::JsCallback* positionCallback, wrapper::JsCallback* delayCallback)
+string native::queueStimuli(Napi::Env env, string batchJson,
+  vector<int32_t>& firstFrameIds, string& stopReason)
 {
-  // Make sure we've been initialized and aren't currently playing
+  // Make sure we've been initialized and are recording
   if (!gInitialized)
   {
     return "Library has not been initialized";
   }
-  if (gPlaying)
+  if (!gRecording)
   {
-    return "Playback already in progress";
+    return "Recording is not in progress";
   }
 
-  // Spawn the playback thread that will create the ffmpeg processes, read the
-  // frames as they are decoded, and store then in the pending frames queue
-  gPlaybackThread = shared_ptr<PlaybackThread>(new PlaybackThread(x, y,
-    videos, scaleToFit, gFfmpegPath, gFfprobePath, gLogCallback,
-    durationCallback, positionCallback, delayCallback));
-  gPlaybackThread->spawn();
+  // Queue the leading stimuli that can be rendered natively. Each generator renders its
+  // frames in parallel and they're reassembled in order behind any frames already queued
+  vector<shared_ptr<FrameGenerator>> generators;
+  string error;
+  if (!stimuli::createGenerators(batchJson, gFps, gNextFrameId - gRecordFirstFrameId,
+    gNativeLetters, generators, error))
+  {
+    return error;
+  }
+  firstFrameIds.clear();
+  for (auto it = generators.begin(); it != generators.end(); ++it)
+  {
+    if (*it == nullptr)
+    {
+      firstFrameIds.push_back(gNextFrameId);
+    }
+    else
+    {
+      firstFrameIds.push_back(queueGenerator(*it));
+    }
+  }
+  stopReason = error;
+  return "";
+}
 
-  gPlaying = true;
+int32_t native::countNativeStimuli(Napi::Env env, string batchJson, uint32_t fps)
+{
+  // Create the generators queueStimuli() would without queueing them
+  vector<shared_ptr<FrameGenerator>> generators;
+  string error;
+  if (!stimuli::createGenerators(batchJson, fps, 0, gNativeLetters, generators, error))
+  {
+    return -1;
+  }
+  return (int32_t)generators.size();
+}
+
+string native::setNativeLetters(Napi::Env env, bool enabled)
+{
+  gNativeLetters = enabled;
   return "";
 }
 
-string native::endVideoPlayback(Napi::Env env)
+static shared_ptr<ImageCache> getImageCache()
 {
-  if (!gPlaying)
+  // Create the image cache with the default size and a worker per core on first use
+  if (gImageCache == nullptr)
   {
-    return "";
+    gImageCache = shared_ptr<ImageCache>(new ImageCache(
+      (uint64_t)DEFAULT_IMAGE_CACHE_MEGABYTES << 20, (uint32_t)max(getNumThreads(), 1)));
   }
-  if (gPlaybackThread != nullptr)
+  return gImageCache;
+}
+
+static ImageRequest makeImageRequest(string path, double fixationX, double fixationY,
+  double scaleX, double scaleY, string backgroundColor)
+{
+  ImageRequest request;
+  request.path = path;
+  request.fixationX = fixationX;
+  request.fixationY = fixationY;
+  request.scaleX = scaleX;
+  request.scaleY = scaleY;
+  request.backgroundColor = backgroundColor;
+  return request;
+}
+
+int32_t native::queueImage(Napi::Env env, uint32_t frameCount, string path,
+  double fixationX, double fixationY, double scaleX, double scaleY,
+  string backgroundColor)
+{
+  // Make sure we've been initialized and are recording
+  if (!gInitialized)
   {
-    if (gPlaybackThread->isRunning())
-    {
-      gPlaybackThread->terminate();
-    }
-    gPlaybackThread = nullptr;
+    return -1;
   }
-  gPlaying = false;
+  if (!gRecording)
+  {
+    return -1;
+  }
+  uint8_t red, green, blue;
+  if ((frameCount == 0) || !color::parse(backgroundColor, red, green, blue))
+  {
+    return -1;
+  }
+  ImageRequest request = makeImageRequest(path, fixationX, fixationY, scaleX, scaleY,
+    backgroundColor);
+  return queueGenerator(shared_ptr<FrameGenerator>(new ImageGenerator(frameCount,
+    getImageCache(), request)));
+}
+
+string native::configureImageCache(Napi::Env env, int maxMegabytes, int workerCount)
+{
+  // Make sure we've been initialized
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if ((maxMegabytes <= 0) || (workerCount <= 0))
+  {
+    return "Invalid image cache configuration";
+  }
+
+  // Stimuli that were already queued keep using the previous cache until they're done
+  gImageCache = shared_ptr<ImageCache>(new ImageCache((uint64_t)maxMegabytes << 20,
+    workerCount));
   return "";
 }
 
-vector<uint32_t> native::getDisplayFrequencies(Napi::Env env, int32_t x, int32_t y)
+string native::prefetchImage(Napi::Env env, string path, double fixationX,
+  double fixationY, double scaleX, double scaleY, string backgroundColor)
 {
-  return platform::getDisplayFrequencies(x, y);
+  // Make sure we've been initialized and are recording so the frame size is known
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (!gRecording)
+  {
+    return "Recording is not in progress";
+  }
+  ImageRequest request = makeImageRequest(path, fixationX, fixationY, scaleX, scaleY,
+    backgroundColor);
+  string error;
+  if (!getImageCache()->prefetch(request, gWidth, gHeight, error))
+  {
+    return error;
+  }
+  return "";
+}
+
+void native::getImageCacheStatistics(Napi::Env env, uint32_t& hits, uint32_t& misses,
+  uint32_t& entries, uint64_t& bytes)
+{
+  getImageCache()->getStatistics(hits, misses, entries, bytes);
+}
+
+vector<int32_t> native::checkCompletedFrames(Napi::Env env)
+{
+  // Return an array of all frames that we're done with and free the associated memory
+  vector<int32_t> ret;
+  shared_ptr<FrameWrapper> wrapper;
+  while (gCompletedFrameQueue->waitItem(&wrapper, 0))
+  {
+    ret.push_back(wrapper->number);
+  }
+  return ret;
+}
+
+void native::closeVideoOutput(Napi::Env env)
+{
+  if (!gRecording)
+  {
+    return;
+  }
+  if (gGeneratorThread != nullptr)
+  {
+    if (gGeneratorThread->isRunning())
+    {
+      gGeneratorThread->terminate();
+    }
+    gGeneratorThread = nullptr;
+  }
+  if (gRecordThread != nullptr)
+  {
+    // Flushing ffmpeg, closing the record stages, and writing the seek index can take
+    // several seconds, so let the record thread do it in the background rather than
+    // wait here. It's never killed since that would leave its files truncated
+    pruneFinishingRecordThreads();
+    gRecordThread->finish();
+    gFinishingRecordThreads.push_back(gRecordThread);
+    gRecordThread = nullptr;
+  }
+  gStimulusBoundaries.clear();
+  gFrameArchivePath.clear();
+  gFrameStorePath.clear();
+  gLuminanceTrace = false;
+  gTensorExport = false;
+  gDryRun = false;
+  gRecording = false;
+}
+
+string native::markStimulusBoundary(Napi::Env env, uint32_t stimulusId, uint32_t frameNumber)
+{
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+
+  // Boundaries marked before the output is created become forced key frames. Once
+  // recording is underway they are passed straight to the record thread so they can
+  // still be included in the seek index
+  if (gRecording && (gRecordThread != nullptr))
+  {
+    gRecordThread->addStimulusBoundary(stimulusId, frameNumber);
+    if (gDryRunAnalyzer != nullptr)
+    {
+      gDryRunAnalyzer->addStimulusBoundary(stimulusId, frameNumber);
+    }
+  }
+  else
+  {
+    gStimulusBoundaries.push_back(make_pair(stimulusId, frameNumber));
+  }
+  return "";
+}
+
+string native::enableFrameArchive(Napi::Env env, string archivePath, string compression)
+{
+  // Make sure we've been initialized and the recording hasn't started yet
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gRecording)
+  {
+    return "Recording already in progress";
+  }
+  if (!framearchive::parseCompression(compression, gFrameArchiveCompression))
+  {
+    return "Unknown compression " + compression;
+  }
+  gFrameArchivePath = archivePath;
+  return "";
+}
+
+string native::enableFrameStore(Napi::Env env, string storePath, string runName,
+  string compression)
+{
+  // Make sure we've been initialized and the recording hasn't started yet
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gRecording)
+  {
+    return "Recording already in progress";
+  }
+  if (runName.empty() || (runName.find_first_of("/\\") != string::npos))
+  {
+    return "Invalid run name " + runName;
+  }
+  if (!framearchive::parseCompression(compression, gFrameStoreCompression))
+  {
+    return "Unknown compression " + compression;
+  }
+  gFrameStorePath = storePath;
+  gFrameStoreRunName = runName;
+  return "";
+}
+
+string native::collectFrameStore(Napi::Env env, string storePath, uint32_t& removedCount,
+  uint64_t& removedBytes, uint32_t& keptCount)
+{
+  // Collecting while recording could delete frames that the manifest hasn't
+  // referenced yet
+  if (gRecording)
+  {
+    return "Recording in progress";
+  }
+  joinFinishingRecordThreads();
+  string error;
+  if (!framestore::collectGarbage(storePath, removedCount, removedBytes, keptCount,
+    error))
+  {
+    return error;
+  }
+  return "";
+}
+
+string native::enableLuminanceTrace(Napi::Env env, string format, int gridRows,
+  int gridColumns)
+{
+  // Make sure we've been initialized and the recording hasn't started yet
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gRecording)
+  {
+    return "Recording already in progress";
+  }
+  if ((format != "csv") && (format != "binary"))
+  {
+    return "Unknown format " + format;
+  }
+  if ((gridRows < 0) || (gridColumns < 0) || ((gridRows == 0) != (gridColumns == 0)))
+  {
+    return "Invalid grid dimensions";
+  }
+  gLuminanceTrace = true;
+  gLuminanceTraceBinary = (format == "binary");
+  gLuminanceGridRows = gridRows;
+  gLuminanceGridColumns = gridColumns;
+  return "";
+}
+
+string native::enableTensorExport(Napi::Env env, int width, int height, string format,
+  int framesPerShard)
+{
+  // Make sure we've been initialized and the recording hasn't started yet
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gRecording)
+  {
+    return "Recording already in progress";
+  }
+  if ((format != "uint8") && (format != "float32"))
+  {
+    return "Unknown format " + format;
+  }
+  if ((width <= 0) || (height <= 0) || (framesPerShard <= 0))
+  {
+    return "Invalid tensor dimensions";
+  }
+  gTensorExport = true;
+  gTensorFloat = (format == "float32");
+  gTensorWidth = width;
+  gTensorHeight = height;
+  gTensorFramesPerShard = framesPerShard;
+  return "";
+}
+
+string native::enableDryRun(Napi::Env env, vector<int> gamutMin, vector<int> gamutMax)
+{
+  // Make sure we've been initialized and the recording hasn't started yet
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gRecording)
+  {
+    return "Recording already in progress";
+  }
+  if ((gamutMin.size() != 3) || (gamutMax.size() != 3))
+  {
+    return "Invalid gamut";
+  }
+  for (int i = 0; i < 3; ++i)
+  {
+    if ((gamutMin[i] < 0) || (gamutMax[i] > 255) || (gamutMin[i] > gamutMax[i]))
+    {
+      return "Invalid gamut";
+    }
+    gDryRunGamutMin[i] = (uint8_t)gamutMin[i];
+    gDryRunGamutMax[i] = (uint8_t)gamutMax[i];
+  }
+  gDryRun = true;
+  return "";
+}
+
+string native::getDryRunStatistics(Napi::Env env, DryRunSummary& program,
+  vector<DryRunSummary>& stimuli)
+{
+  // The statistics of the last dry run remain available after it has been closed
+  if (gDryRunAnalyzer == nullptr)
+  {
+    return "No dry run has been made";
+  }
+  gDryRunAnalyzer->getSummary(program, stimuli);
+  return "";
+}
+
+string native::loadGammaTable(Napi::Env env, string path, string target)
+{
+  // Make sure we've been initialized
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if ((target != "record") && (target != "playback"))
+  {
+    return "Unknown target " + target;
+  }
+
+  // An empty path removes the table. The table takes effect from the next recording or
+  // playback
+  shared_ptr<GammaTable> table(nullptr);
+  if (!path.empty())
+  {
+    string error;
+    table = GammaTable::load(path, error);
+    if (table == nullptr)
+    {
+      return error;
+    }
+    if (table->isIdentity())
+    {
+      table = nullptr;
+    }
+  }
+  if (target == "record")
+  {
+    gRecordGammaTable = table;
+  }
+  else
+  {
+    gPlaybackGammaTable = table;
+  }
+  return "";
+}
+
+string native::enableSyncPatch(Napi::Env env, string corner, int size, string mode,
+  bool simulate, double latencyMs, double jitterMs, double missRate, int seed)
+{
+  // Make sure we've been initialized
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (!SyncPatch::validate(corner, mode))
+  {
+    return "Unknown sync patch corner or mode";
+  }
+  if (size <= 0)
+  {
+    return "Invalid sync patch size";
+  }
+  if (simulate && ((latencyMs < 0) || (jitterMs < 0) || (missRate < 0) || (missRate > 1)))
+  {
+    return "Invalid sync simulation";
+  }
+
+  // The patch takes effect from the next playback. A null event source means the events
+  // come from the timing card
+  gSyncPatch = shared_ptr<SyncPatch>(new SyncPatch(corner, size, mode));
+  gSyncEventSource = nullptr;
+  if (simulate)
+  {
+    gSyncEventSource = shared_ptr<ExternalEventSource>(new SimulatedEventSource(latencyMs,
+      jitterMs, missRate, (uint32_t)seed));
+  }
+  return "";
+}
+
+string native::disableSyncPatch(Napi::Env env)
+{
+  gSyncPatch = nullptr;
+  gSyncEventSource = nullptr;
+  return "";
+}
+
+string native::getSyncStatistics(Napi::Env env, SyncStatistics& statistics)
+{
+  // The statistics of the last playback remain available after it has ended
+  if (gSyncTracker == nullptr)
+  {
+    return "No playback has used the sync patch";
+  }
+  statistics = gSyncTracker->getStatistics();
+  return "";
+}
+
+string native::enableFrameCode(Napi::Env env, string target, int x, int y, int cellSize,
+  int bits)
+{
+  // Make sure we've been initialized
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if ((target != "record") && (target != "playback"))
+  {
+    return "Unknown target " + target;
+  }
+  if ((x < 0) || (y < 0) || (cellSize <= 0) || (bits < 1) || (bits > 31))
+  {
+    return "Invalid frame code layout";
+  }
+
+  // The code takes effect from the next recording or playback
+  shared_ptr<FrameCode> frameCode(new FrameCode(x, y, cellSize, bits));
+  if (target == "record")
+  {
+    gRecordFrameCode = frameCode;
+  }
+  else
+  {
+    gPlaybackFrameCode = frameCode;
+  }
+  return "";
+}
+
+string native::disableFrameCode(Napi::Env env, string target)
+{
+  if (target == "record")
+  {
+    gRecordFrameCode = nullptr;
+  }
+  else if (target == "playback")
+  {
+    gPlaybackFrameCode = nullptr;
+  }
+  else
+  {
+    return "Unknown target " + target;
+  }
+  return "";
+}
+
+string native::decodeFrameCodes(Napi::Env env, vector<string> paths, double x, double y,
+  double cellWidth, double cellHeight, int bits, vector<int32_t>& numbers)
+{
+  if ((x < 0) || (y < 0) || (cellWidth <= 0) || (cellHeight <= 0) || (bits < 1) ||
+    (bits > 31))
+  {
+    return "Invalid frame code layout";
+  }
+
+  // Load and decode the images in parallel. Only the luminance is needed so the images
+  // are decoded straight to gray. An image that can't be read decodes to -1 like one
+  // without a readable code
+  numbers.assign(paths.size(), -1);
+  parallel_for_(Range(0, (int)paths.size()), [&](const Range& range)
+  {
+    for (int i = range.start; i < range.end; ++i)
+    {
+      Mat image = imread(paths[i], IMREAD_GRAYSCALE);
+      if (!image.empty())
+      {
+        numbers[i] = (int32_t)FrameCode::decode(image, x, y, cellWidth, cellHeight,
+          bits);
+      }
+    }
+  });
+  return "";
+}
+
+string native::benchmarkFrameArchive(Napi::Env env, string archivePath, int width,
+  int height, int frameCount, string compression, double& writeMBps, double& readMBps,
+  double& compressionRatio)
+{
+  uint32_t codec;
+  if (!framearchive::parseCompression(compression, codec))
+  {
+    return "Unknown compression " + compression;
+  }
+  if ((width <= 0) || (height <= 0) || (frameCount <= 0))
+  {
+    return "Invalid benchmark dimensions";
+  }
+
+  // Generate a set of drifting square-wave grating frames that resemble typical
+  // stimuli. They are created up front so only the archive is measured
+  size_t frameLength = (size_t)width * height * 4;
+  vector<vector<uint8_t>> frames(8, vector<uint8_t>(frameLength));
+  for (uint32_t i = 0; i < frames.size(); ++i)
+  {
+    uint8_t* pixel = frames[i].data();
+    for (int row = 0; row < height; ++row)
+    {
+      for (int col = 0; col < width; ++col, pixel += 4)
+      {
+        uint8_t value = (((col + i * 8) / 32) % 2) ? 255 : 0;
+        pixel[0] = value;
+        pixel[1] = value;
+        pixel[2] = value;
+        pixel[3] = 255;
+      }
+    }
+  }
+
+  // Measure writer throughput
+  string error;
+  FrameArchiveWriter writer(archivePath, codec);
+  auto writeStart = chrono::steady_clock::now();
+  if (!writer.open(width, height, 60, error))
+  {
+    return error;
+  }
+  for (int i = 0; i < frameCount; ++i)
+  {
+    shared_ptr<FrameWrapper> wrapper(new FrameWrapper(i));
+    if (!writer.processFrame(wrapper, frames[i % frames.size()].data(), frameLength,
+      error))
+    {
+      writer.close(error);
+      return error;
+    }
+  }
+  if (!writer.close(error))
+  {
+    return error;
+  }
+  double writeSec = chrono::duration<double>(chrono::steady_clock::now() -
+    writeStart).count();
+
+  // Measure reader throughput
+  vector<uint8_t> frame(frameLength);
+  FrameArchiveReader reader(archivePath, true);
+  auto readStart = chrono::steady_clock::now();
+  if (!reader.open(error))
+  {
+    return error;
+  }
+  for (int i = 0; i < frameCount; ++i)
+  {
+    if (!reader.readFrame(i, frame.data(), error))
+    {
+      return error;
+    }
+  }
+  double readSec = chrono::duration<double>(chrono::steady_clock::now() -
+    readStart).count();
+
+  // Verify every frame reads back bit-exact
+  for (int i = 0; i < frameCount; ++i)
+  {
+    if (!reader.readFrame(i, frame.data(), error))
+    {
+      return error;
+    }
+    if (memcmp(frame.data(), frames[i % frames.size()].data(), frameLength) != 0)
+    {
+      return "Frame " + to_string(i) + " did not match after reading";
+    }
+  }
+  reader.close();
+  remove(archivePath.c_str());
+
+  double totalMB = (double)frameLength * frameCount / 1000000.0;
+  writeMBps = totalMB / writeSec;
+  readMBps = totalMB / readSec;
+  compressionRatio = (double)frameLength * frameCount / (double)writer.getBytesWritten();
+  return "";
+}
+
+string native::beginVideoPlayback(Napi::Env env, int32_t x, int32_t y,
+  vector<string> videos, bool scaleToFit, wrapper::JsCallback* durationCallback,
+  wrapper::JsCallback* positionCallback, wrapper::JsCallback* delayCallback,
+  int32_t startVideo, int32_t startFrame, int64_t startTimeMs)
+{
+  // Make sure we've been initialized and aren't currently playing
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gPlaying)
+  {
+    return "Playback already in progress";
+  }
+  if ((gPlaybackPrepareThread != nullptr) && gPlaybackPrepareThread->isRunning())
+  {
+    return "Playback preparation in progress";
+  }
+  if ((startVideo < 0) || (startFrame < 0))
+  {
+    return "Invalid start position";
+  }
+
+  // Spawn the playback thread that will create the ffmpeg processes, read the
+  // frames as they are decoded, and store then in the pending frames queue
+  gPlaybackThread = shared_ptr<PlaybackThread>(new PlaybackThread(x, y,
+    videos, scaleToFit, gFfmpegPath, gFfprobePath, gLogCallback,
+    durationCallback, positionCallback, delayCallback));
+  gPlaybackThread->setGammaTable(gPlaybackGammaTable);
+  gPlaybackThread->setFrameCode(gPlaybackFrameCode);
+  gPlaybackThread->setDecoderLookahead(gDecoderLookahead);
+  gPlaybackThread->setBufferBytes((uint64_t)gPlaybackBufferMegabytes << 20);
+  gPlaybackThread->setDecodeToDisplay(gDecodeToDisplay);
+  gPlaybackThread->setStarvationPolicy(gStarvationPolicy);
+  gPlaybackThread->setPresentationLogPath(gPresentationLogPath);
+  gPlaybackThread->setStartPosition(startVideo, startFrame, startTimeMs);
+  gPlaybackThread->setProbeCache(gProbeCache);
+  gPlaybackThread->setPlaybackCache(gPlaybackCache);
+  if (gSyncPatch != nullptr)
+  {
+    gSyncTracker = shared_ptr<SyncTracker>(new SyncTracker(gSyncPatch, gSyncEventSource));
+    gPlaybackThread->setSyncTracker(gSyncTracker);
+  }
+  gPlaybackThread->spawn();
+
+  gPlaying = true;
+  return "";
+}
+
+string native::endVideoPlayback(Napi::Env env)
+{
+  if (!gPlaying)
+  {
+    return "";
+  }
+  if (gPlaybackThread != nullptr)
+  {
+    if (gPlaybackThread->isRunning())
+    {
+      gPlaybackThread->terminate();
+    }
+    gPlaybackThread = nullptr;
+  }
+  gPlaying = false;
+  return "";
+}
+
+string native::setDecoderLookahead(Napi::Env env, int videoCount)
+{
+  // Each video decoded ahead of time holds a second of frames
+  if ((videoCount < 0) || (videoCount > MAX_DECODER_LOOKAHEAD))
+  {
+    return "Invalid decoder lookahead";
+  }
+  gDecoderLookahead = videoCount;
+  return "";
+}
+
+string native::setPlaybackBufferSize(Napi::Env env, int maxMegabytes)
+{
+  if (maxMegabytes <= 0)
+  {
+    return "Invalid playback buffer size";
+  }
+  gPlaybackBufferMegabytes = maxMegabytes;
+  return "";
+}
+
+string native::setDecodeToDisplay(Napi::Env env, bool enabled)
+{
+  gDecodeToDisplay = enabled;
+  return "";
+}
+
+string native::setStarvationPolicy(Napi::Env env, string policy)
+{
+  if (!ProjectorThread::parseStarvationPolicy(policy, gStarvationPolicy))
+  {
+    return "Unknown starvation policy " + policy;
+  }
+  return "";
+}
+
+string native::setPresentationLogPath(Napi::Env env, string path)
+{
+  if (gPlaying)
+  {
+    return "Playback is in progress";
+  }
+  gPresentationLogPath = path;
+  return "";
+}
+
+string native::exportPresentationLog(Napi::Env env, string logPath, string outputPath)
+{
+  string error;
+  if (!presentationlog::exportLog(logPath, outputPath, error))
+  {
+    return error;
+  }
+  return "";
+}
+
+string native::setProbeCachePath(Napi::Env env, string path)
+{
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gPlaying)
+  {
+    return "Playback is in progress";
+  }
+
+  // An empty path turns the cache off. A missing or unreadable cache file is treated as
+  // empty and replaced the next time videos are probed
+  if (path.empty())
+  {
+    gProbeCache = nullptr;
+    return "";
+  }
+  gProbeCache = shared_ptr<ProbeCache>(new ProbeCache(path));
+  gProbeCache->load();
+  return "";
+}
+
+string native::setPlaybackCache(Napi::Env env, string directory, int maxMegabytes)
+{
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gPlaying)
+  {
+    return "Playback is in progress";
+  }
+  if ((gPlaybackPrepareThread != nullptr) && gPlaybackPrepareThread->isRunning())
+  {
+    return "Playback preparation in progress";
+  }
+
+  // An empty directory turns the cache off
+  if (directory.empty())
+  {
+    gPlaybackCache = nullptr;
+    return "";
+  }
+  if (maxMegabytes <= 0)
+  {
+    return "Invalid playback cache size";
+  }
+  shared_ptr<PlaybackCache> playbackCache(new PlaybackCache(directory,
+    (uint64_t)maxMegabytes << 20));
+  string error;
+  if (!playbackCache->open(error))
+  {
+    return error;
+  }
+  gPlaybackCache = playbackCache;
+  return "";
+}
+
+string native::beginPlaybackPreparation(Napi::Env env, vector<string> videos,
+  string compression, wrapper::JsCallback* progressCallback)
+{
+  // Make sure we've been initialized, have a cache, and aren't playing or already
+  // preparing since either could be using the archives that preparation may evict
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if (gPlaybackCache == nullptr)
+  {
+    return "Playback cache has not been set";
+  }
+  if (gPlaying)
+  {
+    return "Playback is in progress";
+  }
+  if ((gPlaybackPrepareThread != nullptr) && gPlaybackPrepareThread->isRunning())
+  {
+    return "Playback preparation already in progress";
+  }
+  uint32_t archiveCompression;
+  if (!framearchive::parseCompression(compression, archiveCompression))
+  {
+    return "Unknown compression " + compression;
+  }
+
+  // Spawn the thread that decodes each video into the cache
+  gPlaybackPrepareThread = shared_ptr<PlaybackPrepareThread>(new PlaybackPrepareThread(
+    videos, gFfmpegPath, gFfprobePath, gPlaybackCache, archiveCompression, gLogCallback,
+    progressCallback));
+  gPlaybackPrepareThread->spawn();
+  return "";
+}
+
+void native::endPlaybackPreparation(Napi::Env env)
+{
+  if (gPlaybackPrepareThread != nullptr)
+  {
+    if (gPlaybackPrepareThread->isRunning())
+    {
+      gPlaybackPrepareThread->terminate();
+    }
+    gPlaybackPrepareThread = nullptr;
+  }
+}
+
+vector<uint32_t> native::getDisplayFrequencies(Napi::Env env, int32_t x, int32_t y)
+{
+  return platform::getDisplayFrequencies(x, y);
+}
+
+string native::benchmarkVideoDecode(Napi::Env env, string rawPath, int width, int height,
+  uint32_t& frameCount, double& framesPerSecond, double& megabytesPerSecond)
+{
+  // Make sure we've been initialized
+  if (!gInitialized)
+  {
+    return "Library has not been initialized";
+  }
+  if ((width <= 0) || (height <= 0))
+  {
+    return "Invalid benchmark dimensions";
+  }
+  size_t frameLength = (size_t)width * height * 4;
+  uint64_t fileSize = 0, modifiedTimeUsec;
+  if (!platform::getFileInfo(rawPath, fileSize, modifiedTimeUsec) ||
+    (fileSize < frameLength))
+  {
+    return "Failed to find frames in " + rawPath;
+  }
+
+  // Pass the raw BGRA frames through ffmpeg and the frame reader exactly as playback
+  // does and release each frame as soon as it arrives
+  shared_ptr<FramePool> framePool(new FramePool(frameLength, 8));
+  shared_ptr<Queue<shared_ptr<FrameWrapper>>> frameQueue(
+    new Queue<shared_ptr<FrameWrapper>>());
+  FfmpegPlaybackProcess ffmpegProcess(gFfmpegPath, rawPath, width, height, framePool,
+    frameQueue, true);
+  auto start = chrono::steady_clock::now();
+  auto lastFrame = start;
+  ffmpegProcess.spawn();
+  frameCount = 0;
+  while (true)
+  {
+    // Block until the next frame arrives and only check whether decoding is over once
+    // the queue has been idle for a while. The time is taken at the last frame so the
+    // idle wait isn't measured
+    shared_ptr<FrameWrapper> wrapper;
+    if (frameQueue->waitItem(&wrapper, BENCHMARK_IDLE_MS))
+    {
+      lastFrame = chrono::steady_clock::now();
+      frameCount += 1;
+      continue;
+    }
+    if (ffmpegProcess.isDecodingFinished() && frameQueue->empty())
+    {
+      break;
+    }
+  }
+  double seconds = chrono::duration<double>(lastFrame - start).count();
+  if (ffmpegProcess.isRunning())
+  {
+    ffmpegProcess.waitForExit();
+  }
+  if (frameCount != fileSize / frameLength)
+  {
+    return "Expected " + to_string(fileSize / frameLength) + " frames but read " +
+      to_string(frameCount);
+  }
+  framesPerSecond = frameCount / seconds;
+  megabytesPerSecond = (double)frameLength * frameCount / 1000000.0 / seconds;
+  return "";
 }
 
 string native::createPreviewChannel(Napi::Env env, string& channelName)
@@ -3,6 +3,8 @@
 
 #include <napi.h>
 #include <vector>
+#include "DryRunAnalyzer.h"
+#include "SyncTracker.h"
 #include "Wrapper.h"
 
 namespace native
@@ -14,15 +16,90 @@ namespace native
     std::string outputPath);
   int32_t queueNextFrame(Napi::Env env, uint8_t* frame, size_t length, int width,
     int height);
+  int32_t queueWhiteNoise(Napi::Env env, uint32_t frameCount, uint32_t rows,
+    uint32_t columns, bool color, uint32_t seed);
+  int32_t queueGrating(Napi::Env env, uint32_t frameCount, bool sinusoidal, double speed,
+    double barWidth, double angle, std::string barColor, std::string backgroundColor);
+  int32_t queueChirp(Napi::Env env, uint32_t frameCount, double f0, double f1, double a0,
+    double a1, double t1, double phi);
+  int32_t queueSolid(Napi::Env env, uint32_t frameCount, std::string color);
+  int32_t queueCheckerboard(Napi::Env env, uint32_t frameCount, std::string color,
+    std::string alternateColor, double size, double angle);
+  int32_t queueBar(Napi::Env env, uint32_t frameCount, double speed, double barWidth,
+    double angle, std::string barColor, std::string backgroundColor);
+  int32_t queueLetter(Napi::Env env, uint32_t frameCount, std::string letter, double x,
+    double y, double size, std::string color, std::string backgroundColor);
+  int32_t queueTiledLetter(Napi::Env env, uint32_t frameCount, std::string letter,
+    double size, double padding, std::string color, double angle,
+    std::string backgroundColor);
+  int32_t queueEyeChart(Napi::Env env, uint32_t frameCount,
+    std::vector<std::string> letterMatrix, double size, double padding,
+    std::string color, std::string backgroundColor);
+  std::string queueStimuli(Napi::Env env, std::string batchJson,
+    std::vector<int32_t>& firstFrameIds, std::string& stopReason);
+  int32_t countNativeStimuli(Napi::Env env, std::string batchJson, uint32_t fps);
+  std::string setNativeLetters(Napi::Env env, bool enabled);
+  int32_t queueImage(Napi::Env env, uint32_t frameCount, std::string path,
+    double fixationX, double fixationY, double scaleX, double scaleY,
+    std::string backgroundColor);
+  std::string configureImageCache(Napi::Env env, int maxMegabytes, int workerCount);
+  std::string prefetchImage(Napi::Env env, std::string path, double fixationX,
+    double fixationY, double scaleX, double scaleY, std::string backgroundColor);
+  void getImageCacheStatistics(Napi::Env env, uint32_t& hits, uint32_t& misses,
+    uint32_t& entries, uint64_t& bytes);
   std::vector<int32_t> checkCompletedFrames(Napi::Env env);
   void closeVideoOutput(Napi::Env env);
+  std::string markStimulusBoundary(Napi::Env env, uint32_t stimulusId, uint32_t frameNumber);
+  std::string enableFrameArchive(Napi::Env env, std::string archivePath,
+    std::string compression);
+  std::string enableFrameStore(Napi::Env env, std::string storePath, std::string runName,
+    std::string compression);
+  std::string collectFrameStore(Napi::Env env, std::string storePath,
+    uint32_t& removedCount, uint64_t& removedBytes, uint32_t& keptCount);
+  std::string enableLuminanceTrace(Napi::Env env, std::string format, int gridRows,
+    int gridColumns);
+  std::string enableTensorExport(Napi::Env env, int width, int height, std::string format,
+    int framesPerShard);
+  std::string enableDryRun(Napi::Env env, std::vector<int> gamutMin,
+    std::vector<int> gamutMax);
+  std::string getDryRunStatistics(Napi::Env env, DryRunSummary& program,
+    std::vector<DryRunSummary>& stimuli);
+  std::string loadGammaTable(Napi::Env env, std::string path, std::string target);
+  std::string enableSyncPatch(Napi::Env env, std::string corner, int size, std::string mode,
+    bool simulate, double latencyMs, double jitterMs, double missRate, int seed);
+  std::string disableSyncPatch(Napi::Env env);
+  std::string getSyncStatistics(Napi::Env env, SyncStatistics& statistics);
+  std::string enableFrameCode(Napi::Env env, std::string target, int x, int y, int cellSize,
+    int bits);
+  std::string disableFrameCode(Napi::Env env, std::string target);
+  std::string decodeFrameCodes(Napi::Env env, std::vector<std::string> paths, double x,
+    double y, double cellWidth, double cellHeight, int bits,
+    std::vector<int32_t>& numbers);
+  std::string benchmarkFrameArchive(Napi::Env env, std::string archivePath, int width,
+    int height, int frameCount, std::string compression, double& writeMBps,
+    double& readMBps, double& compressionRatio);
 
   std::string beginVideoPlayback(Napi::Env env, int32_t x, int32_t y,
     std::vector<std::string> videos, bool scaleToFit,
     wrapper::JsCallback* durationCallback, wrapper::JsCallback* positionCallback,
-    wrapper::JsCallback* delayCallback);
+    wrapper::JsCallback* delayCallback, int32_t startVideo, int32_t startFrame,
+    int64_t startTimeMs);
   std::string endVideoPlayback(Napi::Env env);
+  std::string setDecoderLookahead(Napi::Env env, int videoCount);
+  std::string setPlaybackBufferSize(Napi::Env env, int maxMegabytes);
+  std::string setDecodeToDisplay(Napi::Env env, bool enabled);
+  std::string setStarvationPolicy(Napi::Env env, std::string policy);
+  std::string setPresentationLogPath(Napi::Env env, std::string path);
+  std::string exportPresentationLog(Napi::Env env, std::string logPath,
+    std::string outputPath);
+  std::string setProbeCachePath(Napi::Env env, std::string path);
+  std::string setPlaybackCache(Napi::Env env, std::string directory, int maxMegabytes);
+  std::string beginPlaybackPreparation(Napi::Env env, std::vector<std::string> videos,
+    std::string compression, wrapper::JsCallback* progressCallback);
+  void endPlaybackPreparation(Napi::Env env);
   std::vector<uint32_t> getDisplayFrequencies(Napi::Env env, int32_t x, int32_t y);
+  std::string benchmarkVideoDecode(Napi::Env env, std::string rawPath, int width,
+    int height, uint32_t& frameCount, double& framesPerSecond, double& megabytesPerSecond);
 
   std::string createPreviewChannel(Napi::Env env, std::string& channelName);
   std::string openPreviewChannel(Napi::Env env, std::string name);
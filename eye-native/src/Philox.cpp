@@ -0,0 +1,55 @@
+#include "Philox.h"
+
+// Multipliers and key increments from the reference implementation
+#define PHILOX_M0 0xD2511F53
+#define PHILOX_M1 0xCD9E8D57
+#define PHILOX_W0 0x9E3779B9
+#define PHILOX_W1 0xBB67AE85
+
+// Number of rounds. Ten is the smallest count that passes BigCrush with a safety margin
+#define PHILOX_ROUNDS 10
+
+void philox::generate(const uint32_t counter[4], const uint32_t key[2],
+  uint32_t output[4])
+{
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < PHILOX_ROUNDS; ++round)
+  {
+    uint64_t product0 = (uint64_t)PHILOX_M0 * c0;
+    uint64_t product1 = (uint64_t)PHILOX_M1 * c2;
+    uint32_t hi0 = (uint32_t)(product0 >> 32), lo0 = (uint32_t)product0;
+    uint32_t hi1 = (uint32_t)(product1 >> 32), lo1 = (uint32_t)product1;
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  output[0] = c0;
+  output[1] = c1;
+  output[2] = c2;
+  output[3] = c3;
+}
+
+void philox::generateLanes(uint32_t* word0, uint32_t* word1, uint32_t* word2,
+  uint32_t* word3, const uint32_t key[2], uint32_t count)
+{
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < PHILOX_ROUNDS; ++round)
+  {
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      uint64_t product0 = (uint64_t)PHILOX_M0 * word0[i];
+      uint64_t product1 = (uint64_t)PHILOX_M1 * word2[i];
+      uint32_t c1 = word1[i], c3 = word3[i];
+      word0[i] = (uint32_t)(product1 >> 32) ^ c1 ^ k0;
+      word1[i] = (uint32_t)product1;
+      word2[i] = (uint32_t)(product0 >> 32) ^ c3 ^ k1;
+      word3[i] = (uint32_t)product0;
+    }
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// These functions implement the Philox4x32-10 counter-based random number generator
+// (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"). Each call maps a 128-bit
+// counter and a 64-bit key to four independent 32-bit random values, so any random value
+// in a stimulus can be computed directly from its position. This makes generated frames
+// reproducible from a seed and lets them be rendered in any order on any thread.
+
+namespace philox
+{
+  // Computes four random values from the counter and key
+  void generate(const uint32_t counter[4], const uint32_t key[2], uint32_t output[4]);
+
+  // Does the same for a run of counters whose four words are held in separate arrays,
+  // replacing each counter with its output. Each round is applied to every counter
+  // before the next so the compiler can spread the counters across vector lanes
+  void generateLanes(uint32_t* word0, uint32_t* word1, uint32_t* word2, uint32_t* word3,
+    const uint32_t key[2], uint32_t count);
+
+  // Converts a random value to a float that is strictly between 0 and 1
+  inline float toUniform(uint32_t value)
+  {
+    return ((value >> 8) + 0.5f) * (1.0f / 16777216.0f);
+  }
+}
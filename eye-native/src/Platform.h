@@ -33,12 +33,32 @@ namespace platform
   int32_t write(uint64_t file, const uint8_t* buffer, uint32_t length);
   void close(uint64_t file);
 
+  bool mapFile(std::string path, bool sequential, const uint8_t*& data,
+    uint64_t& length, uint64_t& mapId);
+  bool mapFileForWriting(std::string path, uint64_t length, uint8_t*& data,
+    uint64_t& mapId);
+  void unmapFile(const uint8_t* data, uint64_t length, uint64_t mapId);
+  bool truncateFile(std::string path, uint64_t length);
+
+  bool createDirectory(std::string path);
+  bool listDirectory(std::string path, std::vector<std::string>& entries);
+  bool getFileInfo(std::string path, uint64_t& size, uint64_t& modifiedTimeUsec);
+  bool renameFile(std::string oldPath, std::string newPath);
+  bool deleteFile(std::string path);
+
+  // Takes an advisory lock on the file, creating it if necessary, without waiting. Any
+  // number of processes can hold a shared lock at once but an exclusive lock excludes
+  // all others. The lock is released by unlockFile() or when the process exits
+  bool lockFile(std::string path, bool exclusive, uint64_t& lockId);
+  void unlockFile(uint64_t lockId);
+
   std::vector<uint32_t> getDisplayFrequencies(int32_t x, int32_t y);
+  bool getDisplaySize(int32_t x, int32_t y, uint32_t& width, uint32_t& height);
 
   bool createProjectorWindow(uint32_t x, uint32_t y, bool scaleToFit,
     uint32_t refreshRate, std::string& error);
   bool displayVideoFrame(std::shared_ptr<FrameWrapper> wrapper, uint64_t& timestamp,
-    int32_t& delayMs, std::string& error);
+    std::string& error);
   bool displayCalibrationFrame(bool whiteFrame, uint64_t& timestamp,
     std::string& error);
   void destroyProjectorWindow();
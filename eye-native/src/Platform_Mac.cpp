@@ -1,9 +1,12 @@
 #include "Platform.h"
 #include <crt_externs.h>
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -260,6 +263,141 @@ void platform::close(uint64_t file)
   ::close((int)file);
 }
 
+bool platform::mapFile(string path, bool sequential, const uint8_t*& data,
+  uint64_t& length, uint64_t& mapId)
+{
+  int file = open(path.c_str(), O_RDONLY);
+  if (file == -1)
+  {
+    return false;
+  }
+  struct stat fileStat;
+  if ((fstat(file, &fileStat) == -1) || (fileStat.st_size == 0))
+  {
+    ::close(file);
+    return false;
+  }
+
+  // The mapping remains valid after the file descriptor is closed
+  void* mapping = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, file, 0);
+  ::close(file);
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+  madvise(mapping, (size_t)fileStat.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+  data = (const uint8_t*)mapping;
+  length = (uint64_t)fileStat.st_size;
+  mapId = 0;
+  return true;
+}
+
+bool platform::mapFileForWriting(string path, uint64_t length, uint8_t*& data,
+  uint64_t& mapId)
+{
+  // Create the file at its full length and map it
+  int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file == -1)
+  {
+    return false;
+  }
+  if (ftruncate(file, (off_t)length) == -1)
+  {
+    ::close(file);
+    return false;
+  }
+  void* mapping = mmap(nullptr, (size_t)length, PROT_READ | PROT_WRITE, MAP_SHARED, file,
+    0);
+  ::close(file);
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+  data = (uint8_t*)mapping;
+  mapId = 0;
+  return true;
+}
+
+void platform::unmapFile(const uint8_t* data, uint64_t length, uint64_t mapId)
+{
+  munmap((void*)data, (size_t)length);
+}
+
+bool platform::truncateFile(string path, uint64_t length)
+{
+  return (truncate(path.c_str(), (off_t)length) == 0);
+}
+
+bool platform::createDirectory(string path)
+{
+  return ((mkdir(path.c_str(), 0755) == 0) || (errno == EEXIST));
+}
+
+bool platform::listDirectory(string path, vector<string>& entries)
+{
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr)
+  {
+    return false;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr)
+  {
+    string name = entry->d_name;
+    if ((name != ".") && (name != ".."))
+    {
+      entries.push_back(name);
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+bool platform::getFileInfo(string path, uint64_t& size, uint64_t& modifiedTimeUsec)
+{
+  struct stat fileStat;
+  if (stat(path.c_str(), &fileStat) == -1)
+  {
+    return false;
+  }
+  size = (uint64_t)fileStat.st_size;
+  modifiedTimeUsec = (uint64_t)fileStat.st_mtimespec.tv_sec * 1000000 +
+    (uint64_t)fileStat.st_mtimespec.tv_nsec / 1000;
+  return true;
+}
+
+bool platform::renameFile(string oldPath, string newPath)
+{
+  return (rename(oldPath.c_str(), newPath.c_str()) == 0);
+}
+
+bool platform::deleteFile(string path)
+{
+  return (unlink(path.c_str()) == 0);
+}
+
+bool platform::lockFile(string path, bool exclusive, uint64_t& lockId)
+{
+  int file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (file == -1)
+  {
+    return false;
+  }
+  if (flock(file, (exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB) == -1)
+  {
+    ::close(file);
+    return false;
+  }
+  lockId = (uint64_t)file;
+  return true;
+}
+
+void platform::unlockFile(uint64_t lockId)
+{
+  // Closing the file releases the lock
+  ::close((int)lockId);
+}
+
 // All remaining platform functions use dummy implementations on Mac
 vector<uint32_t> platform::getDisplayFrequencies(int32_t x, int32_t y)
 {
@@ -269,16 +407,24 @@ vector<uint32_t> platform::getDisplayFrequencies(int32_t x, int32_t y)
   return dummy;
 }
 
+bool platform::getDisplaySize(int32_t x, int32_t y, uint32_t& width, uint32_t& height)
+{
+  width = 1920;
+  height = 1080;
+  return true;
+}
+
 bool platform::createProjectorWindow(uint32_t x, uint32_t y, bool scaleToFit,
   uint32_t refreshRate, string& error)
 {
   return true;
 }
 bool platform::displayVideoFrame(shared_ptr<FrameWrapper> wrapper, uint64_t& timestamp,
-  int32_t& delayMs, string& error)
+  string& error)
 {
   uint32_t sleepMs = (uint32_t)(1000.0 / wrapper->fps);
   platform::sleep(sleepMs);
+  timestamp = platform::readTimestampUsec();
   return true;
 }
 
@@ -36,15 +36,6 @@ private:
   ComPtr<ID2D1Factory> d2dFactory;
   ComPtr<ID2D1RenderTarget> d2dRenderTarget;
 
-  // The playback position in milliseconds that we should be at if we haven't experienced
-  // any frame starvation, i.e. if there are no delays between calls to displayFrame()
-  double targetPlaybackPositionMs;
-
-  // The time when the first frame was presented in microseconds. This will be combined with
-  // the current time to detect if frame starvation has occurred by comparing to the target
-  // playback position
-  uint64_t firstFrameTimestampUsec;
-
 public:
   ProjectorWindow() {};
   virtual ~ProjectorWindow() {};
@@ -137,10 +128,6 @@ public:
     {
       dxgiSwapChain->SetFullscreenState(true, nullptr);
     }
-
-    // Reset the playback variables
-    targetPlaybackPositionMs = 0;
-    firstFrameTimestampUsec = 0;
     return true;
   }
 
@@ -172,7 +159,7 @@ public:
     d2dRenderTarget = nullptr;
   }
 
-  bool displayVideoFrame(shared_ptr<FrameWrapper> frame, uint64_t& timestamp, int32_t& delayMs, string& error)
+  bool displayVideoFrame(shared_ptr<FrameWrapper> frame, uint64_t& timestamp, string& error)
   {
     // Hack: Check the current refresh rate and blow up if it doesn't match our target. We shouldn't
     // have to do this--we should switch the projector to the correct refresh rate, preferrably during
@@ -207,9 +194,14 @@ public:
 
     /* Step 1: Draw the frame to the back buffer */
 
-    // Start with a solid black background
+    // Start with a solid black background unless the frame was decoded to cover the
+    // whole window, in which case it's copied across as is
+    bool fullWindow = (frame->nativeWidth == width) && (frame->nativeHeight == height);
     d2dRenderTarget->BeginDraw();
-    d2dRenderTarget->Clear(D2D1::ColorF(0, 0, 0, 1));
+    if (!fullWindow)
+    {
+      d2dRenderTarget->Clear(D2D1::ColorF(0, 0, 0, 1));
+    }
 
     // Create a bitmap from the raw frame pixels
     D2D1_BITMAP_PROPERTIES bitmapProperties;
@@ -239,8 +231,9 @@ public:
       destRectangle.bottom = destRectangle.top + frame->nativeHeight;
     }
     D2D1_RECT_F srcRectangle = D2D1::RectF(0, 0, frame->nativeWidth, frame->nativeHeight);
-    d2dRenderTarget->DrawBitmap(bitmap.Get(), &destRectangle, 1.0,
-      D2D1_BITMAP_INTERPOLATION_MODE_LINEAR, &srcRectangle);
+    d2dRenderTarget->DrawBitmap(bitmap.Get(), &destRectangle, 1.0, fullWindow ?
+      D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR : D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+      &srcRectangle);
     if (FAILED(d2dRenderTarget->EndDraw()))
     {
       error = "Failed to draw to context";
@@ -262,25 +255,7 @@ public:
     }
     timestamp = platform::readTimestampUsec();
 
-    /* Step 3: Calculate any culmulative delay in the video playback */
-
-    // Measure the actual playback position and use it to calculate any delay caused by
-    // frame starvation
-    if (firstFrameTimestampUsec == 0)
-    {
-      firstFrameTimestampUsec = timestamp;
-    }
-    double actualPlaybackPositionMs = (double)(timestamp - firstFrameTimestampUsec) / 1000;
-    delayMs = (int32_t)(actualPlaybackPositionMs - targetPlaybackPositionMs);
-
-    // Update the target playback position, a value that won't actually be valid until the next
-    // vertical sync
-    if (frame->fps != 0)
-    {
-      targetPlaybackPositionMs += 1000 / (double)frame->fps;
-    }
-
-    /* Step 4: Wait for additional vsync signals */
+    /* Step 3: Wait for additional vsync signals */
 
     // Calculate the number of vsync signals this frame should be displayed for
     uint32_t syncInterval = 1;
@@ -678,6 +653,177 @@ void platform::close(uint64_t file)
   CloseHandle((HANDLE)file);
 }
 
+bool platform::mapFile(string path, bool sequential, const uint8_t*& data,
+  uint64_t& length, uint64_t& mapId)
+{
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+    OPEN_EXISTING, sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS,
+    nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(hFile, &fileSize) || (fileSize.QuadPart == 0))
+  {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  // The mapping object keeps the file open so its handle can be closed right away
+  HANDLE hMapping = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(hFile);
+  if (hMapping == nullptr)
+  {
+    fprintf(stderr, "[Platform_Win] ERROR: Failed to create file mapping (%i)\n", GetLastError());
+    return false;
+  }
+  void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr)
+  {
+    fprintf(stderr, "[Platform_Win] ERROR: Failed to map view of file (%i)\n", GetLastError());
+    CloseHandle(hMapping);
+    return false;
+  }
+  data = (const uint8_t*)view;
+  length = (uint64_t)fileSize.QuadPart;
+  mapId = (uint64_t)hMapping;
+  return true;
+}
+
+bool platform::mapFileForWriting(string path, uint64_t length, uint8_t*& data,
+  uint64_t& mapId)
+{
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+    CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  // Creating the mapping with an explicit size extends the file to that length
+  HANDLE hMapping = CreateFileMapping(hFile, nullptr, PAGE_READWRITE,
+    (DWORD)(length >> 32), (DWORD)(length & 0xFFFFFFFF), nullptr);
+  CloseHandle(hFile);
+  if (hMapping == nullptr)
+  {
+    fprintf(stderr, "[Platform_Win] ERROR: Failed to create file mapping (%i)\n", GetLastError());
+    return false;
+  }
+  void* view = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, 0);
+  if (view == nullptr)
+  {
+    fprintf(stderr, "[Platform_Win] ERROR: Failed to map view of file (%i)\n", GetLastError());
+    CloseHandle(hMapping);
+    return false;
+  }
+  data = (uint8_t*)view;
+  mapId = (uint64_t)hMapping;
+  return true;
+}
+
+void platform::unmapFile(const uint8_t* data, uint64_t length, uint64_t mapId)
+{
+  UnmapViewOfFile(data);
+  CloseHandle((HANDLE)mapId);
+}
+
+bool platform::truncateFile(string path, uint64_t length)
+{
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER position;
+  position.QuadPart = (LONGLONG)length;
+  bool success = (SetFilePointerEx(hFile, position, nullptr, FILE_BEGIN) &&
+    SetEndOfFile(hFile));
+  CloseHandle(hFile);
+  return success;
+}
+
+bool platform::createDirectory(string path)
+{
+  return (CreateDirectoryA(path.c_str(), nullptr) ||
+    (GetLastError() == ERROR_ALREADY_EXISTS));
+}
+
+bool platform::listDirectory(string path, vector<string>& entries)
+{
+  WIN32_FIND_DATAA findData;
+  HANDLE hFind = FindFirstFileA((path + "\\*").c_str(), &findData);
+  if (hFind == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  do
+  {
+    string name = findData.cFileName;
+    if ((name != ".") && (name != ".."))
+    {
+      entries.push_back(name);
+    }
+  } while (FindNextFileA(hFind, &findData));
+  FindClose(hFind);
+  return true;
+}
+
+bool platform::getFileInfo(string path, uint64_t& size, uint64_t& modifiedTimeUsec)
+{
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+  if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+  {
+    return false;
+  }
+  size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+
+  // Convert from 100 ns intervals since 1601 to microseconds since 1970
+  uint64_t fileTime = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+    attributes.ftLastWriteTime.dwLowDateTime;
+  modifiedTimeUsec = (fileTime - 116444736000000000ULL) / 10;
+  return true;
+}
+
+bool platform::renameFile(string oldPath, string newPath)
+{
+  return (MoveFileExA(oldPath.c_str(), newPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+}
+
+bool platform::deleteFile(string path)
+{
+  return (DeleteFileA(path.c_str()) != 0);
+}
+
+bool platform::lockFile(string path, bool exclusive, uint64_t& lockId)
+{
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+    FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+    nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  OVERLAPPED overlapped = {};
+  DWORD flags = LOCKFILE_FAIL_IMMEDIATELY | (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0);
+  if (!LockFileEx(hFile, flags, 0, 1, 0, &overlapped))
+  {
+    CloseHandle(hFile);
+    return false;
+  }
+  lockId = (uint64_t)hFile;
+  return true;
+}
+
+void platform::unlockFile(uint64_t lockId)
+{
+  HANDLE hFile = (HANDLE)lockId;
+  OVERLAPPED overlapped = {};
+  UnlockFileEx(hFile, 0, 1, 0, &overlapped);
+  CloseHandle(hFile);
+}
+
 vector<uint32_t> platform::getDisplayFrequencies(int32_t x, int32_t y)
 {
   vector<uint32_t> displayFrequencies;
@@ -790,6 +936,31 @@ vector<uint32_t> platform::getDisplayFrequencies(int32_t x, int32_t y)
   return displayFrequencies;
 }
 
+bool platform::getDisplaySize(int32_t x, int32_t y, uint32_t& width, uint32_t& height)
+{
+  // Get the monitor from the point and return its dimensions
+  POINT pt;
+  pt.x = x;
+  pt.y = y;
+  HMONITOR hMonitor = MonitorFromPoint(pt, MONITOR_DEFAULTTONEAREST);
+  if (hMonitor == nullptr)
+  {
+    fprintf(stderr, "[Platform_Win] ERROR: Failed to find monitor from point (%i, %i)\n", x, y);
+    return false;
+  }
+  MONITORINFO monitorInfo;
+  memset(&monitorInfo, 0, sizeof(MONITORINFO));
+  monitorInfo.cbSize = sizeof(MONITORINFO);
+  if (!GetMonitorInfo(hMonitor, &monitorInfo))
+  {
+    fprintf(stderr, "[Platform_Win] ERROR: Failed to get monitor info\n");
+    return false;
+  }
+  width = monitorInfo.rcMonitor.right - monitorInfo.rcMonitor.left;
+  height = monitorInfo.rcMonitor.bottom - monitorInfo.rcMonitor.top;
+  return true;
+}
+
 ProjectorWindow* gProjectorWindow = nullptr;
 bool platform::createProjectorWindow(uint32_t x, uint32_t y, bool scaleToFit,
   uint32_t refreshRate, string& error)
@@ -804,9 +975,9 @@ bool platform::createProjectorWindow(uint32_t x, uint32_t y, bool scaleToFit,
 }
 
 bool platform::displayVideoFrame(shared_ptr<FrameWrapper> wrapper, uint64_t& timestamp,
-  int32_t& delayMs, string& error)
+  string& error)
 {
-  return gProjectorWindow->displayVideoFrame(wrapper, timestamp, delayMs, error);
+  return gProjectorWindow->displayVideoFrame(wrapper, timestamp, error);
 }
 
 bool platform::displayCalibrationFrame(bool whiteFrame, uint64_t& timestamp, string& error)
@@ -0,0 +1,288 @@
+#include "PlaybackCache.h"
+#include "Blake2b.h"
+#include "Platform.h"
+#include "json/json.hpp"
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+using namespace std;
+using json = nlohmann::json;
+
+// Version of the index file format. An index with any other version is discarded
+#define VERSION 1
+
+// Names of the index file and the extensions of archives and partial archives
+#define INDEX_NAME "index.json"
+#define ARCHIVE_EXTENSION ".frames"
+#define TEMP_EXTENSION ".tmp"
+
+// Number of hex digits of the hash used to name each archive
+#define NAME_LENGTH 32
+
+static bool endsWith(string value, string suffix)
+{
+  return (value.size() >= suffix.size()) &&
+    (value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+PlaybackCache::PlaybackCache(string dir, uint64_t max) :
+  directory(dir),
+  maxBytes(max)
+{
+}
+
+bool PlaybackCache::open(string& error)
+{
+  unique_lock<mutex> lock(cacheMutex);
+  if (!platform::createDirectory(directory))
+  {
+    error = "Failed to create playback cache in " + directory;
+    return false;
+  }
+
+  // Load the index. A missing or unreadable index leaves the cache empty and every
+  // archive in the directory is then treated as orphaned
+  entries.clear();
+  totalBytes = 0;
+  nextUse = 1;
+  ifstream file(directory + "/" + INDEX_NAME);
+  if (file.is_open())
+  {
+    stringstream text;
+    text << file.rdbuf();
+    json index = json::parse(text.str(), nullptr, false);
+    if (!index.is_discarded() && index.is_object() && (index.value("version", 0) == VERSION))
+    {
+      nextUse = index.value("nextUse", (uint64_t)1);
+      auto videos = index.find("videos");
+      if ((videos != index.end()) && videos->is_object())
+      {
+        for (auto it = videos->begin(); it != videos->end(); ++it)
+        {
+          const json& video = it.value();
+          if (!video.is_object())
+          {
+            continue;
+          }
+          Entry entry;
+          entry.archiveName = video.value("archive", "");
+          entry.size = video.value("size", (uint64_t)0);
+          entry.modifiedTimeUsec = video.value("mtime", (uint64_t)0);
+          entry.lastUse = video.value("lastUse", (uint64_t)0);
+
+          // Take the archive's size from the disk in case it was touched
+          uint64_t archiveTimeUsec;
+          if (entry.archiveName.empty() || !platform::getFileInfo(directory + "/" +
+            entry.archiveName, entry.archiveBytes, archiveTimeUsec))
+          {
+            continue;
+          }
+          entries[it.key()] = entry;
+          totalBytes += entry.archiveBytes;
+        }
+      }
+    }
+  }
+  file.close();
+
+  // Delete anything in the directory the index doesn't know about
+  vector<string> names;
+  if (!platform::listDirectory(directory, names))
+  {
+    error = "Failed to list " + directory;
+    return false;
+  }
+  unordered_set<string> known;
+  for (auto it = entries.begin(); it != entries.end(); ++it)
+  {
+    known.insert(it->second.archiveName);
+  }
+  for (auto it = names.begin(); it != names.end(); ++it)
+  {
+    if ((endsWith(*it, ARCHIVE_EXTENSION) && (known.count(*it) == 0)) ||
+      endsWith(*it, TEMP_EXTENSION))
+    {
+      platform::deleteFile(directory + "/" + *it);
+    }
+  }
+  return save(error);
+}
+
+string PlaybackCache::lookup(string videoPath)
+{
+  uint64_t size = 0, modifiedTimeUsec = 0;
+  if (!platform::getFileInfo(videoPath, size, modifiedTimeUsec))
+  {
+    return "";
+  }
+  unique_lock<mutex> lock(cacheMutex);
+  auto it = entries.find(videoPath);
+  if (it == entries.end())
+  {
+    return "";
+  }
+  if ((it->second.size != size) || (it->second.modifiedTimeUsec != modifiedTimeUsec))
+  {
+    // The video has changed so its archive is no longer any use
+    removeEntry(videoPath);
+    string error;
+    save(error);
+    return "";
+  }
+
+  // Mark the entry as used so it's the last to be evicted
+  it->second.lastUse = nextUse++;
+  string archivePath = directory + "/" + it->second.archiveName;
+  string error;
+  save(error);
+  return archivePath;
+}
+
+bool PlaybackCache::reserve(uint64_t length, const vector<string>& keepVideos,
+  string& error)
+{
+  unique_lock<mutex> lock(cacheMutex);
+  if (length > maxBytes)
+  {
+    error = "Decoded video is larger than the playback cache";
+    return false;
+  }
+  unordered_set<string> keep(keepVideos.begin(), keepVideos.end());
+  while ((totalBytes + length) > maxBytes)
+  {
+    // Find the least recently used entry that we're allowed to evict
+    auto oldest = entries.end();
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+      if ((keep.count(it->first) == 0) && ((oldest == entries.end()) ||
+        (it->second.lastUse < oldest->second.lastUse)))
+      {
+        oldest = it;
+      }
+    }
+    if (oldest == entries.end())
+    {
+      error = "Playback cache is too small to hold the playlist";
+      return false;
+    }
+    removeEntry(oldest->first);
+  }
+  return save(error);
+}
+
+string PlaybackCache::getTempPath(string videoPath)
+{
+  uint64_t size = 0, modifiedTimeUsec = 0;
+  platform::getFileInfo(videoPath, size, modifiedTimeUsec);
+  return directory + "/" + getArchiveName(videoPath, size, modifiedTimeUsec) +
+    TEMP_EXTENSION;
+}
+
+bool PlaybackCache::add(string videoPath, string tempPath, string& error)
+{
+  Entry entry;
+  uint64_t archiveTimeUsec;
+  if (!platform::getFileInfo(videoPath, entry.size, entry.modifiedTimeUsec) ||
+    !platform::getFileInfo(tempPath, entry.archiveBytes, archiveTimeUsec))
+  {
+    platform::deleteFile(tempPath);
+    error = "Failed to examine " + tempPath;
+    return false;
+  }
+  entry.archiveName = getArchiveName(videoPath, entry.size, entry.modifiedTimeUsec);
+  unique_lock<mutex> lock(cacheMutex);
+  removeEntry(videoPath);
+  string archivePath = directory + "/" + entry.archiveName;
+  if (!platform::renameFile(tempPath, archivePath))
+  {
+    platform::deleteFile(tempPath);
+    error = "Failed to rename " + tempPath;
+    return false;
+  }
+  entry.lastUse = nextUse++;
+  entries[videoPath] = entry;
+  totalBytes += entry.archiveBytes;
+  return save(error);
+}
+
+uint64_t PlaybackCache::getMaxBytes()
+{
+  return maxBytes;
+}
+
+uint64_t PlaybackCache::getTotalBytes()
+{
+  unique_lock<mutex> lock(cacheMutex);
+  return totalBytes;
+}
+
+string PlaybackCache::getArchiveName(string videoPath, uint64_t size,
+  uint64_t modifiedTimeUsec)
+{
+  // Hash the path along with the size and modification time so a changed video never
+  // reuses the name of its stale archive
+  Blake2b hash;
+  uint64_t fileInfo[2] = { size, modifiedTimeUsec };
+  hash.update((const uint8_t*)videoPath.data(), videoPath.size());
+  hash.update((const uint8_t*)fileInfo, sizeof(fileInfo));
+  uint8_t digest[32];
+  hash.finish(digest);
+  return Blake2b::toHex(digest, sizeof(digest)).substr(0, NAME_LENGTH) +
+    ARCHIVE_EXTENSION;
+}
+
+void PlaybackCache::removeEntry(string videoPath)
+{
+  auto it = entries.find(videoPath);
+  if (it == entries.end())
+  {
+    return;
+  }
+  platform::deleteFile(directory + "/" + it->second.archiveName);
+  totalBytes -= it->second.archiveBytes;
+  entries.erase(it);
+}
+
+bool PlaybackCache::save(string& error)
+{
+  json videos = json::object();
+  for (auto it = entries.begin(); it != entries.end(); ++it)
+  {
+    videos[it->first] = {
+      { "archive", it->second.archiveName },
+      { "size", it->second.size },
+      { "mtime", it->second.modifiedTimeUsec },
+      { "lastUse", it->second.lastUse }
+    };
+  }
+  json index = { { "version", VERSION }, { "nextUse", nextUse }, { "videos", videos } };
+
+  // Write the index to a temporary file and rename it into place so an interrupted
+  // write never loses the whole cache
+  string indexPath = directory + "/" + INDEX_NAME;
+  string tempPath = indexPath + TEMP_EXTENSION;
+  {
+    ofstream file(tempPath, ios::out | ios::trunc);
+    if (!file.is_open())
+    {
+      error = "Failed to create " + tempPath;
+      return false;
+    }
+    file << index.dump();
+    if (!file.good())
+    {
+      file.close();
+      platform::deleteFile(tempPath);
+      error = "Failed to write " + tempPath;
+      return false;
+    }
+  }
+  if (!platform::renameFile(tempPath, indexPath))
+  {
+    platform::deleteFile(tempPath);
+    error = "Failed to rename " + tempPath;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The PlaybackCache class keeps decoded copies of video files as frame archives in a
+// directory on fast local disk so a playlist that is replayed many times only has to
+// be decoded once. Archives hold frames in the BGRA layout the projector consumes and
+// are played by mapping them for sequential access, with no ffmpeg process at all.
+//
+// Entries are keyed by the video's path and are only used while its size and
+// modification time still match. An index in "index.json" records each entry along
+// with a use counter, and the least recently used entries are deleted whenever adding
+// a new archive would take the directory over its size limit.
+class PlaybackCache
+{
+public:
+  PlaybackCache(std::string directory, uint64_t maxBytes);
+  virtual ~PlaybackCache() {};
+
+  // Creates the directory if needed, loads the index, and removes archives that are
+  // missing from it or temporary files left behind by an interrupted preparation
+  bool open(std::string& error);
+
+  // Returns the path of the archive holding the given video or an empty string
+  std::string lookup(std::string videoPath);
+
+  // Deletes least recently used archives until the given number of bytes fits within
+  // the limit. Archives of the videos in the keep list are never deleted
+  bool reserve(uint64_t length, const std::vector<std::string>& keepVideos,
+    std::string& error);
+
+  // Returns the path to decode the given video into before it's added
+  std::string getTempPath(std::string videoPath);
+
+  // Moves a completed archive into place and records it in the index
+  bool add(std::string videoPath, std::string tempPath, std::string& error);
+
+  uint64_t getMaxBytes();
+  uint64_t getTotalBytes();
+
+private:
+  struct Entry
+  {
+    std::string archiveName;
+    uint64_t size = 0;
+    uint64_t modifiedTimeUsec = 0;
+    uint64_t archiveBytes = 0;
+    uint64_t lastUse = 0;
+  };
+
+  std::string getArchiveName(std::string videoPath, uint64_t size,
+    uint64_t modifiedTimeUsec);
+  void removeEntry(std::string videoPath);
+  bool save(std::string& error);
+
+private:
+  std::string directory;
+  uint64_t maxBytes;
+  std::mutex cacheMutex;
+  std::unordered_map<std::string, Entry> entries;
+  uint64_t totalBytes = 0;
+  uint64_t nextUse = 1;
+};
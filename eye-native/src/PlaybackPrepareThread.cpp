@@ -0,0 +1,200 @@
+#include "PlaybackPrepareThread.h"
+#include "FfmpegPlaybackProcess.h"
+#include "FfprobeProcess.h"
+#include "FrameArchive.h"
+#include "FrameArchiveWriter.h"
+#include "FramePool.h"
+#include "Platform.h"
+#include <sstream>
+
+using namespace std;
+
+// Number of decoded frames buffered between ffmpeg and the archive writer
+#define BUFFERED_FRAMES 16
+
+PlaybackPrepareThread::PlaybackPrepareThread(vector<string> v, string ffmpeg,
+    string ffprobe, shared_ptr<PlaybackCache> cache, uint32_t comp,
+    wrapper::JsCallback* log, wrapper::JsCallback* progress) :
+  Thread("playbackprepare"),
+  videos(v),
+  ffmpegPath(ffmpeg),
+  ffprobePath(ffprobe),
+  playbackCache(cache),
+  compression(comp),
+  logCallback(log),
+  progressCallback(progress)
+{
+}
+
+uint32_t PlaybackPrepareThread::run()
+{
+  // Examine every video first so progress can be reported against the whole playlist
+  wrapper::invokeJsCallback(logCallback, "Examining video files...\n");
+  vector<VideoInfo> videoInfo(videos.size());
+  vector<bool> cached(videos.size(), false);
+  uint64_t totalFrames = 0;
+  for (uint32_t i = 0; (i < videos.size()) && !checkForExit(); ++i)
+  {
+    string video = videos.at(i);
+    if (framearchive::isArchivePath(video) || !playbackCache->lookup(video).empty())
+    {
+      cached[i] = true;
+      continue;
+    }
+    if (!probeVideo(video, videoInfo[i]))
+    {
+      wrapper::invokeJsCallback(logCallback, "ERROR: Failed to examine " + video + "\n");
+      continue;
+    }
+    totalFrames += videoInfo[i].frameCount;
+  }
+
+  // Decode the videos that aren't cached yet
+  uint64_t framesDone = 0;
+  for (uint32_t i = 0; (i < videos.size()) && !checkForExit(); ++i)
+  {
+    stringstream message;
+    if (cached[i])
+    {
+      message << "Video file " << to_string(i + 1) << " is already prepared." << endl;
+      wrapper::invokeJsCallback(logCallback, message.str());
+      continue;
+    }
+    if (videoInfo[i].frameCount == 0)
+    {
+      continue;
+    }
+    message << "Preparing video file " << to_string(i + 1) << "." << endl;
+    wrapper::invokeJsCallback(logCallback, message.str());
+    prepareVideo(i, videoInfo[i], framesDone, totalFrames);
+  }
+  if (!checkForExit())
+  {
+    wrapper::invokeJsCallback(progressCallback, 100);
+    wrapper::invokeJsCallback(logCallback, "Playback preparation complete.\n");
+  }
+  return 0;
+}
+
+bool PlaybackPrepareThread::terminate(uint32_t timeout /*= 100*/)
+{
+  // Stopping ffmpeg and cleaning up a partial archive can take a while so wait for up
+  // to a full second
+  return Thread::terminate(1000);
+}
+
+bool PlaybackPrepareThread::probeVideo(string video, VideoInfo& info)
+{
+  string error;
+  if (videoinfo::read(video, info, error))
+  {
+    return true;
+  }
+  FfprobeProcess* ffprobeProcess = new FfprobeProcess(ffprobePath, video);
+  ffprobeProcess->spawn();
+  ffprobeProcess->waitForExit();
+  info.width = ffprobeProcess->getWidth();
+  info.height = ffprobeProcess->getHeight();
+  info.fps = ffprobeProcess->getFps();
+  info.frameCount = ffprobeProcess->getFrameCount();
+  info.durationUsec = ffprobeProcess->getDurationUsec();
+  delete ffprobeProcess;
+  return (info.width != 0) && (info.height != 0) && (info.fps != 0) &&
+    (info.frameCount != 0);
+}
+
+bool PlaybackPrepareThread::prepareVideo(uint32_t index, VideoInfo& info,
+  uint64_t& framesDone, uint64_t totalFrames)
+{
+  // Make room for the archive at its uncompressed size. The videos in this playlist are
+  // never evicted to make room for each other
+  string video = videos.at(index);
+  size_t frameLength = (size_t)info.width * info.height * 4;
+  uint64_t blockLength = (frameLength + FRAME_ARCHIVE_ALIGNMENT - 1) /
+    FRAME_ARCHIVE_ALIGNMENT * FRAME_ARCHIVE_ALIGNMENT;
+  uint64_t archiveLength = FRAME_ARCHIVE_HEADER_SIZE + (uint64_t)info.frameCount *
+    (blockLength + FRAME_ARCHIVE_INDEX_ENTRY_SIZE);
+  string error;
+  if (!playbackCache->reserve(archiveLength, videos, error))
+  {
+    wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+    return false;
+  }
+
+  // Decode into a temporary file that's only moved into place once it's complete
+  string tempPath = playbackCache->getTempPath(video);
+  FrameArchiveWriter writer(tempPath, compression);
+  if (!writer.open(info.width, info.height, info.fps, error))
+  {
+    wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+    platform::deleteFile(tempPath);
+    return false;
+  }
+  shared_ptr<FramePool> framePool(new FramePool(frameLength, BUFFERED_FRAMES));
+  shared_ptr<Queue<shared_ptr<FrameWrapper>>> frameQueue(
+    new Queue<shared_ptr<FrameWrapper>>());
+  FfmpegPlaybackProcess* process = new FfmpegPlaybackProcess(ffmpegPath, video,
+    info.width, info.height, framePool, frameQueue);
+  process->spawn();
+
+  // Write each frame to the archive as it's decoded
+  bool success = true;
+  uint32_t frameNumber = 0;
+  while (!checkForExit())
+  {
+    shared_ptr<FrameWrapper> wrapper;
+    if (!frameQueue->waitItem(&wrapper, 10))
+    {
+      if (process->isDecodingFinished() && frameQueue->empty())
+      {
+        break;
+      }
+      continue;
+    }
+    if (!writer.processFrame(wrapper, wrapper->nativeFrame, wrapper->nativeLength, error))
+    {
+      wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+      success = false;
+      break;
+    }
+    frameNumber += 1;
+    framesDone += 1;
+    int32_t progress = (int32_t)(framesDone * 100 / max(totalFrames, (uint64_t)1));
+    if (progress != lastProgress)
+    {
+      wrapper::invokeJsCallback(progressCallback, min(progress, 99));
+      lastProgress = progress;
+    }
+  }
+
+  // Stop ffmpeg and finish the archive
+  if (process->isProcessRunning())
+  {
+    if (success && !checkForExit() && process->isDecodingFinished())
+    {
+      process->waitForExit();
+    }
+    else
+    {
+      process->terminateProcess();
+    }
+  }
+  delete process;
+  frameQueue->clear();
+  if (!writer.close(error))
+  {
+    wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+    success = false;
+  }
+  if (!success || checkForExit() || (frameNumber == 0))
+  {
+    platform::deleteFile(tempPath);
+    return false;
+  }
+  if (!playbackCache->add(video, tempPath, error))
+  {
+    wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+    return false;
+  }
+  return true;
+}
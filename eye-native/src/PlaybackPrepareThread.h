@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "PlaybackCache.h"
+#include "Thread.h"
+#include "VideoInfo.h"
+#include "Wrapper.h"
+
+// The PlaybackPrepareThread class decodes each video in a playlist with ffmpeg and
+// stores its frames in the playback cache as a frame archive. Videos that are already
+// cached or are frame archives themselves are skipped. Progress through the playlist
+// is reported as a percentage and the thread exits once every video is done.
+class PlaybackPrepareThread : public Thread
+{
+public:
+  PlaybackPrepareThread(std::vector<std::string> videos, std::string ffmpegPath,
+    std::string ffprobePath, std::shared_ptr<PlaybackCache> playbackCache,
+    uint32_t compression, wrapper::JsCallback* logCallback,
+    wrapper::JsCallback* progressCallback);
+  virtual ~PlaybackPrepareThread() {};
+
+  uint32_t run() override;
+
+  bool terminate(uint32_t timeout = 100) override;
+
+private:
+  bool probeVideo(std::string video, VideoInfo& info);
+  bool prepareVideo(uint32_t index, VideoInfo& info, uint64_t& framesDone,
+    uint64_t totalFrames);
+
+private:
+  std::vector<std::string> videos;
+  std::string ffmpegPath;
+  std::string ffprobePath;
+  std::shared_ptr<PlaybackCache> playbackCache;
+  uint32_t compression;
+  wrapper::JsCallback* logCallback;
+  wrapper::JsCallback* progressCallback;
+  int32_t lastProgress = -1;
+};
@@ -1,13 +1,27 @@
 #include "PlaybackThread.h"
 #include "FfmpegPlaybackProcess.h"
 #include "FfprobeProcess.h"
+#include "FrameArchiveReader.h"
+#include "Mp4Reader.h"
 #include "Platform.h"
 #include "PreviewSendThread.h"
 #include "ProjectorThread.h"
+#include "SeekIndex.h"
+#include <deque>
 #include <sstream>
 
 using namespace std;
 
+// Largest number of ffprobe processes run at once
+#define MAX_PARALLEL_PROBES 8
+
+// Number of seconds of decoded video buffered by each video that's decoded ahead of
+// its turn
+#define LOOKAHEAD_SECONDS 1
+
+// Fewest frames a pool may hold however large the frames are
+#define MIN_BUFFERED_FRAMES 8
+
 PlaybackThread::PlaybackThread(uint32_t x1, uint32_t y1, vector<string> vids,
     bool scale, string ffmpeg, string ffprobe, wrapper::JsCallback* log,
     wrapper::JsCallback* duration, wrapper::JsCallback* position,
@@ -32,6 +46,74 @@ void PlaybackThread::setPreviewChannel(string name)
   channelName = name;
 }
 
+void PlaybackThread::setGammaTable(shared_ptr<GammaTable> table)
+{
+  // Only called before the thread is spawned
+  gammaTable = table;
+}
+
+void PlaybackThread::setSyncTracker(shared_ptr<SyncTracker> tracker)
+{
+  // Only called before the thread is spawned
+  syncTracker = tracker;
+}
+
+void PlaybackThread::setFrameCode(shared_ptr<FrameCode> code)
+{
+  // Only called before the thread is spawned
+  frameCode = code;
+}
+
+void PlaybackThread::setDecoderLookahead(uint32_t count)
+{
+  // Only called before the thread is spawned
+  decoderLookahead = count;
+}
+
+void PlaybackThread::setProbeCache(shared_ptr<ProbeCache> cache)
+{
+  // Only called before the thread is spawned
+  probeCache = cache;
+}
+
+void PlaybackThread::setPlaybackCache(shared_ptr<PlaybackCache> cache)
+{
+  // Only called before the thread is spawned
+  playbackCache = cache;
+}
+
+void PlaybackThread::setBufferBytes(uint64_t bytes)
+{
+  // Only called before the thread is spawned
+  bufferBytes = bytes;
+}
+
+void PlaybackThread::setDecodeToDisplay(bool enabled)
+{
+  // Only called before the thread is spawned
+  decodeToDisplay = enabled;
+}
+
+void PlaybackThread::setStarvationPolicy(uint32_t policy)
+{
+  // Only called before the thread is spawned
+  starvationPolicy = policy;
+}
+
+void PlaybackThread::setPresentationLogPath(string path)
+{
+  // Only called before the thread is spawned
+  presentationLogPath = path;
+}
+
+void PlaybackThread::setStartPosition(uint32_t video, uint32_t frame, int64_t timeMs)
+{
+  // Only called before the thread is spawned
+  startVideo = video;
+  startFrame = frame;
+  startTimeMs = timeMs;
+}
+
 string PlaybackThread::formatDuration(uint32_t durationSec)
 {
   uint32_t seconds = durationSec % 60;
@@ -55,29 +137,75 @@ string PlaybackThread::formatDuration(uint32_t durationSec)
 
 uint32_t PlaybackThread::run()
 {
+  // Play prepared videos from their frame archives in the playback cache
+  if (playbackCache != nullptr)
+  {
+    for (uint32_t i = 0; i < videos.size(); ++i)
+    {
+      string archivePath = playbackCache->lookup(videos.at(i));
+      if (!archivePath.empty())
+      {
+        stringstream message;
+        message << "Playing video file " << to_string(i + 1) <<
+          " from the playback cache." << endl;
+        wrapper::invokeJsCallback(logCallback, message.str());
+        videos[i] = archivePath;
+      }
+    }
+  }
+
   // Check the dimensions, frame rate, and length of each video file
   wrapper::invokeJsCallback(logCallback, "Examining video files...\n");
+  vector<VideoInfo> videoInfo;
+  if (!probeVideos(videoInfo))
+  {
+    wrapper::invokeJsCallback(durationCallback, 0);
+    wrapper::invokeJsCallback(positionCallback, 0);
+    return 1;
+  }
+
+  // Look up the projector's resolution if ffmpeg is to scale and pad each frame to it.
+  // Frame archives keep the dimensions they were prepared with
+  uint32_t displayWidth = 0, displayHeight = 0;
+  if (decodeToDisplay)
+  {
+    if (platform::getDisplaySize(x, y, displayWidth, displayHeight))
+    {
+      stringstream message;
+      message << "Decoding to the projector resolution of " << to_string(displayWidth) <<
+        " x " << to_string(displayHeight) << "." << endl;
+      wrapper::invokeJsCallback(logCallback, message.str());
+    }
+    else
+    {
+      wrapper::invokeJsCallback(logCallback,
+        "WARNING: Failed to get the projector resolution, decoding at video resolution.\n");
+      displayWidth = displayHeight = 0;
+    }
+  }
   vector<pair<uint32_t, uint32_t>> videoDimensions;
+  vector<string> videoFilters;
   vector<uint32_t> videoFps;
   vector<uint32_t> videoLengths;
   double totalDurationMs = 0;
   for (uint32_t i = 0; i < videos.size(); ++i)
   {
-    // Spawn the ffprobe process and wait for it to complete
     string video = videos.at(i);
-    FfprobeProcess* ffprobeProcess = new FfprobeProcess(ffprobePath, video);
-    ffprobeProcess->spawn();
-    ffprobeProcess->waitForExit();
-
-    // Remember the video details and clean up the process
-    uint32_t width = ffprobeProcess->getWidth();
-    uint32_t height = ffprobeProcess->getHeight();
-    uint32_t fps = ffprobeProcess->getFps();
-    uint32_t frameCount = ffprobeProcess->getFrameCount();
-    delete ffprobeProcess;
+    uint32_t width = videoInfo[i].width, height = videoInfo[i].height;
+    uint32_t fps = videoInfo[i].fps, frameCount = videoInfo[i].frameCount;
 
-    // Append the video details to our vectors and log them
-    videoDimensions.push_back(make_pair(width, height));
+    // Append the video details to our vectors and log them. Videos decoded to the
+    // projector's geometry are buffered at that size
+    if ((displayWidth != 0) && !framearchive::isArchivePath(video))
+    {
+      videoDimensions.push_back(make_pair(displayWidth, displayHeight));
+      videoFilters.push_back(getDisplayFilter(width, height, displayWidth, displayHeight));
+    }
+    else
+    {
+      videoDimensions.push_back(make_pair(width, height));
+      videoFilters.push_back("");
+    }
     videoFps.push_back(fps);
     videoLengths.push_back(frameCount);
     double durationMs = (double)frameCount / (double)fps * 1000;
@@ -87,13 +215,40 @@ uint32_t PlaybackThread::run()
       " x " << to_string(height) << " @ " << to_string(fps) << " fps, " <<
       to_string(frameCount) << " frames, " << formatDuration(durationMs / 1000) << endl;
     wrapper::invokeJsCallback(logCallback, message.str());
+  }
 
-    // Abort if we've been signaled to exit
-    if (checkForExit())
+  // Find where playback starts. The duration and position reported to the UI stay
+  // relative to the start of the playlist, so the position begins at the offset
+  string error;
+  if (!resolveStartPosition(videoFps, videoLengths, error))
+  {
+    wrapper::invokeJsCallback(logCallback, "ERROR: " + error + ".\n");
+    wrapper::invokeJsCallback(durationCallback, 0);
+    wrapper::invokeJsCallback(positionCallback, 0);
+    return 1;
+  }
+  double timestampSec = 0;
+  uint64_t totalFrames = 0;
+  for (uint32_t i = 0; i < videos.size(); ++i)
+  {
+    if (i < startVideo)
     {
-      return 1;
+      timestampSec += (double)videoLengths.at(i) / videoFps.at(i);
+    }
+    else
+    {
+      totalFrames += videoLengths.at(i);
     }
   }
+  if ((startVideo != 0) || (startFrame != 0))
+  {
+    timestampSec += (double)startFrame / videoFps.at(startVideo);
+    totalFrames -= startFrame;
+    stringstream message;
+    message << "Starting playback at frame " << to_string(startFrame) << " of video file " <<
+      to_string(startVideo + 1) << " (" << formatDuration(timestampSec) << ")." << endl;
+    wrapper::invokeJsCallback(logCallback, message.str());
+  }
 
   // Examine the monitor's supported refresh rates and the frame rate of each video to
   // determine the refresh rate we should use
@@ -142,6 +297,23 @@ uint32_t PlaybackThread::run()
     return 1;
   }
 
+  // Open the presentation log before anything is shown so every frame is recorded
+  shared_ptr<PresentationLogWriter> presentationLog(nullptr);
+  if (!presentationLogPath.empty())
+  {
+    presentationLog = shared_ptr<PresentationLogWriter>(new PresentationLogWriter(
+      presentationLogPath, monitorRefreshRate));
+    if (!presentationLog->open(error))
+    {
+      wrapper::invokeJsCallback(logCallback, "ERROR: " + error + ".\n");
+      wrapper::invokeJsCallback(durationCallback, 0);
+      wrapper::invokeJsCallback(positionCallback, 0);
+      platform::releaseTimingCard();
+      return 1;
+    }
+    presentationLog->spawn();
+  }
+
   // Notify the javascript of the total duration
   wrapper::invokeJsCallback(durationCallback, totalDurationMs);
   {
@@ -158,7 +330,16 @@ uint32_t PlaybackThread::run()
   shared_ptr<Queue<shared_ptr<FrameWrapper>>> previewFrameQueue(
     new Queue<shared_ptr<FrameWrapper>>());
   ProjectorThread* projectorThread = new ProjectorThread(x, y, scaleToFit, monitorRefreshRate,
-    pendingFrameQueue, previewFrameQueue, logCallback, positionCallback, delayCallback);
+    pendingFrameQueue, previewFrameQueue, logCallback, positionCallback, delayCallback,
+    gammaTable, syncTracker, frameCode);
+  if (!videos.empty())
+  {
+    size_t frameLength = (size_t)videoDimensions.at(startVideo).first *
+      videoDimensions.at(startVideo).second * 4;
+    projectorThread->setPreroll(totalFrames, getBufferedFrames(frameLength));
+  }
+  projectorThread->setStarvationPolicy(starvationPolicy);
+  projectorThread->setPresentationLog(presentationLog);
   projectorThread->spawn();
 
   // Spawn the preview send thread that will transmit the frames from the preview
@@ -168,106 +349,70 @@ uint32_t PlaybackThread::run()
   previewSendThread->spawn();
 
   // Video playback loop
-  double timestampSec = 0;
-  for (uint32_t i = 0; (i < videos.size()) && !checkForExit(); ++i)
+  deque<VideoDecoder> decoders;
+  for (uint32_t i = startVideo; (i < videos.size()) && !checkForExit(); ++i)
   {
     // Get video details
     string video = videos.at(i);
-    uint32_t width = videoDimensions.at(i).first;
-    uint32_t height = videoDimensions.at(i).second;
     uint32_t fps = videoFps.at(i);
     uint32_t frameCount = videoLengths.at(i);
+    uint32_t firstFrame = (i == startVideo) ? startFrame : 0;
 
-    // Spawn the ffmpeg process
+    // Start the decoders for this video and the ones that follow it within the
+    // lookahead. A decoder started ahead of time has already spawned ffmpeg, opened the
+    // file, and buffered its first frames by the time its video comes up
+    for (uint32_t j = i; (j < videos.size()) && (j <= i + decoderLookahead); ++j)
     {
-      stringstream message;
-      message << "Starting to decode video file " << to_string(i + 1) << "." << endl;
-      wrapper::invokeJsCallback(logCallback, message.str());
+      if (!framearchive::isArchivePath(videos.at(j)) &&
+        (decoders.empty() || (decoders.back().index < j)))
+      {
+        decoders.push_back(startDecoder(j, videos.at(j), videoDimensions.at(j).first,
+          videoDimensions.at(j).second, videoFps.at(j), videoFilters.at(j),
+          (j == startVideo) ? startFrame : 0));
+      }
     }
-    FfmpegPlaybackProcess* ffmpegProcess = new FfmpegPlaybackProcess(ffmpegPath, video,
-      width, height);
-    ffmpegProcess->spawn();
 
-    // Read each frame of the video
-    uint32_t frameSize = width * height * 4, frameNumber = 0;
-    shared_ptr<FrameWrapper> wrapper = 0;
-    while (!checkForExit() && (frameNumber < frameCount))
+    // Frame archives are read directly rather than being decoded by ffmpeg
+    if (framearchive::isArchivePath(video))
     {
-      // Pause here and sleep if the output queue is full, i.e. contains a full 5 seconds
-      // worth of frames. This is necessary because we read frames from ffmpeg much faster
-      // than we project them and don't want to run out of memory
-      if (pendingFrameQueue->size() >= (5 * fps))
-      {
-        platform::sleep(5);
-        continue;
-      }
+      readFrameArchive(i, video, firstFrame, pendingFrameQueue, previewSendThread,
+        timestampSec);
+      continue;
+    }
 
-      // Read ffmpeg stdout and sleep if nothing is available
-      string data = ffmpegProcess->readStdout();
-      if (data.empty())
-      {
-        platform::sleep(5);
-        continue;
-      }
+    // Let the current video fill its whole pool
+    VideoDecoder decoder = decoders.front();
+    decoders.pop_front();
+    decoder.framePool->setLimit(decoder.framePool->getBufferCount());
 
-      // Convert the stream of data from ffmpeg into discreet frames and pass them
-      // to the pending frames queue
-      while (!data.empty())
+    // Stamp each decoded frame and pass it to the pending frames queue. The first frame
+    // follows the last frame of the previous video with no more delay than any other
+    uint32_t frameNumber = firstFrame;
+    while (!checkForExit() && (frameNumber < frameCount))
+    {
+      shared_ptr<FrameWrapper> wrapper;
+      if (!decoder.frameQueue->waitItem(&wrapper, 10))
       {
-        if (wrapper == 0)
-        {
-          wrapper = shared_ptr<FrameWrapper>(new FrameWrapper(frameNumber));
-          wrapper->nativeFrame = new uint8_t[frameSize];
-          wrapper->nativeWidth = width;
-          wrapper->nativeHeight = height;
-          wrapper->timestampMs = (uint64_t)(timestampSec * 1000);
-          wrapper->fps = fps;
-        }
-        uint32_t bytesToCopy;
-        if ((frameSize - wrapper->nativeLength) > data.size())
-        {
-          bytesToCopy = data.size();
-        }
-        else
-        {
-          bytesToCopy = frameSize - wrapper->nativeLength;
-        }
-        memcpy(wrapper->nativeFrame + wrapper->nativeLength, data.data(), bytesToCopy);
-        wrapper->nativeLength += bytesToCopy;
-        if (wrapper->nativeLength == frameSize)
+        if (decoder.process->isDecodingFinished() && decoder.frameQueue->empty())
         {
-          pendingFrameQueue->addItem(wrapper);
-          frameNumber += 1;
-          timestampSec += 1.0 / fps;
-          wrapper = 0;
+          break;
         }
-        data = data.substr(bytesToCopy);
+        continue;
       }
+      wrapper->number = frameNumber;
+      wrapper->timestampMs = (uint64_t)(timestampSec * 1000);
+      wrapper->fps = fps;
+      wrapper->videoIndex = i;
+      pendingFrameQueue->addItem(wrapper);
+      frameNumber += 1;
+      timestampSec += 1.0 / fps;
 
       // Pass the preview channel name to the send thread
-      {
-        unique_lock<mutex> lock(channelMutex);
-        if (!channelName.empty())
-        {
-          previewSendThread->setPreviewChannel(channelName);
-          channelName.clear();
-        }
-      }
+      updatePreviewChannel(previewSendThread);
     }
 
     // Stop ffmpeg
-    if (ffmpegProcess->isProcessRunning())
-    {
-      if (!checkForExit())
-      {
-        ffmpegProcess->waitForExit();
-      }
-      else
-      {
-        ffmpegProcess->terminateProcess();
-      }
-    }
-    delete ffmpegProcess;
+    stopDecoder(decoder);
     if (!checkForExit())
     {
       stringstream message;
@@ -276,6 +421,13 @@ uint32_t PlaybackThread::run()
     }
   }
 
+  // Stop any decoders that were started ahead of time if playback ended early
+  for (auto it = decoders.begin(); it != decoders.end(); ++it)
+  {
+    stopDecoder(*it);
+  }
+  decoders.clear();
+
   // Wait until the pending and preview frame queues have drained
   while (!checkForExit() && 
     (!pendingFrameQueue->empty() || !previewFrameQueue->empty()))
@@ -289,6 +441,20 @@ uint32_t PlaybackThread::run()
     projectorThread->terminate();
   }
   delete projectorThread;
+  if (presentationLog != nullptr)
+  {
+    if (!presentationLog->close(error))
+    {
+      wrapper::invokeJsCallback(logCallback, "ERROR: " + error + ".\n");
+    }
+    if (presentationLog->getDroppedCount() != 0)
+    {
+      stringstream message;
+      message << "WARNING: " << presentationLog->getDroppedCount() <<
+        " records were dropped from the presentation log." << endl;
+      wrapper::invokeJsCallback(logCallback, message.str());
+    }
+  }
   if (previewSendThread->isRunning())
   {
     previewSendThread->terminate();
@@ -306,3 +472,335 @@ bool PlaybackThread::terminate(uint32_t timeout /*= 100*/)
   // wait for up to a full second
   return Thread::terminate(1000);
 }
+
+uint32_t PlaybackThread::getBufferedFrames(size_t frameLength)
+{
+  // The budget is shared by the video that's playing and the ones decoded ahead of it.
+  // Pools only allocate what they use, so this bounds memory rather than committing it
+  uint64_t share = bufferBytes / (decoderLookahead + 1);
+  uint64_t frames = share / max(frameLength, (size_t)1);
+  return (uint32_t)min(max(frames, (uint64_t)MIN_BUFFERED_FRAMES), (uint64_t)UINT32_MAX);
+}
+
+string PlaybackThread::getDisplayFilter(uint32_t width, uint32_t height,
+  uint32_t displayWidth, uint32_t displayHeight)
+{
+  // Frames that already match the display go through untouched
+  if ((width == displayWidth) && (height == displayHeight))
+  {
+    return "";
+  }
+
+  // Produce the same picture the projector window would have drawn from the full-size
+  // frame. Scaled frames are stretched to fill the display and unscaled ones are
+  // centered at their native size, cropped if they're larger than the display and
+  // padded with black if they're smaller. Pixels are converted to BGRA first so the
+  // padding is placed exactly rather than on chroma boundaries
+  stringstream filter;
+  if (scaleToFit)
+  {
+    filter << "scale=" << displayWidth << ":" << displayHeight;
+  }
+  else
+  {
+    uint32_t cropWidth = min(width, displayWidth);
+    uint32_t cropHeight = min(height, displayHeight);
+    filter << "format=bgra,crop=" << cropWidth << ":" << cropHeight << ",pad=" <<
+      displayWidth << ":" << displayHeight << ":" << (displayWidth - cropWidth) / 2 <<
+      ":" << (displayHeight - cropHeight) / 2 << ":black";
+  }
+  return filter.str();
+}
+
+bool PlaybackThread::resolveStartPosition(vector<uint32_t>& videoFps,
+  vector<uint32_t>& videoLengths, string& error)
+{
+  // Convert a start time to the video and frame it falls within
+  if (startTimeMs > 0)
+  {
+    double videoStartMs = 0;
+    for (uint32_t i = 0; i < videos.size(); ++i)
+    {
+      double durationMs = (double)videoLengths.at(i) / videoFps.at(i) * 1000;
+      if (startTimeMs < videoStartMs + durationMs)
+      {
+        startVideo = i;
+        startFrame = min((uint32_t)((startTimeMs - videoStartMs) * videoFps.at(i) / 1000),
+          videoLengths.at(i) - 1);
+        return true;
+      }
+      videoStartMs += durationMs;
+    }
+    error = "Start time is beyond the end of the playlist";
+    return false;
+  }
+  if (startTimeMs == 0)
+  {
+    startVideo = 0;
+    startFrame = 0;
+    return true;
+  }
+  if ((startVideo == 0) && (startFrame == 0))
+  {
+    return true;
+  }
+  if (startVideo >= videos.size())
+  {
+    error = "Start video is beyond the end of the playlist";
+    return false;
+  }
+  if (startFrame >= videoLengths.at(startVideo))
+  {
+    error = "Start frame is beyond the end of the video";
+    return false;
+  }
+  return true;
+}
+
+double PlaybackThread::getFrameTime(string video, uint32_t frame, uint32_t fps)
+{
+  // Aim half way between the frame and the one before it so rounding can neither drop
+  // the frame nor keep the one before. Recordings usually start at a stimulus, and their
+  // seek index gives its presentation time without parsing the sample tables. The index
+  // is only trusted if it was written after the video
+  string error;
+  string indexPath = seekindex::getIndexPath(video);
+  uint64_t videoSize, videoTimeUsec, indexSize, indexTimeUsec;
+  uint32_t indexFps;
+  vector<SeekIndexEntry> entries;
+  if (platform::getFileInfo(video, videoSize, videoTimeUsec) &&
+    platform::getFileInfo(indexPath, indexSize, indexTimeUsec) &&
+    (indexTimeUsec >= videoTimeUsec) && seekindex::read(indexPath, indexFps, entries,
+    error) && (indexFps != 0))
+  {
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+      if (it->frameNumber == frame)
+      {
+        return (double)it->ptsUsec / 1000000.0 - 0.5 / indexFps;
+      }
+    }
+  }
+
+  // Otherwise the sample table of an MP4 file gives the exact presentation time of each
+  // frame, which also holds for variable frame rates
+  Mp4Reader reader(video);
+  if (reader.parse(error) && (reader.getTimescale() != 0) &&
+    (frame < reader.getSamples().size()))
+  {
+    vector<Mp4Sample>& samples = reader.getSamples();
+    int64_t pts = (samples[frame - 1].pts + samples[frame].pts) / 2 - samples[0].pts;
+    return (double)pts / reader.getTimescale();
+  }
+  return ((double)frame - 0.5) / fps;
+}
+
+bool PlaybackThread::probeVideos(vector<VideoInfo>& videoInfo)
+{
+  // Frame archives describe themselves in their header and cached videos don't need
+  // to be examined again
+  videoInfo.assign(videos.size(), VideoInfo());
+  vector<uint32_t> unprobed;
+  for (uint32_t i = 0; i < videos.size(); ++i)
+  {
+    string video = videos.at(i);
+    if (framearchive::isArchivePath(video))
+    {
+      FrameArchiveReader reader(video, false);
+      string error;
+      if (!reader.open(error))
+      {
+        wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+        return false;
+      }
+      videoInfo[i].width = reader.getWidth();
+      videoInfo[i].height = reader.getHeight();
+      videoInfo[i].fps = reader.getFps();
+      videoInfo[i].frameCount = reader.getFrameCount();
+    }
+    else if ((probeCache == nullptr) || !probeCache->lookup(video, videoInfo[i]))
+    {
+      // Read MP4 and Matroska headers directly and only spawn ffprobe for the rest
+      string error;
+      if (!videoinfo::read(video, videoInfo[i], error))
+      {
+        videoInfo[i] = VideoInfo();
+        unprobed.push_back(i);
+      }
+      else if (probeCache != nullptr)
+      {
+        probeCache->store(video, videoInfo[i]);
+      }
+    }
+  }
+
+  // Run several ffprobe processes at once and collect their results in order. Most of
+  // the time goes to starting each process and opening its file, so this is bounded by
+  // the number of processes rather than the number of cores
+  deque<pair<uint32_t, FfprobeProcess*>> running;
+  size_t next = 0;
+  while ((next < unprobed.size()) || !running.empty())
+  {
+    while ((next < unprobed.size()) && (running.size() < MAX_PARALLEL_PROBES) &&
+      !checkForExit())
+    {
+      uint32_t index = unprobed[next++];
+      FfprobeProcess* ffprobeProcess = new FfprobeProcess(ffprobePath, videos.at(index));
+      ffprobeProcess->spawn();
+      running.push_back(make_pair(index, ffprobeProcess));
+    }
+    if (running.empty())
+    {
+      break;
+    }
+    uint32_t index = running.front().first;
+    FfprobeProcess* ffprobeProcess = running.front().second;
+    running.pop_front();
+    ffprobeProcess->waitForExit();
+    videoInfo[index].width = ffprobeProcess->getWidth();
+    videoInfo[index].height = ffprobeProcess->getHeight();
+    videoInfo[index].fps = ffprobeProcess->getFps();
+    videoInfo[index].frameCount = ffprobeProcess->getFrameCount();
+    videoInfo[index].durationUsec = ffprobeProcess->getDurationUsec();
+    delete ffprobeProcess;
+    if (probeCache != nullptr)
+    {
+      probeCache->store(videos.at(index), videoInfo[index]);
+    }
+  }
+  if (checkForExit())
+  {
+    return false;
+  }
+
+  // Remember the new results for next time
+  string error;
+  if ((probeCache != nullptr) && !probeCache->save(error))
+  {
+    wrapper::invokeJsCallback(logCallback, "WARNING: " + error + "\n");
+  }
+  return true;
+}
+
+PlaybackThread::VideoDecoder PlaybackThread::startDecoder(uint32_t index, string video,
+  uint32_t width, uint32_t height, uint32_t fps, string videoFilter, uint32_t firstFrame)
+{
+  {
+    stringstream message;
+    message << "Starting to decode video file " << to_string(index + 1) << "." << endl;
+    wrapper::invokeJsCallback(logCallback, message.str());
+  }
+
+  // Spawn the ffmpeg process. Frames are read from its output straight into buffers
+  // from a pool sized by the buffer budget, so decoding blocks when it gets that far
+  // ahead of the projector rather than running out of memory. Until the video comes up
+  // it may only buffer its first second
+  VideoDecoder decoder;
+  decoder.index = index;
+  size_t frameLength = (size_t)width * height * 4;
+  decoder.framePool = shared_ptr<FramePool>(new FramePool(frameLength,
+    getBufferedFrames(frameLength)));
+  decoder.framePool->setLimit(min(decoder.framePool->getBufferCount(),
+    LOOKAHEAD_SECONDS * fps));
+  decoder.frameQueue = shared_ptr<Queue<shared_ptr<FrameWrapper>>>(
+    new Queue<shared_ptr<FrameWrapper>>());
+  decoder.process = new FfmpegPlaybackProcess(ffmpegPath, video, width, height,
+    decoder.framePool, decoder.frameQueue, false, videoFilter);
+  if (firstFrame != 0)
+  {
+    decoder.process->setStartTime(getFrameTime(video, firstFrame, fps));
+  }
+  decoder.process->spawn();
+  return decoder;
+}
+
+void PlaybackThread::stopDecoder(VideoDecoder& decoder)
+{
+  // Let ffmpeg finish on its own unless playback is being cut short
+  if (decoder.process->isProcessRunning())
+  {
+    if (!checkForExit() && decoder.process->isDecodingFinished())
+    {
+      decoder.process->waitForExit();
+    }
+    else
+    {
+      decoder.process->terminateProcess();
+    }
+  }
+  delete decoder.process;
+  decoder.process = nullptr;
+}
+
+void PlaybackThread::readFrameArchive(uint32_t index, string archivePath,
+  uint32_t firstFrame, shared_ptr<Queue<shared_ptr<FrameWrapper>>> pendingFrameQueue,
+  PreviewSendThread* previewSendThread, double& timestampSec)
+{
+  {
+    stringstream message;
+    message << "Starting to read frame archive " << to_string(index + 1) << "." << endl;
+    wrapper::invokeJsCallback(logCallback, message.str());
+  }
+  FrameArchiveReader reader(archivePath, true);
+  string error;
+  if (!reader.open(error))
+  {
+    wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+    return;
+  }
+
+  // Decode each frame straight from the mapped file into the pending frames queue.
+  // Archives are indexed by frame so starting part way through needs no seeking
+  uint32_t width = reader.getWidth(), height = reader.getHeight();
+  uint32_t fps = reader.getFps(), frameCount = reader.getFrameCount();
+  size_t frameLength = reader.getFrameLength();
+  shared_ptr<FramePool> framePool(new FramePool(frameLength,
+    getBufferedFrames(frameLength)));
+  uint32_t frameNumber = firstFrame;
+  while (!checkForExit() && (frameNumber < frameCount))
+  {
+    // Wait for a free buffer. This blocks while the queued frames hold them all
+    uint8_t* buffer = framePool->acquire(10);
+    if (buffer == nullptr)
+    {
+      continue;
+    }
+    shared_ptr<FrameWrapper> wrapper(new FrameWrapper(frameNumber));
+    wrapper->nativeFrame = buffer;
+    wrapper->framePool = framePool;
+    if (!reader.readFrame(frameNumber, wrapper->nativeFrame, error))
+    {
+      wrapper::invokeJsCallback(logCallback, "ERROR: " + error + "\n");
+      break;
+    }
+    wrapper->nativeLength = frameLength;
+    wrapper->nativeWidth = width;
+    wrapper->nativeHeight = height;
+    wrapper->timestampMs = (uint64_t)(timestampSec * 1000);
+    wrapper->fps = fps;
+    wrapper->videoIndex = index;
+    pendingFrameQueue->addItem(wrapper);
+    frameNumber += 1;
+    timestampSec += 1.0 / fps;
+
+    // Pass the preview channel name to the send thread
+    updatePreviewChannel(previewSendThread);
+  }
+  reader.close();
+  if (!checkForExit())
+  {
+    stringstream message;
+    message << "Reading of frame archive " << to_string(index + 1) << " complete." << endl;
+    wrapper::invokeJsCallback(logCallback, message.str());
+  }
+}
+
+void PlaybackThread::updatePreviewChannel(PreviewSendThread* previewSendThread)
+{
+  unique_lock<mutex> lock(channelMutex);
+  if (!channelName.empty())
+  {
+    previewSendThread->setPreviewChannel(channelName);
+    channelName.clear();
+  }
+}
@@ -1,11 +1,24 @@
 #pragma once
 
 #include <mutex>
+#include "FfmpegPlaybackProcess.h"
+#include "FrameCode.h"
+#include "FramePool.h"
 #include "FrameWrapper.h"
+#include "GammaTable.h"
+#include "PlaybackCache.h"
+#include "PreviewSendThread.h"
+#include "ProbeCache.h"
+#include "ProjectorThread.h"
+#include "SyncTracker.h"
 #include "Thread.h"
 #include "Queue.hpp"
 #include "Wrapper.h"
 
+// Default number of megabytes of decoded frames held between the decoders and the
+// projector
+#define DEFAULT_PLAYBACK_BUFFER_MEGABYTES 2048
+
 class PlaybackThread : public Thread
 {
 public:
@@ -16,13 +29,51 @@ public:
   virtual ~PlaybackThread() {};
 
   void setPreviewChannel(std::string channelName);
+  void setGammaTable(std::shared_ptr<GammaTable> gammaTable);
+  void setSyncTracker(std::shared_ptr<SyncTracker> syncTracker);
+  void setFrameCode(std::shared_ptr<FrameCode> frameCode);
+  void setDecoderLookahead(uint32_t videoCount);
+  void setProbeCache(std::shared_ptr<ProbeCache> probeCache);
+  void setPlaybackCache(std::shared_ptr<PlaybackCache> playbackCache);
+  void setBufferBytes(uint64_t bufferBytes);
+  void setDecodeToDisplay(bool decodeToDisplay);
+  void setStarvationPolicy(uint32_t starvationPolicy);
+  void setPresentationLogPath(std::string presentationLogPath);
+
+  // Starts playback part way through the playlist, either at a frame of one of the
+  // videos or at a time in milliseconds from the start of the first when the time isn't
+  // negative
+  void setStartPosition(uint32_t video, uint32_t frame, int64_t timeMs);
 
   uint32_t run() override;
 
   bool terminate(uint32_t timeout = 100) override;
 
 private:
+  // A video file being decoded by ffmpeg into its own pool of frame buffers
+  struct VideoDecoder
+  {
+    uint32_t index;
+    std::shared_ptr<FramePool> framePool;
+    std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> frameQueue;
+    FfmpegPlaybackProcess* process;
+  };
+
   std::string formatDuration(uint32_t duration);
+  bool probeVideos(std::vector<VideoInfo>& videoInfo);
+  bool resolveStartPosition(std::vector<uint32_t>& videoFps,
+    std::vector<uint32_t>& videoLengths, std::string& error);
+  double getFrameTime(std::string video, uint32_t frame, uint32_t fps);
+  uint32_t getBufferedFrames(size_t frameLength);
+  std::string getDisplayFilter(uint32_t width, uint32_t height, uint32_t displayWidth,
+    uint32_t displayHeight);
+  VideoDecoder startDecoder(uint32_t index, std::string video, uint32_t width,
+    uint32_t height, uint32_t fps, std::string videoFilter, uint32_t firstFrame);
+  void stopDecoder(VideoDecoder& decoder);
+  void readFrameArchive(uint32_t index, std::string archivePath, uint32_t firstFrame,
+    std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> pendingFrameQueue,
+    PreviewSendThread* previewSendThread, double& timestampSec);
+  void updatePreviewChannel(PreviewSendThread* previewSendThread);
 
 private:
   uint32_t x;
@@ -37,4 +88,17 @@ private:
   wrapper::JsCallback* delayCallback;
   std::string channelName;
   std::mutex channelMutex;
+  std::shared_ptr<GammaTable> gammaTable;
+  std::shared_ptr<SyncTracker> syncTracker;
+  std::shared_ptr<FrameCode> frameCode;
+  uint32_t decoderLookahead = 1;
+  std::shared_ptr<ProbeCache> probeCache;
+  std::shared_ptr<PlaybackCache> playbackCache;
+  uint64_t bufferBytes = (uint64_t)DEFAULT_PLAYBACK_BUFFER_MEGABYTES << 20;
+  bool decodeToDisplay = false;
+  uint32_t starvationPolicy = STARVATION_POLICY_DRIFT;
+  std::string presentationLogPath;
+  uint32_t startVideo = 0;
+  uint32_t startFrame = 0;
+  int64_t startTimeMs = -1;
 };
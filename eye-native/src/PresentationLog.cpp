@@ -0,0 +1,151 @@
+#include "PresentationLog.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+// Magic number and version used to identify presentation logs
+#define MAGIC_NUMBER 0x50455945
+#define VERSION 1
+
+// The .npy magic string and the length of the preamble before the header. The header
+// is padded so the data starts on a 64-byte boundary
+#define NPY_MAGIC "\x93NUMPY"
+#define NPY_MAGIC_LENGTH 6
+#define NPY_PREAMBLE_LENGTH 10
+#define NPY_ALIGNMENT 64
+
+static_assert(sizeof(PresentationRecord) == PRESENTATION_LOG_RECORD_SIZE,
+  "Presentation records must match the file layout");
+
+static bool exportCsv(vector<PresentationRecord>& records, string outputPath,
+  string& error)
+{
+  ofstream file(outputPath, ios::out | ios::trunc);
+  if (!file.is_open())
+  {
+    error = "Failed to create " + outputPath;
+    return false;
+  }
+  file << "video,frame,target_ms,present_us,delay_us,flags,held\n";
+  for (auto it = records.begin(); it != records.end(); ++it)
+  {
+    file << it->videoIndex << "," << it->frameNumber << "," << it->targetMs << "," <<
+      it->presentUsec << "," << it->delayUsec << "," << it->flags << "," <<
+      it->heldFrames << "\n";
+  }
+  file.close();
+  if (file.fail())
+  {
+    error = "Failed to write " + outputPath;
+    return false;
+  }
+  return true;
+}
+
+static bool exportNpy(vector<PresentationRecord>& records, string outputPath,
+  string& error)
+{
+  // Describe the records as a structured array whose fields match the file layout so
+  // they can be written as they are. The format requires the header to end with a
+  // newline
+  stringstream dictionary;
+  dictionary << "{'descr': [('video', '<u4'), ('frame', '<u4'), ('target_ms', '<u8'), "
+    "('present_us', '<u8'), ('delay_us', '<i8'), ('flags', '<u4'), ('held', '<u4')], "
+    "'fortran_order': False, 'shape': (" << records.size() << ",), }";
+  string header = dictionary.str();
+  size_t length = (NPY_PREAMBLE_LENGTH + header.size() + 1 + NPY_ALIGNMENT - 1) /
+    NPY_ALIGNMENT * NPY_ALIGNMENT;
+  header.resize(length - NPY_PREAMBLE_LENGTH - 1, ' ');
+  header += "\n";
+
+  // Prepend the magic string, version 1.0, and the little-endian header length
+  uint16_t headerLength = (uint16_t)header.size();
+  string preamble(NPY_MAGIC, NPY_MAGIC_LENGTH);
+  preamble += (char)1;
+  preamble += (char)0;
+  preamble += (char)(headerLength & 0xFF);
+  preamble += (char)(headerLength >> 8);
+
+  ofstream file(outputPath, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+  {
+    error = "Failed to create " + outputPath;
+    return false;
+  }
+  file << preamble << header;
+  file.write((const char*)records.data(), records.size() * PRESENTATION_LOG_RECORD_SIZE);
+  file.close();
+  if (file.fail())
+  {
+    error = "Failed to write " + outputPath;
+    return false;
+  }
+  return true;
+}
+
+void presentationlog::formatHeader(uint32_t refreshRate, uint8_t* buffer)
+{
+  uint32_t magicNumber = MAGIC_NUMBER, version = VERSION;
+  uint32_t recordSize = PRESENTATION_LOG_RECORD_SIZE;
+  memset(buffer, 0, PRESENTATION_LOG_HEADER_SIZE);
+  memcpy(&buffer[0], &magicNumber, sizeof(uint32_t));
+  memcpy(&buffer[4], &version, sizeof(uint32_t));
+  memcpy(&buffer[8], &recordSize, sizeof(uint32_t));
+  memcpy(&buffer[12], &refreshRate, sizeof(uint32_t));
+}
+
+bool presentationlog::read(string logPath, uint32_t& refreshRate,
+  vector<PresentationRecord>& records, string& error)
+{
+  ifstream file(logPath, ios::in | ios::binary);
+  if (!file.is_open())
+  {
+    error = "Failed to open " + logPath;
+    return false;
+  }
+  uint32_t header[PRESENTATION_LOG_HEADER_SIZE / sizeof(uint32_t)];
+  if (!file.read((char*)header, PRESENTATION_LOG_HEADER_SIZE) ||
+    (header[0] != MAGIC_NUMBER) || (header[1] != VERSION) ||
+    (header[2] != PRESENTATION_LOG_RECORD_SIZE))
+  {
+    error = "Invalid presentation log header in " + logPath;
+    return false;
+  }
+  refreshRate = header[3];
+
+  // Read every complete record. A partial record at the end is what's left when
+  // playback was cut short and is ignored
+  records.clear();
+  PresentationRecord record;
+  while (file.read((char*)&record, PRESENTATION_LOG_RECORD_SIZE))
+  {
+    records.push_back(record);
+  }
+  return true;
+}
+
+bool presentationlog::exportLog(string logPath, string outputPath, string& error)
+{
+  uint32_t refreshRate;
+  vector<PresentationRecord> records;
+  if (!read(logPath, refreshRate, records, error))
+  {
+    return false;
+  }
+  size_t dotPos = outputPath.find_last_of('.');
+  string extension = (dotPos == string::npos) ? "" : outputPath.substr(dotPos);
+  transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+  if (extension == ".csv")
+  {
+    return exportCsv(records, outputPath, error);
+  }
+  if (extension == ".npy")
+  {
+    return exportNpy(records, outputPath, error);
+  }
+  error = "Unknown export format " + extension;
+  return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// These functions read and export the presentation log, the record of when every frame
+// of a playback reached the projector. It's written by the PresentationLogWriter class
+// and is what lets neural recordings be aligned with the stimulus. The file is laid out
+// as follows:
+//
+// - Header (32 bytes):
+//   - Magic number (uint32_t)
+//   - Version (uint32_t)
+//   - Record size (uint32_t)
+//   - Refresh rate of the projector (uint32_t)
+//   - Reserved (16 bytes)
+// - Records (40 bytes each), one per frame shown or skipped:
+//   - Video index within the playlist (uint32_t)
+//   - Frame number within the video (uint32_t)
+//   - Target time from the start of the playlist in milliseconds (uint64_t)
+//   - Timing card timestamp of the present in microseconds (uint64_t), zero if skipped
+//   - Delay behind the playlist's timeline in microseconds (int64_t), zero if skipped
+//   - Flags (uint32_t)
+//   - Number of extra refreshes the previous frame was held for (uint32_t)
+//
+// Records are appended as playback runs and there's no record count, so a log cut
+// short by a crash can still be read up to its last complete record.
+
+// The number of bytes in the header and in each record
+#define PRESENTATION_LOG_HEADER_SIZE 32
+#define PRESENTATION_LOG_RECORD_SIZE 40
+
+// Record flags
+#define PRESENTATION_FLAG_SKIPPED 0x1
+#define PRESENTATION_FLAG_LATE 0x2
+#define PRESENTATION_FLAG_RESUMED 0x4
+#define PRESENTATION_FLAG_PATCH_LIT 0x8
+
+struct PresentationRecord
+{
+  uint32_t videoIndex;
+  uint32_t frameNumber;
+  uint64_t targetMs;
+  uint64_t presentUsec;
+  int64_t delayUsec;
+  uint32_t flags;
+  uint32_t heldFrames;
+};
+
+namespace presentationlog
+{
+  void formatHeader(uint32_t refreshRate, uint8_t* buffer);
+  bool read(std::string logPath, uint32_t& refreshRate,
+    std::vector<PresentationRecord>& records, std::string& error);
+
+  // Writes the records as CSV or as a NumPy structured array, chosen by the extension
+  // of the output path
+  bool exportLog(std::string logPath, std::string outputPath, std::string& error);
+}
@@ -0,0 +1,114 @@
+#include "PresentationLogWriter.h"
+#include "Platform.h"
+
+using namespace std;
+
+// Number of records the ring holds, a power of two. At 60 fps this covers about 18
+// minutes of playback without the disk being written
+#define RING_CAPACITY 65536
+
+// How often the thread writes the records that have accumulated
+#define FLUSH_INTERVAL_MS 50
+
+PresentationLogWriter::PresentationLogWriter(string path, uint32_t refresh) :
+  Thread("presentationlog"),
+  logPath(path),
+  refreshRate(refresh),
+  writeIndex(0),
+  readIndex(0),
+  droppedCount(0)
+{
+}
+
+bool PresentationLogWriter::open(string& error)
+{
+  // Allocate the ring up front so appending never allocates
+  ring.resize(RING_CAPACITY);
+  file.open(logPath, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+  {
+    error = "Failed to create " + logPath;
+    return false;
+  }
+  uint8_t header[PRESENTATION_LOG_HEADER_SIZE];
+  presentationlog::formatHeader(refreshRate, header);
+  file.write((const char*)header, PRESENTATION_LOG_HEADER_SIZE);
+  file.flush();
+  if (!file.good())
+  {
+    error = "Failed to write " + logPath;
+    return false;
+  }
+  return true;
+}
+
+void PresentationLogWriter::append(const PresentationRecord& record)
+{
+  // The release store publishes the record to the writer thread
+  uint64_t index = writeIndex.load(memory_order_relaxed);
+  if ((index - readIndex.load(memory_order_acquire)) >= RING_CAPACITY)
+  {
+    droppedCount.fetch_add(1, memory_order_relaxed);
+    return;
+  }
+  ring[index % RING_CAPACITY] = record;
+  writeIndex.store(index + 1, memory_order_release);
+}
+
+bool PresentationLogWriter::close(string& error)
+{
+  // Wait for the thread to write what it has rather than kill it partway through a
+  // write. It flushes once more on the way out, so the flush here only matters if it
+  // was never spawned
+  join();
+  if (!file.is_open())
+  {
+    return true;
+  }
+  bool success = flush();
+  file.close();
+  if (!success || file.fail())
+  {
+    error = "Failed to write " + logPath;
+    return false;
+  }
+  return true;
+}
+
+uint64_t PresentationLogWriter::getDroppedCount()
+{
+  return droppedCount.load(memory_order_relaxed);
+}
+
+uint32_t PresentationLogWriter::run()
+{
+  while (!checkForExit())
+  {
+    flush();
+    platform::sleep(FLUSH_INTERVAL_MS);
+  }
+  flush();
+  return 0;
+}
+
+bool PresentationLogWriter::flush()
+{
+  // Write everything published so far in at most two runs, split where the ring wraps,
+  // and then hand the slots back to the projector thread
+  uint64_t start = readIndex.load(memory_order_relaxed);
+  uint64_t end = writeIndex.load(memory_order_acquire);
+  while (start < end)
+  {
+    uint64_t offset = start % RING_CAPACITY;
+    uint64_t count = min(end - start, (uint64_t)RING_CAPACITY - offset);
+    file.write((const char*)&ring[offset], count * PRESENTATION_LOG_RECORD_SIZE);
+    start += count;
+  }
+  readIndex.store(end, memory_order_release);
+  file.flush();
+  if (!file.good())
+  {
+    writeFailed = true;
+  }
+  return !writeFailed;
+}
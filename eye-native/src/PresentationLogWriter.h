@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <vector>
+#include "PresentationLog.h"
+#include "Thread.h"
+
+// The PresentationLogWriter class streams presentation records to a log file without
+// ever making the projector thread wait. Records go into a preallocated ring that is
+// shared by exactly one producer, the projector thread, and one consumer, this thread,
+// so appending is a copy and an atomic store with no lock or allocation. This thread
+// wakes periodically and writes whatever has accumulated. If the disk stalls for long
+// enough to fill the ring, new records are counted as dropped rather than blocking.
+class PresentationLogWriter : public Thread
+{
+public:
+  PresentationLogWriter(std::string logPath, uint32_t refreshRate);
+  virtual ~PresentationLogWriter() {};
+
+  bool open(std::string& error);
+
+  // Called by the projector thread only
+  void append(const PresentationRecord& record);
+
+  // Waits for the thread to write the remaining records and closes the file
+  bool close(std::string& error);
+
+  uint64_t getDroppedCount();
+
+  uint32_t run() override;
+
+private:
+  bool flush();
+
+private:
+  std::string logPath;
+  uint32_t refreshRate;
+  std::ofstream file;
+  bool writeFailed = false;
+  std::vector<PresentationRecord> ring;
+  std::atomic<uint64_t> writeIndex;
+  std::atomic<uint64_t> readIndex;
+  std::atomic<uint64_t> droppedCount;
+};
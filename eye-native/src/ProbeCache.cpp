@@ -0,0 +1,142 @@
+#include "ProbeCache.h"
+#include "Platform.h"
+#include "json/json.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+using json = nlohmann::json;
+
+// Version of the cache file format. A file with any other version is ignored
+#define VERSION 1
+
+ProbeCache::ProbeCache(string path) :
+  cachePath(path)
+{
+}
+
+void ProbeCache::load()
+{
+  unique_lock<mutex> lock(cacheMutex);
+  entries.clear();
+  modified = false;
+  ifstream file(cachePath);
+  if (!file.is_open())
+  {
+    return;
+  }
+  stringstream text;
+  text << file.rdbuf();
+  json cache = json::parse(text.str(), nullptr, false);
+  if (cache.is_discarded() || !cache.is_object() || (cache.value("version", 0) != VERSION))
+  {
+    return;
+  }
+  auto videos = cache.find("videos");
+  if ((videos == cache.end()) || !videos->is_object())
+  {
+    return;
+  }
+  for (auto it = videos->begin(); it != videos->end(); ++it)
+  {
+    const json& video = it.value();
+    if (!video.is_object())
+    {
+      continue;
+    }
+    Entry entry;
+    entry.size = video.value("size", (uint64_t)0);
+    entry.modifiedTimeUsec = video.value("mtime", (uint64_t)0);
+    entry.info.width = video.value("width", 0u);
+    entry.info.height = video.value("height", 0u);
+    entry.info.fps = video.value("fps", 0u);
+    entry.info.frameCount = video.value("frameCount", 0u);
+    entry.info.durationUsec = video.value("durationUsec", (uint64_t)0);
+    entries[it.key()] = entry;
+  }
+}
+
+bool ProbeCache::save(string& error)
+{
+  unique_lock<mutex> lock(cacheMutex);
+  if (!modified)
+  {
+    return true;
+  }
+  json videos = json::object();
+  for (auto it = entries.begin(); it != entries.end(); ++it)
+  {
+    videos[it->first] = {
+      { "size", it->second.size },
+      { "mtime", it->second.modifiedTimeUsec },
+      { "width", it->second.info.width },
+      { "height", it->second.info.height },
+      { "fps", it->second.info.fps },
+      { "frameCount", it->second.info.frameCount },
+      { "durationUsec", it->second.info.durationUsec }
+    };
+  }
+  json cache = { { "version", VERSION }, { "videos", videos } };
+
+  // Write the whole cache to a temporary file and rename it into place so a concurrent
+  // reader never sees a partial file
+  string tempPath = cachePath + ".tmp";
+  {
+    ofstream file(tempPath, ios::out | ios::trunc);
+    if (!file.is_open())
+    {
+      error = "Failed to create " + tempPath;
+      return false;
+    }
+    file << cache.dump();
+    if (!file.good())
+    {
+      file.close();
+      platform::deleteFile(tempPath);
+      error = "Failed to write " + tempPath;
+      return false;
+    }
+  }
+  if (!platform::renameFile(tempPath, cachePath))
+  {
+    platform::deleteFile(tempPath);
+    error = "Failed to rename " + tempPath;
+    return false;
+  }
+  modified = false;
+  return true;
+}
+
+bool ProbeCache::lookup(string videoPath, VideoInfo& info)
+{
+  uint64_t size = 0, modifiedTimeUsec = 0;
+  if (!platform::getFileInfo(videoPath, size, modifiedTimeUsec))
+  {
+    return false;
+  }
+  unique_lock<mutex> lock(cacheMutex);
+  auto it = entries.find(videoPath);
+  if ((it == entries.end()) || (it->second.size != size) ||
+    (it->second.modifiedTimeUsec != modifiedTimeUsec))
+  {
+    return false;
+  }
+  info = it->second.info;
+  return true;
+}
+
+void ProbeCache::store(string videoPath, const VideoInfo& info)
+{
+  // Only complete results are worth remembering
+  Entry entry;
+  if ((info.width == 0) || (info.height == 0) || (info.fps == 0) ||
+    (info.frameCount == 0) ||
+    !platform::getFileInfo(videoPath, entry.size, entry.modifiedTimeUsec))
+  {
+    return;
+  }
+  entry.info = info;
+  unique_lock<mutex> lock(cacheMutex);
+  entries[videoPath] = entry;
+  modified = true;
+}
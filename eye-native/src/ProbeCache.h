@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "VideoInfo.h"
+
+// The ProbeCache class remembers the properties of video files that have been probed
+// so the same playlist can start again without running ffprobe on every file. Entries
+// are keyed by path and are only used while the size and modification time of the file
+// still match. The cache is kept in a JSON file that's rewritten in full, through a
+// temporary file and a rename, each time it's saved.
+class ProbeCache
+{
+public:
+  ProbeCache(std::string cachePath);
+  virtual ~ProbeCache() {};
+
+  // Loads the cache file. A missing or unreadable file leaves the cache empty
+  void load();
+
+  // Writes the cache file if anything has changed since it was loaded or last saved
+  bool save(std::string& error);
+
+  bool lookup(std::string videoPath, VideoInfo& info);
+  void store(std::string videoPath, const VideoInfo& info);
+
+private:
+  struct Entry
+  {
+    uint64_t size;
+    uint64_t modifiedTimeUsec;
+    VideoInfo info;
+  };
+
+  std::string cachePath;
+  std::unordered_map<std::string, Entry> entries;
+  bool modified = false;
+  std::mutex cacheMutex;
+};
@@ -1,13 +1,30 @@
 #include "ProjectorThread.h"
 #include "Platform.h"
+#include <cmath>
+#include <sstream>
 
 using namespace std;
 
+// The shortest preroll, which absorbs jitter in decoding even when the decoders are
+// much faster than the display
+#define MIN_PREROLL_MS 250
+
+// How long the decode rate is measured before it's trusted
+#define RATE_WINDOW_MS 500
+
+// Extra preroll on top of the estimate to cover variation in the decode rate
+#define PREROLL_MARGIN 1.25
+
+// How long the buffer may go without growing before a resumed playback carries on with
+// what it has, which happens when the last frames of the playlist have been decoded
+#define RESUME_IDLE_MS 1000
+
 ProjectorThread::ProjectorThread(int32_t xi, int32_t yi, bool scale,
     uint32_t refresh, shared_ptr<Queue<shared_ptr<FrameWrapper>>> inputQueue,
     shared_ptr<Queue<shared_ptr<FrameWrapper>>> outputQueue,
     wrapper::JsCallback* log, wrapper::JsCallback* position,
-    wrapper::JsCallback* delay) :
+    wrapper::JsCallback* delay, shared_ptr<GammaTable> table,
+    shared_ptr<SyncTracker> tracker, shared_ptr<FrameCode> code) :
   Thread("projector"),
   x(xi),
   y(yi),
@@ -17,8 +34,51 @@ ProjectorThread::ProjectorThread(int32_t xi, int32_t yi, bool scale,
   outputFrameQueue(outputQueue),
   logCallback(log),
   positionCallback(position),
-  delayCallback(delay)
+  delayCallback(delay),
+  gammaTable(table),
+  syncTracker(tracker),
+  frameCode(code)
+{
+}
+
+void ProjectorThread::setPreroll(uint64_t frames, uint32_t maxFrames)
+{
+  // Only called before the thread is spawned
+  totalFrames = frames;
+  maxPrerollFrames = maxFrames;
+}
+
+void ProjectorThread::setStarvationPolicy(uint32_t policy)
+{
+  // Only called before the thread is spawned
+  starvationPolicy = policy;
+}
+
+void ProjectorThread::setPresentationLog(shared_ptr<PresentationLogWriter> log)
+{
+  // Only called before the thread is spawned
+  presentationLog = log;
+}
+
+bool ProjectorThread::parseStarvationPolicy(string name, uint32_t& policy)
 {
+  if (name == "drift")
+  {
+    policy = STARVATION_POLICY_DRIFT;
+  }
+  else if (name == "drop")
+  {
+    policy = STARVATION_POLICY_DROP;
+  }
+  else if (name == "pause")
+  {
+    policy = STARVATION_POLICY_PAUSE;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
 }
 
 uint32_t ProjectorThread::run()
@@ -30,6 +90,15 @@ uint32_t ProjectorThread::run()
       error + "\n");
     return 1;
   }
+
+  // Listen for the photodiode events caused by the sync patch
+  shared_ptr<ExternalEventThread> eventThread(nullptr);
+  if (syncTracker != nullptr)
+  {
+    eventThread = shared_ptr<ExternalEventThread>(new ExternalEventThread(
+      syncTracker->getEventSource()));
+    eventThread->spawn();
+  }
   bool starting = true;
   while (!checkForExit())
   {
@@ -40,50 +109,286 @@ uint32_t ProjectorThread::run()
       continue;
     }
 
-    // Playback officially starts the first time we call displayProjectorFrame() below. Wait
-    // until we have two seconds worth of frames to prevent starvation during startup
-    if (starting)
+    // Playback officially starts the first time we call displayProjectorFrame() below.
+    // Buffer enough frames first that the playlist can play to the end without starving.
+    // The same happens when playback resumes after pausing to rebuild the buffer
+    bool resumed = resuming;
+    if (starting || resuming)
     {
-      uint32_t startThreshold = wrapper->fps * 2;
-      while ((inputFrameQueue->size() < startThreshold) && !checkForExit())
-      {
-        platform::sleep(5);
-      }
-      if (checkForExit())
+      uint64_t remainingFrames = (totalFrames > framesDone) ? (totalFrames - framesDone) : 1;
+      if (!waitForPreroll(wrapper->fps, remainingFrames, resuming))
       {
         continue;
       }
       starting = false;
+      resuming = false;
+    }
+
+    // Skip frames that playback has fallen too far behind to show
+    if (framesToSkip > 0)
+    {
+      skipFrame(wrapper);
+      continue;
+    }
+    logSkippedFrames();
+
+    // Correct the frame for this projector's transfer curve
+    if ((gammaTable != nullptr) && (wrapper->nativeFrame != 0))
+    {
+      gammaTable->apply(wrapper->nativeFrame, wrapper->nativeWidth,
+        wrapper->nativeHeight);
+    }
+
+    // Paint the frame code and sync patch last so their levels aren't corrected
+    if ((frameCode != nullptr) && (wrapper->nativeFrame != 0) &&
+      frameCode->fits(wrapper->nativeWidth, wrapper->nativeHeight))
+    {
+      frameCode->paint(wrapper->nativeFrame, wrapper->nativeWidth, wrapper->nativeHeight,
+        wrapper->number);
+    }
+    bool patchLit = false;
+    if (syncTracker != nullptr)
+    {
+      patchLit = syncTracker->paintPatch(wrapper);
     }
 
     // Display the frame on the projector. This function aligns with the monitor's
     // vsync signal and is the rate-limiting step in this thread
     uint64_t timestamp = 0;
-    int32_t delayMs = 0;
-    if (!platform::displayVideoFrame(wrapper, timestamp, delayMs, error))
+    if (!platform::displayVideoFrame(wrapper, timestamp, error))
     {
       wrapper::invokeJsCallback(logCallback, "ERROR: Failed to display projector frame: " +
         error + "\n");
+      stopEventThread(eventThread);
       platform::destroyProjectorWindow();
       return 1;
     }
 
-    // TODO: Save the frame timestamp to the run file
-    //fprintf(stderr, "Displayed frame %i at 0x%llx\n", wrapper->number, timestamp);
+    // Match the photodiode events that have arrived to the frames that caused them
+    if (syncTracker != nullptr)
+    {
+      syncTracker->addEvents(eventThread->getEvents());
+      syncTracker->framePresented(timestamp, patchLit, wrapper->fps);
+    }
+
+    // Compare the frame's presentation time with the video's timeline and apply the
+    // starvation policy if we've fallen behind
+    PresentationRecord record;
+    record.videoIndex = wrapper->videoIndex;
+    record.frameNumber = wrapper->number;
+    record.targetMs = wrapper->timestampMs;
+    record.presentUsec = timestamp;
+    record.flags = (patchLit ? PRESENTATION_FLAG_PATCH_LIT : 0) |
+      (resumed ? PRESENTATION_FLAG_RESUMED : 0);
+    framesDone += 1;
+    checkTiming(wrapper, timestamp, record);
+
+    // Hand the record to the presentation log, which writes it on its own thread
+    if (presentationLog != nullptr)
+    {
+      presentationLog->append(record);
+    }
 
     // Notify the UI of our progress and pass the frame to the output queue
     uint32_t durationMs = (int32_t)(1000.0 / (double)wrapper->fps) + 1;
     wrapper::invokeJsCallback(positionCallback, wrapper->timestampMs + durationMs);
-    if (delayMs != 0)
-    {
-      wrapper::invokeJsCallback(delayCallback, delayMs);
-    }
     outputFrameQueue->addItem(wrapper);
   }
+  stopEventThread(eventThread);
   platform::destroyProjectorWindow();
   return 0;
 }
 
+bool ProjectorThread::waitForPreroll(uint32_t fps, uint64_t remainingFrames, bool resuming)
+{
+  // Measure how fast frames arrive while waiting. If decoding keeps up with the display
+  // the shortest preroll is enough, and otherwise the queue has to hold the shortfall
+  // over the rest of the playlist before playback starts. The preroll can't exceed what
+  // the frame pool holds, in which case playback starts with a full buffer
+  uint32_t minFrames = max((uint32_t)2, fps * MIN_PREROLL_MS / 1000);
+  uint64_t limit = min((uint64_t)maxPrerollFrames, remainingFrames);
+  if (totalFrames == 0)
+  {
+    // Fall back to two seconds if the length of the playlist isn't known
+    limit = (uint64_t)fps * 2;
+  }
+  uint64_t startUsec = platform::readTimestampUsec();
+  uint32_t startCount = inputFrameQueue->size() + 1;
+  uint64_t required = limit;
+  double decodeRate = 0;
+  uint32_t lastQueued = startCount;
+  uint64_t lastGrowthUsec = startUsec;
+  while (!checkForExit())
+  {
+    uint32_t queued = inputFrameQueue->size() + 1;
+    if (queued >= limit)
+    {
+      break;
+    }
+    uint64_t nowUsec = platform::readTimestampUsec();
+    if (queued != lastQueued)
+    {
+      lastQueued = queued;
+      lastGrowthUsec = nowUsec;
+    }
+    else if (resuming && ((nowUsec - lastGrowthUsec) >= (RESUME_IDLE_MS * 1000)))
+    {
+      break;
+    }
+    uint64_t elapsedUsec = nowUsec - startUsec;
+    if (elapsedUsec >= (RATE_WINDOW_MS * 1000))
+    {
+      decodeRate = (double)(queued - startCount) * 1000000.0 / (double)elapsedUsec;
+      double shortfall = max(0.0, 1.0 - decodeRate / (double)fps);
+      required = max((uint64_t)minFrames,
+        (uint64_t)ceil((double)remainingFrames * shortfall * PREROLL_MARGIN));
+      if (queued >= required)
+      {
+        break;
+      }
+    }
+    platform::sleep(5);
+  }
+  if (checkForExit())
+  {
+    return false;
+  }
+  stringstream message;
+  message << (resuming ? "Resuming" : "Starting") << " playback after buffering " <<
+    (inputFrameQueue->size() + 1) << " frames";
+  if (decodeRate > 0)
+  {
+    message << " (decoding at " << (uint32_t)decodeRate << " fps)";
+  }
+  message << "." << endl;
+  if (required > limit)
+  {
+    message << "WARNING: Decoding is too slow to play to the end without stalling." <<
+      endl;
+  }
+  wrapper::invokeJsCallback(logCallback, message.str());
+  return true;
+}
+
+void ProjectorThread::checkTiming(shared_ptr<FrameWrapper> wrapper, uint64_t timestamp,
+  PresentationRecord& record)
+{
+  // Log every frame that stayed on the screen for longer than it should have, which
+  // happens when the next frame wasn't ready in time. Frame numbers are within each
+  // video and times are from the start of the playlist
+  double periodMs = 1000.0 / (double)wrapper->fps;
+  record.heldFrames = 0;
+  if ((lastPresentUsec != 0) && (timestamp > lastPresentUsec))
+  {
+    double intervalMs = (double)(timestamp - lastPresentUsec) / 1000;
+    int64_t heldFrames = llround(intervalMs / lastPeriodMs) - 1;
+    if (heldFrames > 0)
+    {
+      record.flags |= PRESENTATION_FLAG_LATE;
+      record.heldFrames = (uint32_t)heldFrames;
+      stringstream message;
+      message << "WARNING: The frame before frame " << wrapper->number << " (" <<
+        wrapper->timestampMs << " ms) was shown for " << heldFrames << " extra frame" <<
+        ((heldFrames == 1) ? "" : "s") << "." << endl;
+      wrapper::invokeJsCallback(logCallback, message.str());
+    }
+  }
+  lastPresentUsec = timestamp;
+  lastPeriodMs = periodMs;
+
+  // The delay is how far behind the video's own timeline the projector is overall
+  if (firstPresentUsec == 0)
+  {
+    firstPresentUsec = timestamp;
+    firstTimestampMs = wrapper->timestampMs;
+  }
+  double delayMs = (double)(timestamp - firstPresentUsec) / 1000 -
+    (double)(wrapper->timestampMs - firstTimestampMs);
+  record.delayUsec = (int64_t)llround(delayMs * 1000);
+  int32_t reportedDelayMs = (int32_t)max(0.0, delayMs);
+  if ((reportedDelayMs != 0) || (lastDelayMs != 0))
+  {
+    wrapper::invokeJsCallback(delayCallback, reportedDelayMs);
+  }
+  lastDelayMs = reportedDelayMs;
+
+  // Act on whole frames of lateness since playback last resumed
+  if (resumePresentUsec == 0)
+  {
+    resumePresentUsec = timestamp;
+    resumeTimestampMs = wrapper->timestampMs;
+  }
+  double lateMs = (double)(timestamp - resumePresentUsec) / 1000 -
+    (double)(wrapper->timestampMs - resumeTimestampMs);
+  uint32_t framesBehind = (lateMs > 0) ? (uint32_t)floor(lateMs / periodMs) : 0;
+  if (framesBehind == 0)
+  {
+    return;
+  }
+  if (starvationPolicy == STARVATION_POLICY_DROP)
+  {
+    framesToSkip = framesBehind;
+  }
+  else if (starvationPolicy == STARVATION_POLICY_PAUSE)
+  {
+    // Hold this frame while the buffer is built up again and then measure lateness from
+    // the first frame after the pause
+    wrapper::invokeJsCallback(logCallback,
+      "WARNING: Pausing playback to rebuild the frame buffer.\n");
+    resuming = true;
+    resumePresentUsec = 0;
+  }
+}
+
+void ProjectorThread::skipFrame(shared_ptr<FrameWrapper> wrapper)
+{
+  // The frame is released without being shown or previewed but still gets a record in
+  // the presentation log. Runs of skipped frames are logged together once the next
+  // frame is shown
+  if (skippedCount == 0)
+  {
+    skippedFirstNumber = wrapper->number;
+    skippedFirstTimestampMs = wrapper->timestampMs;
+  }
+  skippedCount += 1;
+  framesToSkip -= 1;
+  framesDone += 1;
+  if (presentationLog != nullptr)
+  {
+    PresentationRecord record;
+    record.videoIndex = wrapper->videoIndex;
+    record.frameNumber = wrapper->number;
+    record.targetMs = wrapper->timestampMs;
+    record.presentUsec = 0;
+    record.delayUsec = 0;
+    record.flags = PRESENTATION_FLAG_SKIPPED;
+    record.heldFrames = 0;
+    presentationLog->append(record);
+  }
+}
+
+void ProjectorThread::logSkippedFrames()
+{
+  if (skippedCount == 0)
+  {
+    return;
+  }
+  stringstream message;
+  message << "WARNING: Skipped " << skippedCount << " frame" <<
+    ((skippedCount == 1) ? "" : "s") << " starting at frame " << skippedFirstNumber <<
+    " (" << skippedFirstTimestampMs << " ms) to catch up." << endl;
+  wrapper::invokeJsCallback(logCallback, message.str());
+  skippedCount = 0;
+}
+
+void ProjectorThread::stopEventThread(shared_ptr<ExternalEventThread> eventThread)
+{
+  if ((eventThread != nullptr) && eventThread->isRunning())
+  {
+    eventThread->terminate();
+  }
+}
+
 bool ProjectorThread::terminate(uint32_t timeout /*= 100*/)
 {
   // It can take longer than 100 ms for the projector thread to shut down so
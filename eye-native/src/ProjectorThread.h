@@ -1,11 +1,24 @@
 #pragma once
 
 #include <mutex>
+#include "ExternalEventThread.h"
+#include "FrameCode.h"
 #include "FrameWrapper.h"
+#include "GammaTable.h"
+#include "PresentationLogWriter.h"
+#include "SyncTracker.h"
 #include "Thread.h"
 #include "Queue.hpp"
 #include "Wrapper.h"
 
+// What the projector does once it has fallen behind the video because frames weren't
+// decoded in time. Drift carries on from where it is, leaving the rest of the playlist
+// late. Drop skips frames until playback is back on its original timeline. Pause holds
+// the current frame until the buffer has been built up again and then carries on
+#define STARVATION_POLICY_DRIFT 0
+#define STARVATION_POLICY_DROP 1
+#define STARVATION_POLICY_PAUSE 2
+
 class ProjectorThread : public Thread
 {
 public:
@@ -13,13 +26,29 @@ public:
     std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> inputFrameQueue,
     std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue,
     wrapper::JsCallback* logCallback, wrapper::JsCallback* positionCallback,
-    wrapper::JsCallback* delayCallback);
+    wrapper::JsCallback* delayCallback, std::shared_ptr<GammaTable> gammaTable,
+    std::shared_ptr<SyncTracker> syncTracker, std::shared_ptr<FrameCode> frameCode);
   virtual ~ProjectorThread() {};
 
+  void setPreroll(uint64_t totalFrames, uint32_t maxPrerollFrames);
+  void setStarvationPolicy(uint32_t starvationPolicy);
+  void setPresentationLog(std::shared_ptr<PresentationLogWriter> presentationLog);
+
+  // Parses "drift", "drop", or "pause" into a starvation policy
+  static bool parseStarvationPolicy(std::string name, uint32_t& starvationPolicy);
+
   uint32_t run() override;
 
   bool terminate(uint32_t timeout = 100) override;
 
+private:
+  bool waitForPreroll(uint32_t fps, uint64_t remainingFrames, bool resuming);
+  void checkTiming(std::shared_ptr<FrameWrapper> wrapper, uint64_t timestamp,
+    PresentationRecord& record);
+  void skipFrame(std::shared_ptr<FrameWrapper> wrapper);
+  void logSkippedFrames();
+  void stopEventThread(std::shared_ptr<ExternalEventThread> eventThread);
+
 private:
   int32_t x;
   int32_t y;
@@ -30,4 +59,29 @@ private:
   wrapper::JsCallback* logCallback;
   wrapper::JsCallback* positionCallback;
   wrapper::JsCallback* delayCallback;
+  std::shared_ptr<GammaTable> gammaTable;
+  std::shared_ptr<SyncTracker> syncTracker;
+  std::shared_ptr<FrameCode> frameCode;
+  uint64_t totalFrames = 0;
+  uint32_t maxPrerollFrames = 0;
+  uint32_t starvationPolicy = STARVATION_POLICY_DRIFT;
+  std::shared_ptr<PresentationLogWriter> presentationLog;
+
+  // Playback timeline. The delay is measured from the first frame and the lateness that
+  // the policy acts on from the last time playback resumed
+  uint64_t framesDone = 0;
+  uint64_t firstPresentUsec = 0;
+  uint64_t firstTimestampMs = 0;
+  uint64_t resumePresentUsec = 0;
+  uint64_t resumeTimestampMs = 0;
+  uint64_t lastPresentUsec = 0;
+  double lastPeriodMs = 0;
+  int32_t lastDelayMs = 0;
+  bool resuming = false;
+
+  // Frames still to be skipped to catch up and the run of frames skipped so far
+  uint32_t framesToSkip = 0;
+  uint32_t skippedCount = 0;
+  uint32_t skippedFirstNumber = 0;
+  uint64_t skippedFirstTimestampMs = 0;
 };
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "FrameWrapper.h"
+
+// The RecordStage class is the interface for optional steps that the record thread runs
+// on every frame in addition to encoding it with ffmpeg. Stages are opened once the
+// output dimensions are known, passed each frame in order after it has been written to
+// ffmpeg, and closed when recording ends. The frame data is always BGRA at the output
+// dimensions. A stage that fails is closed and removed without stopping the recording.
+class RecordStage
+{
+public:
+  RecordStage(std::string name) :
+    stageName(name)
+  {
+  };
+  virtual ~RecordStage() {};
+
+  std::string getName()
+  {
+    return stageName;
+  }
+
+  virtual bool open(uint32_t width, uint32_t height, uint32_t fps, std::string& error) = 0;
+  virtual bool processFrame(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length, std::string& error) = 0;
+  virtual bool close(std::string& error) = 0;
+
+protected:
+  std::string stageName;
+};
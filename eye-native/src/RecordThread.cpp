@@ -1,6 +1,8 @@
 #include "RecordThread.h"
 #include "FfmpegRecordProcess.h"
 #include "PreviewSendThread.h"
+#include "SeekIndex.h"
+#include <cstring>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -10,7 +12,8 @@ using namespace cv;
 
 RecordThread::RecordThread(shared_ptr<Queue<shared_ptr<FrameWrapper>>> inputQueue,
     shared_ptr<Queue<shared_ptr<FrameWrapper>>> outputQueue, string ffmpeg, uint32_t wid,
-    uint32_t hgt, uint32_t f, string output) :
+    uint32_t hgt, uint32_t f, string output, vector<pair<uint32_t, uint32_t>> boundaries,
+    vector<shared_ptr<RecordStage>> recordStages, bool dry /*= false*/) :
   Thread("record"),
   inputFrameQueue(inputQueue),
   outputFrameQueue(outputQueue),
@@ -18,7 +21,11 @@ RecordThread::RecordThread(shared_ptr<Queue<shared_ptr<FrameWrapper>>> inputQueu
   width(wid),
   height(hgt),
   fps(f),
-  outputPath(output)
+  outputPath(output),
+  stimulusBoundaries(boundaries),
+  stages(recordStages),
+  dryRun(dry),
+  recordedCount(0)
 {
 }
 
@@ -28,12 +35,46 @@ void RecordThread::setPreviewChannel(string name)
   channelName = name;
 }
 
+void RecordThread::setGammaTable(shared_ptr<GammaTable> table)
+{
+  // Only called before the thread is spawned
+  gammaTable = table;
+}
+
+void RecordThread::setFrameCode(shared_ptr<FrameCode> code)
+{
+  // Only called before the thread is spawned
+  frameCode = code;
+}
+
+void RecordThread::addStimulusBoundary(uint32_t stimulusId, uint32_t frameNumber)
+{
+  unique_lock<mutex> lock(boundaryMutex);
+  stimulusBoundaries.push_back(make_pair(stimulusId, frameNumber));
+}
+
 uint32_t RecordThread::run()
 {
-  // Spawn the ffmpeg process
+  if (dryRun)
+  {
+    return runDry();
+  }
+
+  // Spawn the ffmpeg process and ask it to place a key frame at the start of each
+  // stimulus we know about. Boundaries added after this point will still be indexed
+  // but will have to seek from the preceding key frame
+  vector<uint32_t> keyFrames;
+  {
+    unique_lock<mutex> lock(boundaryMutex);
+    for (auto it = stimulusBoundaries.begin(); it != stimulusBoundaries.end(); ++it)
+    {
+      keyFrames.push_back(it->second);
+    }
+  }
   FfmpegRecordProcess* ffmpegProcess = new FfmpegRecordProcess(ffmpegPath,
-    width, height, fps, outputPath);
+    width, height, fps, outputPath, keyFrames);
   ffmpegProcess->spawn();
+  openStages();
 
   // Create the preview frame queue and spawn the preview send thread
   shared_ptr<Queue<shared_ptr<FrameWrapper>>> previewFrameQueue(
@@ -65,13 +106,20 @@ uint32_t RecordThread::run()
       length = wrapper->electronLength;
     }
 
-    // Write the raw frame to the ffmpeg process
+    // Number the frame within this recording, correct it for the projector, add the
+    // frame code, and write it to the ffmpeg process
+    wrapper->recordIndex = recordedCount++;
+    correctFrame(wrapper, data, length);
+    data = paintFrameCode(wrapper, data, length);
     if (!ffmpegProcess->writeStdin(data, length))
     {
       printf("[FrameThread] ERROR: Failed to write to FFmpeg\n");
       break;
     }
 
+    // Run the optional record stages on the frame
+    processStages(wrapper, data, length);
+
     // Pass the preview channel name and frame to the send thread
     {
       unique_lock<mutex> lock(channelMutex);
@@ -90,6 +138,8 @@ uint32_t RecordThread::run()
     ffmpegProcess->waitForExit();
   }
   delete ffmpegProcess;
+  closeStages();
+  writeSeekIndex();
   if (previewSendThread->isRunning())
   {
     previewSendThread->terminate();
@@ -98,3 +148,152 @@ uint32_t RecordThread::run()
   previewFrameQueue = nullptr;
   return 0;
 }
+
+uint32_t RecordThread::runDry()
+{
+  openStages();
+  while (!checkForExit())
+  {
+    shared_ptr<FrameWrapper> wrapper;
+    if (!inputFrameQueue->waitItem(&wrapper, 10))
+    {
+      continue;
+    }
+    uint8_t* data = (wrapper->nativeFrame != 0) ? wrapper->nativeFrame :
+      wrapper->electronFrame;
+    uint32_t length = (wrapper->nativeFrame != 0) ? wrapper->nativeLength :
+      wrapper->electronLength;
+    wrapper->recordIndex = recordedCount++;
+    correctFrame(wrapper, data, length);
+    data = paintFrameCode(wrapper, data, length);
+    processStages(wrapper, data, length);
+    outputFrameQueue->addItem(wrapper);
+  }
+  closeStages();
+  return 0;
+}
+
+void RecordThread::finish()
+{
+  signalExit();
+}
+
+void RecordThread::correctFrame(shared_ptr<FrameWrapper> wrapper, uint8_t* data,
+  size_t length)
+{
+  // Frames are corrected in place. A frame that shares the buffer of the frame it
+  // repeats has already been corrected
+  if ((gammaTable == nullptr) || (wrapper->sourceFrame != nullptr) ||
+    (length != ((size_t)width * height * 4)))
+  {
+    return;
+  }
+  gammaTable->apply(data, width, height);
+}
+
+uint8_t* RecordThread::paintFrameCode(shared_ptr<FrameWrapper> wrapper, uint8_t* data,
+  size_t length)
+{
+  if ((frameCode == nullptr) || (length != ((size_t)width * height * 4)))
+  {
+    return data;
+  }
+
+  // The code differs on every frame so a frame that shares the buffer of the frame it
+  // repeats gets a copy of its own first. The shared buffer may still be being read by
+  // the preview send thread. The frame is no longer a repeat as far as the stages are
+  // concerned
+  if (wrapper->sourceFrame != nullptr)
+  {
+    uint8_t* copy = new uint8_t[length];
+    memcpy(copy, data, length);
+    wrapper->nativeFrame = copy;
+    wrapper->framePool = nullptr;
+    wrapper->sourceFrame = nullptr;
+    data = copy;
+  }
+  frameCode->paint(data, width, height, wrapper->recordIndex);
+  wrapper->repeatFrame = false;
+  return data;
+}
+
+void RecordThread::openStages()
+{
+  // Open each stage and drop any that fail
+  auto it = stages.begin();
+  while (it != stages.end())
+  {
+    string error;
+    if (!(*it)->open(width, height, fps, error))
+    {
+      fprintf(stderr, "[RecordThread] ERROR: Failed to open %s stage: %s\n",
+        (*it)->getName().c_str(), error.c_str());
+      it = stages.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void RecordThread::processStages(shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+  size_t length)
+{
+  // Pass the frame to each stage. A stage that fails is closed and dropped so it
+  // doesn't interrupt the recording
+  auto it = stages.begin();
+  while (it != stages.end())
+  {
+    string error;
+    if (!(*it)->processFrame(wrapper, data, length, error))
+    {
+      fprintf(stderr, "[RecordThread] ERROR: %s stage failed on frame %u: %s\n",
+        (*it)->getName().c_str(), wrapper->recordIndex, error.c_str());
+      (*it)->close(error);
+      it = stages.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void RecordThread::closeStages()
+{
+  for (auto it = stages.begin(); it != stages.end(); ++it)
+  {
+    string error;
+    if (!(*it)->close(error))
+    {
+      fprintf(stderr, "[RecordThread] ERROR: Failed to close %s stage: %s\n",
+        (*it)->getName().c_str(), error.c_str());
+    }
+  }
+  stages.clear();
+}
+
+void RecordThread::writeSeekIndex()
+{
+  // Nothing to do if no stimulus boundaries were marked
+  vector<pair<uint32_t, uint32_t>> boundaries;
+  {
+    unique_lock<mutex> lock(boundaryMutex);
+    boundaries = stimulusBoundaries;
+  }
+  if (boundaries.empty())
+  {
+    return;
+  }
+
+  // Read the sample tables from the finished video and write the index next to it
+  string error;
+  vector<SeekIndexEntry> entries;
+  if (!seekindex::build(outputPath, boundaries, entries, error) ||
+    !seekindex::write(seekindex::getIndexPath(outputPath), fps, entries, error))
+  {
+    fprintf(stderr, "[RecordThread] ERROR: Failed to write seek index: %s\n",
+      error.c_str());
+  }
+}
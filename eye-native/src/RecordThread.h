@@ -1,22 +1,50 @@
 #pragma once
 
 #include <mutex>
+#include <vector>
+#include "FrameCode.h"
 #include "FrameWrapper.h"
+#include "GammaTable.h"
 #include "Queue.hpp"
+#include "RecordStage.h"
 #include "Thread.h"
 
+// The RecordThread class feeds queued frames to ffmpeg, runs the optional record stages
+// on them, and passes them on to the preview send thread. In a dry run frames are only
+// passed to the record stages and completed straight away, with no ffmpeg process, no
+// preview, and no seek index, so a program can be analyzed as fast as it's rendered.
 class RecordThread : public Thread
 {
 public:
   RecordThread(std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> inputFrameQueue,
     std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> outputFrameQueue,
     std::string ffmpegPath, uint32_t width, uint32_t height, uint32_t fps,
-    std::string outputPath);
+    std::string outputPath, std::vector<std::pair<uint32_t, uint32_t>> stimulusBoundaries,
+    std::vector<std::shared_ptr<RecordStage>> stages, bool dryRun = false);
   virtual ~RecordThread() {};
 
   void setPreviewChannel(std::string channelName);
+  void setGammaTable(std::shared_ptr<GammaTable> gammaTable);
+  void setFrameCode(std::shared_ptr<FrameCode> frameCode);
+  void addStimulusBoundary(uint32_t stimulusId, uint32_t frameNumber);
 
-  uint32_t run();
+  // Asks the thread to stop taking frames and finish the recording in the background.
+  // Wait for it with join() and never kill it, which would leave the video and the
+  // record stage outputs truncated
+  void finish();
+
+  uint32_t run() override;
+
+private:
+  uint32_t runDry();
+  void correctFrame(std::shared_ptr<FrameWrapper> wrapper, uint8_t* data, size_t length);
+  uint8_t* paintFrameCode(std::shared_ptr<FrameWrapper> wrapper, uint8_t* data,
+    size_t length);
+  void openStages();
+  void processStages(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length);
+  void closeStages();
+  void writeSeekIndex();
 
 private:
   std::shared_ptr<Queue<std::shared_ptr<FrameWrapper>>> inputFrameQueue;
@@ -28,4 +56,11 @@ private:
   std::string outputPath;
   std::string channelName;
   std::mutex channelMutex;
+  std::vector<std::pair<uint32_t, uint32_t>> stimulusBoundaries;
+  std::mutex boundaryMutex;
+  std::vector<std::shared_ptr<RecordStage>> stages;
+  bool dryRun;
+  uint32_t recordedCount;
+  std::shared_ptr<GammaTable> gammaTable;
+  std::shared_ptr<FrameCode> frameCode;
 };
@@ -0,0 +1,122 @@
+#include "SeekIndex.h"
+#include "Mp4Reader.h"
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+// Magic number and version used to identify seek index files
+#define MAGIC_NUMBER 0x4B534545
+#define VERSION 1
+
+string seekindex::getIndexPath(string videoPath)
+{
+  // Replace the extension of the video file, if any, with ".seek"
+  size_t dotPos = videoPath.find_last_of('.');
+  size_t slashPos = videoPath.find_last_of("/\\");
+  if ((dotPos != string::npos) && ((slashPos == string::npos) || (dotPos > slashPos)))
+  {
+    return videoPath.substr(0, dotPos) + ".seek";
+  }
+  return videoPath + ".seek";
+}
+
+bool seekindex::build(string videoPath, vector<pair<uint32_t, uint32_t>> boundaries,
+  vector<SeekIndexEntry>& entries, string& error)
+{
+  // Read the sample tables from the video file
+  Mp4Reader reader(videoPath);
+  if (!reader.parse(error))
+  {
+    return false;
+  }
+  vector<Mp4Sample>& samples = reader.getSamples();
+  double usecPerTick = 1000000.0 / (double)reader.getTimescale();
+
+  // Locate the key frame that precedes the start of each stimulus
+  entries.clear();
+  for (auto it = boundaries.begin(); it != boundaries.end(); ++it)
+  {
+    uint32_t frameNumber = it->second;
+    if (frameNumber >= samples.size())
+    {
+      continue;
+    }
+    SeekIndexEntry entry;
+    entry.stimulusId = it->first;
+    entry.frameNumber = frameNumber;
+    entry.keyFrameNumber = reader.findSyncSample(frameNumber);
+    entry.byteOffset = samples[entry.keyFrameNumber].offset;
+    entry.ptsUsec = (int64_t)((double)samples[frameNumber].pts * usecPerTick);
+    entries.push_back(entry);
+  }
+  return true;
+}
+
+bool seekindex::write(string indexPath, uint32_t fps, vector<SeekIndexEntry>& entries,
+  string& error)
+{
+  ofstream file(indexPath, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+  {
+    error = "Failed to create " + indexPath;
+    return false;
+  }
+  uint32_t header[4] = { MAGIC_NUMBER, VERSION, fps, (uint32_t)entries.size() };
+  file.write((const char*)header, SEEK_INDEX_HEADER_SIZE);
+  for (auto it = entries.begin(); it != entries.end(); ++it)
+  {
+    uint8_t record[SEEK_INDEX_ENTRY_SIZE];
+    uint32_t reserved = 0;
+    memcpy(&record[0], &it->stimulusId, sizeof(uint32_t));
+    memcpy(&record[4], &it->frameNumber, sizeof(uint32_t));
+    memcpy(&record[8], &it->keyFrameNumber, sizeof(uint32_t));
+    memcpy(&record[12], &reserved, sizeof(uint32_t));
+    memcpy(&record[16], &it->byteOffset, sizeof(uint64_t));
+    memcpy(&record[24], &it->ptsUsec, sizeof(int64_t));
+    file.write((const char*)record, SEEK_INDEX_ENTRY_SIZE);
+  }
+  if (!file.good())
+  {
+    error = "Failed to write " + indexPath;
+    return false;
+  }
+  return true;
+}
+
+bool seekindex::read(string indexPath, uint32_t& fps, vector<SeekIndexEntry>& entries,
+  string& error)
+{
+  ifstream file(indexPath, ios::in | ios::binary);
+  if (!file.is_open())
+  {
+    error = "Failed to open " + indexPath;
+    return false;
+  }
+  uint32_t header[4];
+  if (!file.read((char*)header, SEEK_INDEX_HEADER_SIZE) || (header[0] != MAGIC_NUMBER) ||
+    (header[1] != VERSION))
+  {
+    error = "Invalid seek index header in " + indexPath;
+    return false;
+  }
+  fps = header[2];
+  entries.clear();
+  for (uint32_t i = 0; i < header[3]; ++i)
+  {
+    uint8_t record[SEEK_INDEX_ENTRY_SIZE];
+    if (!file.read((char*)record, SEEK_INDEX_ENTRY_SIZE))
+    {
+      error = "Truncated seek index " + indexPath;
+      return false;
+    }
+    SeekIndexEntry entry;
+    memcpy(&entry.stimulusId, &record[0], sizeof(uint32_t));
+    memcpy(&entry.frameNumber, &record[4], sizeof(uint32_t));
+    memcpy(&entry.keyFrameNumber, &record[8], sizeof(uint32_t));
+    memcpy(&entry.byteOffset, &record[16], sizeof(uint64_t));
+    memcpy(&entry.ptsUsec, &record[24], sizeof(int64_t));
+    entries.push_back(entry);
+  }
+  return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// These functions build, save, and load the seek index that is written next to each
+// recorded video. The index maps the first frame of every stimulus to the location in
+// the video file where decoding must begin to display it. The file is laid out as
+// follows:
+//
+// - Magic number (uint32_t)
+// - Version (uint32_t)
+// - Frame rate (uint32_t)
+// - Entry count (uint32_t)
+// - Entries (32 bytes each):
+//   - Stimulus ID (uint32_t)
+//   - Frame number (uint32_t)
+//   - Key frame number (uint32_t), the sync frame at or before the frame number
+//   - Reserved (uint32_t)
+//   - Byte offset of the key frame in the video file (uint64_t)
+//   - Presentation timestamp of the frame in microseconds (int64_t)
+
+// The number of bytes in the seek index header and in each entry
+#define SEEK_INDEX_HEADER_SIZE 16
+#define SEEK_INDEX_ENTRY_SIZE 32
+
+struct SeekIndexEntry
+{
+  uint32_t stimulusId;
+  uint32_t frameNumber;
+  uint32_t keyFrameNumber;
+  uint64_t byteOffset;
+  int64_t ptsUsec;
+};
+
+namespace seekindex
+{
+  std::string getIndexPath(std::string videoPath);
+
+  bool build(std::string videoPath, std::vector<std::pair<uint32_t, uint32_t>> boundaries,
+    std::vector<SeekIndexEntry>& entries, std::string& error);
+  bool write(std::string indexPath, uint32_t fps, std::vector<SeekIndexEntry>& entries,
+    std::string& error);
+  bool read(std::string indexPath, uint32_t& fps, std::vector<SeekIndexEntry>& entries,
+    std::string& error);
+}
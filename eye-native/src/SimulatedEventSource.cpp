@@ -0,0 +1,76 @@
+#include "SimulatedEventSource.h"
+#include "Platform.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+SimulatedEventSource::SimulatedEventSource(double latencyMs, double jitterMs,
+    double miss, uint32_t seed) :
+  latencyUsec(latencyMs * 1000),
+  jitterUsec(jitterMs * 1000),
+  missRate(miss),
+  generator(seed)
+{
+}
+
+bool SimulatedEventSource::start()
+{
+  unique_lock<mutex> lock(eventMutex);
+  events.clear();
+  lastLit = false;
+  return true;
+}
+
+bool SimulatedEventSource::waitForEvent(uint32_t timeoutMs, uint64_t& eventTimestampUsec)
+{
+  // Hold each event until the time it would have been detected
+  unique_lock<mutex> lock(eventMutex);
+  uint64_t deadline = platform::readTimestampUsec() + (uint64_t)timeoutMs * 1000;
+  while (true)
+  {
+    uint64_t now = platform::readTimestampUsec();
+    if (!events.empty() && (events.front() <= now))
+    {
+      eventTimestampUsec = events.front();
+      events.pop_front();
+      return true;
+    }
+    if (now >= deadline)
+    {
+      return false;
+    }
+    uint64_t waitUsec = deadline - now;
+    if (!events.empty())
+    {
+      waitUsec = min(waitUsec, events.front() - now);
+    }
+    eventReady.wait_for(lock, chrono::microseconds(waitUsec));
+  }
+}
+
+void SimulatedEventSource::stop()
+{
+}
+
+void SimulatedEventSource::framePresented(uint64_t timestampUsec, bool patchLit)
+{
+  {
+    unique_lock<mutex> lock(eventMutex);
+    bool onset = patchLit && !lastLit;
+    lastLit = patchLit;
+    if (!onset)
+    {
+      return;
+    }
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    normal_distribution<double> normal(0.0, 1.0);
+    if (uniform(generator) < missRate)
+    {
+      return;
+    }
+    double delay = max(latencyUsec + normal(generator) * jitterUsec, 0.0);
+    events.push_back(timestampUsec + (uint64_t)delay);
+  }
+  eventReady.notify_all();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include "ExternalEventSource.h"
+
+// The SimulatedEventSource class stands in for a photodiode watching the sync patch. It
+// reports an event for each frame on which the patch turns on after the given latency
+// plus Gaussian jitter, and misses the given fraction of them at random. The same seed
+// always produces the same events.
+class SimulatedEventSource : public ExternalEventSource
+{
+public:
+  SimulatedEventSource(double latencyMs, double jitterMs, double missRate,
+    uint32_t seed);
+  virtual ~SimulatedEventSource() {};
+
+  bool start() override;
+  bool waitForEvent(uint32_t timeoutMs, uint64_t& eventTimestampUsec) override;
+  void stop() override;
+
+  void framePresented(uint64_t timestampUsec, bool patchLit) override;
+
+private:
+  double latencyUsec;
+  double jitterUsec;
+  double missRate;
+  std::mt19937 generator;
+  bool lastLit = false;
+  std::deque<uint64_t> events;
+  std::mutex eventMutex;
+  std::condition_variable eventReady;
+};
@@ -0,0 +1,34 @@
+#include "SolidGenerator.h"
+#include "Color.h"
+
+using namespace std;
+
+SolidGenerator::SolidGenerator(uint32_t count, string col) :
+  FrameGenerator("solid", count),
+  color(col)
+{
+}
+
+bool SolidGenerator::open(uint32_t wid, uint32_t hgt, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(color, red, green, blue))
+  {
+    error = "Unknown color " + color;
+    return false;
+  }
+  width = wid;
+  height = hgt;
+  pixel = color::toPixel(red, green, blue);
+  return true;
+}
+
+void SolidGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  color::fillPixels(dest, pixel, (size_t)width * height);
+}
+
+bool SolidGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (frameNumber > 0);
+}
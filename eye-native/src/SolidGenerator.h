@@ -0,0 +1,22 @@
+#pragma once
+
+#include "FrameGenerator.h"
+
+// The SolidGenerator class renders the Solid stimulus, a single color covering the whole
+// frame. Every frame after the first is marked as a repeat.
+class SolidGenerator : public FrameGenerator
+{
+public:
+  SolidGenerator(uint32_t frameCount, std::string color);
+  virtual ~SolidGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  std::string color;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t pixel = 0;
+};
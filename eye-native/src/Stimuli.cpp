@@ -0,0 +1,262 @@
+#include "Stimuli.h"
+#include "BarGenerator.h"
+#include "CheckerboardGenerator.h"
+#include "ChirpGenerator.h"
+#include "Color.h"
+#include "EyeChartGenerator.h"
+#include "GlyphAtlas.h"
+#include "GratingGenerator.h"
+#include "LetterGenerator.h"
+#include "SolidGenerator.h"
+#include "TiledLetterGenerator.h"
+#include "WhiteNoiseGenerator.h"
+#include "json/json.hpp"
+#include <cmath>
+
+using namespace std;
+using json = nlohmann::json;
+
+// Helpers that read a field of a descriptor, returning false if it's missing or has the
+// wrong type
+static bool getNumber(const json& stimulus, const char* name, double& value)
+{
+  auto it = stimulus.find(name);
+  if ((it == stimulus.end()) || !it->is_number())
+  {
+    return false;
+  }
+  value = it->get<double>();
+  return true;
+}
+
+static bool getColor(const json& stimulus, const char* name, string& value)
+{
+  auto it = stimulus.find(name);
+  uint8_t red, green, blue;
+  if ((it == stimulus.end()) || !it->is_string())
+  {
+    return false;
+  }
+  value = it->get<string>();
+  return color::parse(value, red, green, blue);
+}
+
+static bool getLetter(const json& stimulus, const char* name, string& value)
+{
+  auto it = stimulus.find(name);
+  if ((it == stimulus.end()) || !it->is_string())
+  {
+    return false;
+  }
+  value = it->get<string>();
+  return (value.size() == 1) && GlyphAtlas::isSupported(value[0]);
+}
+
+static bool getLetterMatrix(const json& stimulus, const char* name,
+  vector<string>& rows)
+{
+  auto it = stimulus.find(name);
+  if ((it == stimulus.end()) || !it->is_array())
+  {
+    return false;
+  }
+  rows.clear();
+  for (auto& row : *it)
+  {
+    if (!row.is_array())
+    {
+      return false;
+    }
+    string letters;
+    for (auto& letter : row)
+    {
+      if (!letter.is_string() || (letter.get<string>().size() != 1) ||
+        !GlyphAtlas::isSupported(letter.get<string>()[0]))
+      {
+        return false;
+      }
+      letters += letter.get<string>();
+    }
+    rows.push_back(letters);
+  }
+  return true;
+}
+
+static uint32_t getSeed(const json& stimulus, uint32_t defaultSeed)
+{
+  // Accept a seed on the stimulus itself or in its metadata
+  double seed;
+  if (getNumber(stimulus, "seed", seed))
+  {
+    return (uint32_t)seed;
+  }
+  auto it = stimulus.find("metadata");
+  if ((it != stimulus.end()) && it->is_object() && getNumber(*it, "seed", seed))
+  {
+    return (uint32_t)seed;
+  }
+  return defaultSeed;
+}
+
+// Creates the generator for a single descriptor of a supported type. Returns null and
+// sets the error if the descriptor is invalid
+static shared_ptr<FrameGenerator> createGenerator(const json& stimulus,
+  uint32_t frameCount, uint32_t fps, uint32_t firstIndex, string& error)
+{
+  string type = stimulus["stimulusType"].get<string>();
+  string color, alternateColor, backgroundColor, letter;
+  vector<string> letterMatrix;
+  double speed, width, angle, size, padding, x, y, rows, columns;
+  double f0, f1, a0, a1, t1, phi;
+  if ((type == "SOLID") || (type == "WAIT"))
+  {
+    if (getColor(stimulus, "backgroundColor", backgroundColor))
+    {
+      return shared_ptr<FrameGenerator>(new SolidGenerator(frameCount, backgroundColor));
+    }
+  }
+  else if ((type == "GRATING") || (type == "SINUSOIDAL_GRATING") || (type == "BAR"))
+  {
+    if (getNumber(stimulus, "speed", speed) && getNumber(stimulus, "width", width) &&
+      getNumber(stimulus, "angle", angle) && getColor(stimulus, "barColor", color) &&
+      getColor(stimulus, "backgroundColor", backgroundColor) && (width >= 1.0))
+    {
+      if (type == "BAR")
+      {
+        return shared_ptr<FrameGenerator>(new BarGenerator(frameCount, fps, speed, width,
+          angle, color, backgroundColor));
+      }
+      return shared_ptr<FrameGenerator>(new GratingGenerator(frameCount, fps,
+        type == "SINUSOIDAL_GRATING", speed, width, angle, color, backgroundColor));
+    }
+  }
+  else if (type == "CHIRP")
+  {
+    if (getNumber(stimulus, "f0", f0) && getNumber(stimulus, "f1", f1) &&
+      getNumber(stimulus, "a0", a0) && getNumber(stimulus, "a1", a1) &&
+      getNumber(stimulus, "t1", t1) && getNumber(stimulus, "phi", phi) && (t1 > 0.0))
+    {
+      return shared_ptr<FrameGenerator>(new ChirpGenerator(frameCount, fps, f0, f1, a0,
+        a1, t1, phi));
+    }
+  }
+  else if (type == "CHECKERBOARD")
+  {
+    if (getColor(stimulus, "color", color) &&
+      getColor(stimulus, "alternateColor", alternateColor) &&
+      getNumber(stimulus, "size", size) && getNumber(stimulus, "angle", angle) &&
+      (size >= 1.0))
+    {
+      return shared_ptr<FrameGenerator>(new CheckerboardGenerator(frameCount, color,
+        alternateColor, size, angle));
+    }
+  }
+  else if (type == "WHITE_NOISE")
+  {
+    // WhiteNoiseRenderer always draws gray cells regardless of the color field
+    if (getNumber(stimulus, "rows", rows) && getNumber(stimulus, "cols", columns) &&
+      (rows >= 1.0) && (columns >= 1.0))
+    {
+      return shared_ptr<FrameGenerator>(new WhiteNoiseGenerator(frameCount,
+        (uint32_t)rows, (uint32_t)columns, false, getSeed(stimulus, firstIndex)));
+    }
+  }
+  else if (type == "LETTER")
+  {
+    if (getLetter(stimulus, "letter", letter) && getNumber(stimulus, "x", x) &&
+      getNumber(stimulus, "y", y) && getNumber(stimulus, "size", size) &&
+      getColor(stimulus, "color", color) &&
+      getColor(stimulus, "backgroundColor", backgroundColor) && (size >= 1.0))
+    {
+      return shared_ptr<FrameGenerator>(new LetterGenerator(frameCount, letter, x, y,
+        size, color, backgroundColor));
+    }
+  }
+  else if (type == "TILED_LETTER")
+  {
+    if (getLetter(stimulus, "letter", letter) && getNumber(stimulus, "size", size) &&
+      getNumber(stimulus, "padding", padding) && getColor(stimulus, "color", color) &&
+      getNumber(stimulus, "angle", angle) &&
+      getColor(stimulus, "backgroundColor", backgroundColor) && (size >= 1.0) &&
+      (padding >= 0.0))
+    {
+      return shared_ptr<FrameGenerator>(new TiledLetterGenerator(frameCount, letter,
+        size, padding, color, angle, backgroundColor));
+    }
+  }
+  else if (type == "EYE_CHART")
+  {
+    if (getLetterMatrix(stimulus, "letterMatrix", letterMatrix) &&
+      getNumber(stimulus, "size", size) && getNumber(stimulus, "padding", padding) &&
+      getColor(stimulus, "color", color) &&
+      getColor(stimulus, "backgroundColor", backgroundColor) && (size >= 1.0) &&
+      (padding >= 0.0))
+    {
+      return shared_ptr<FrameGenerator>(new EyeChartGenerator(frameCount, letterMatrix,
+        size, padding, color, backgroundColor));
+    }
+  }
+  error = "Invalid " + type + " stimulus";
+  return nullptr;
+}
+
+bool stimuli::isSupported(string stimulusType, bool nativeLetters)
+{
+  if ((stimulusType == "LETTER") || (stimulusType == "TILED_LETTER") ||
+    (stimulusType == "EYE_CHART"))
+  {
+    return nativeLetters;
+  }
+  return (stimulusType == "SOLID") || (stimulusType == "WAIT") ||
+    (stimulusType == "GRATING") || (stimulusType == "SINUSOIDAL_GRATING") ||
+    (stimulusType == "BAR") || (stimulusType == "CHIRP") ||
+    (stimulusType == "CHECKERBOARD") || (stimulusType == "WHITE_NOISE");
+}
+
+bool stimuli::createGenerators(string batchJson, uint32_t fps, uint32_t firstIndex,
+  bool nativeLetters, vector<shared_ptr<FrameGenerator>>& generators, string& error)
+{
+  generators.clear();
+  json batch = json::parse(batchJson, nullptr, false);
+  if (batch.is_discarded() || !batch.is_array())
+  {
+    error = "Stimulus batch is not a JSON array";
+    return false;
+  }
+  uint32_t nextIndex = firstIndex;
+  for (auto& stimulus : batch)
+  {
+    // Every stimulus needs a type and a lifespan
+    double lifespan;
+    auto type = stimulus.find("stimulusType");
+    if (!stimulus.is_object() || (type == stimulus.end()) || !type->is_string() ||
+      !getNumber(stimulus, "lifespan", lifespan) || !(lifespan >= 0.0))
+    {
+      error = "Invalid stimulus descriptor";
+      return true;
+    }
+    if (!isSupported(type->get<string>(), nativeLetters))
+    {
+      error = "Stimulus type " + type->get<string>() + " is not rendered natively";
+      return true;
+    }
+
+    // Round the frame count exactly as the stimulus window does. Its renderers draw
+    // frames while the frame number is below lifespan * fps
+    uint32_t frameCount = (uint32_t)ceil(lifespan * fps);
+    if (frameCount == 0)
+    {
+      generators.push_back(nullptr);
+      continue;
+    }
+    shared_ptr<FrameGenerator> generator = createGenerator(stimulus, frameCount, fps,
+      nextIndex, error);
+    if (generator == nullptr)
+    {
+      return true;
+    }
+    generators.push_back(generator);
+    nextIndex += frameCount;
+  }
+  return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameGenerator.h"
+
+// These functions turn the stimulus descriptors produced by the program VM into native
+// frame generators so whole runs of procedural stimuli can be recorded without drawing
+// them in the stimulus window and capturing the result. The descriptors are the JSON
+// form of the stimulus types, with the lifespan in seconds and the stimulus type in
+// "stimulusType".
+
+namespace stimuli
+{
+  // Returns true if the stimulus type can be rendered natively. The letter types are only
+  // included when native letters are enabled since their glyphs approximate the Sloan
+  // font that the stimulus window draws them with
+  bool isSupported(std::string stimulusType, bool nativeLetters);
+
+  // Parses a JSON array of stimulus descriptors and creates a generator for each one in
+  // order, stopping at the first stimulus that can't be rendered natively so frames stay
+  // in program order when the rest are drawn by the stimulus window. Stimuli with no
+  // frames get a null generator. White noise without a seed is seeded with the index of
+  // its first frame in the video, counting from the given index. Returns false if the
+  // batch can't be parsed. The reason for stopping early, if any, is returned in the error
+  bool createGenerators(std::string batchJson, uint32_t fps, uint32_t firstIndex,
+    bool nativeLetters, std::vector<std::shared_ptr<FrameGenerator>>& generators,
+    std::string& error);
+}
@@ -0,0 +1,55 @@
+#include "SyncPatch.h"
+#include "Color.h"
+#include <algorithm>
+
+using namespace std;
+
+// Length of the maximal length sequence produced by a 7 bit shift register
+#define SEQUENCE_LENGTH 127
+
+SyncPatch::SyncPatch(string corner, uint32_t s, string mode) :
+  left(corner.find("left") != string::npos),
+  top(corner.find("top") != string::npos),
+  size(s),
+  alternate(mode == "alternate")
+{
+  // Generate the sequence with a Fibonacci shift register using the primitive polynomial
+  // x^7 + x^6 + 1
+  uint32_t state = 0x7F;
+  for (uint32_t i = 0; i < SEQUENCE_LENGTH; ++i)
+  {
+    uint32_t bit = ((state >> 6) ^ (state >> 5)) & 1;
+    state = ((state << 1) | bit) & 0x7F;
+    sequence.push_back((state & 1) != 0);
+  }
+}
+
+bool SyncPatch::validate(string corner, string mode)
+{
+  return ((corner == "top-left") || (corner == "top-right") ||
+    (corner == "bottom-left") || (corner == "bottom-right")) &&
+    ((mode == "alternate") || (mode == "sequence"));
+}
+
+bool SyncPatch::isLit(uint64_t index)
+{
+  if (alternate)
+  {
+    return ((index & 1) == 0);
+  }
+  return sequence[index % SEQUENCE_LENGTH];
+}
+
+bool SyncPatch::paint(uint8_t* frame, uint32_t width, uint32_t height, uint64_t index)
+{
+  bool lit = isLit(index);
+  uint32_t patchWidth = min(size, width), patchHeight = min(size, height);
+  uint32_t x = left ? 0 : (width - patchWidth);
+  uint32_t y = top ? 0 : (height - patchHeight);
+  uint32_t pixel = lit ? color::toPixel(255, 255, 255) : color::toPixel(0, 0, 0);
+  for (uint32_t row = y; row < y + patchHeight; ++row)
+  {
+    color::fillPixels(frame + ((size_t)row * width + x) * 4, pixel, patchWidth);
+  }
+  return lit;
+}
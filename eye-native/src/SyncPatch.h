@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// The SyncPatch class paints a square patch into a corner of each frame just before it
+// is presented so a photodiode taped over that corner can confirm when the frame hit the
+// screen. In "alternate" mode the patch is white on every other frame. In "sequence" mode
+// it follows a 127 frame maximal length sequence, which keeps the spacing of the white
+// frames irregular so a run of missed frames can't be mistaken for a shifted latency.
+class SyncPatch
+{
+public:
+  SyncPatch(std::string corner, uint32_t size, std::string mode);
+  virtual ~SyncPatch() {};
+
+  // Returns false if the corner or mode isn't recognized
+  static bool validate(std::string corner, std::string mode);
+
+  // Returns true if the patch is lit on the given presented frame
+  bool isLit(uint64_t index);
+
+  // Paints the patch into a BGRA frame and returns true if it's lit
+  bool paint(uint8_t* frame, uint32_t width, uint32_t height, uint64_t index);
+
+private:
+  bool left;
+  bool top;
+  uint32_t size;
+  bool alternate;
+  std::vector<bool> sequence;
+};
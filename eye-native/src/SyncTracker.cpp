@@ -0,0 +1,145 @@
+#include "SyncTracker.h"
+#include <cmath>
+
+using namespace std;
+
+// Longest latency that can be attributed to an onset, in microseconds
+#define MAX_LATENCY_USEC 250000
+
+// Number of matched events needed before the mean latency is trusted for matching
+#define MIN_MATCHED_EVENTS 5
+
+SyncTracker::SyncTracker(shared_ptr<SyncPatch> patch, shared_ptr<ExternalEventSource> source) :
+  syncPatch(patch),
+  eventSource(source)
+{
+}
+
+shared_ptr<ExternalEventSource> SyncTracker::getEventSource()
+{
+  return eventSource;
+}
+
+bool SyncTracker::paintPatch(shared_ptr<FrameWrapper> wrapper)
+{
+  uint64_t index;
+  {
+    unique_lock<mutex> lock(trackerMutex);
+    index = statistics.presentedFrames;
+  }
+  if (wrapper->nativeFrame == 0)
+  {
+    return syncPatch->isLit(index);
+  }
+  return syncPatch->paint(wrapper->nativeFrame, wrapper->nativeWidth,
+    wrapper->nativeHeight, index);
+}
+
+void SyncTracker::framePresented(uint64_t timestampUsec, bool patchLit, uint32_t fps)
+{
+  {
+    unique_lock<mutex> lock(trackerMutex);
+
+    // Count the frames that should have been presented in any gap
+    if ((lastTimestamp != 0) && (fps > 0) && (timestampUsec > lastTimestamp))
+    {
+      double interval = 1000000.0 / fps;
+      double gap = (double)(timestampUsec - lastTimestamp);
+      if (gap > 1.5 * interval)
+      {
+        statistics.droppedFrames += (uint64_t)floor(gap / interval + 0.5) - 1;
+      }
+    }
+    lastTimestamp = timestampUsec;
+    statistics.presentedFrames += 1;
+
+    // Remember each frame on which the patch turns on and give up on onsets that have
+    // waited too long for an event
+    if (patchLit && !lastLit)
+    {
+      pendingOnsets.push_back(timestampUsec);
+      statistics.onsets += 1;
+    }
+    lastLit = patchLit;
+    while (!pendingOnsets.empty() &&
+      (pendingOnsets.front() + MAX_LATENCY_USEC < timestampUsec))
+    {
+      pendingOnsets.pop_front();
+      statistics.missedOnsets += 1;
+    }
+  }
+  if (eventSource != nullptr)
+  {
+    eventSource->framePresented(timestampUsec, patchLit);
+  }
+}
+
+void SyncTracker::addEvents(vector<uint64_t> eventTimestamps)
+{
+  unique_lock<mutex> lock(trackerMutex);
+  for (auto it = eventTimestamps.begin(); it != eventTimestamps.end(); ++it)
+  {
+    addEvent(*it);
+  }
+}
+
+SyncStatistics SyncTracker::getStatistics()
+{
+  unique_lock<mutex> lock(trackerMutex);
+  return statistics;
+}
+
+void SyncTracker::addEvent(uint64_t eventTimestamp)
+{
+  // Find the onset that caused this event among those that came before it
+  size_t match = pendingOnsets.size();
+  double bestError = 0;
+  for (size_t i = 0; i < pendingOnsets.size(); ++i)
+  {
+    uint64_t onset = pendingOnsets[i];
+    if ((onset > eventTimestamp) || (onset + MAX_LATENCY_USEC < eventTimestamp))
+    {
+      continue;
+    }
+    if (statistics.matchedEvents < MIN_MATCHED_EVENTS)
+    {
+      match = i;
+      break;
+    }
+    double error = fabs((double)(eventTimestamp - onset) / 1000.0 -
+      statistics.meanLatencyMs);
+    if ((match == pendingOnsets.size()) || (error < bestError))
+    {
+      match = i;
+      bestError = error;
+    }
+  }
+  if (match == pendingOnsets.size())
+  {
+    statistics.unexpectedEvents += 1;
+    return;
+  }
+
+  // Events arrive in order so any earlier onsets will never see theirs
+  double latencyMs = (double)(eventTimestamp - pendingOnsets[match]) / 1000.0;
+  statistics.missedOnsets += match;
+  pendingOnsets.erase(pendingOnsets.begin(), pendingOnsets.begin() + match + 1);
+
+  // Update the latency statistics
+  statistics.matchedEvents += 1;
+  latencySum += latencyMs;
+  latencySquareSum += latencyMs * latencyMs;
+  double count = (double)statistics.matchedEvents;
+  statistics.meanLatencyMs = latencySum / count;
+  statistics.stdDevLatencyMs = sqrt(max(latencySquareSum / count -
+    statistics.meanLatencyMs * statistics.meanLatencyMs, 0.0));
+  if ((statistics.matchedEvents == 1) || (latencyMs < statistics.minLatencyMs))
+  {
+    statistics.minLatencyMs = latencyMs;
+  }
+  if ((statistics.matchedEvents == 1) || (latencyMs > statistics.maxLatencyMs))
+  {
+    statistics.maxLatencyMs = latencyMs;
+  }
+  statistics.lastLatencyMs = latencyMs;
+}
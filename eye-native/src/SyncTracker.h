@@ -0,0 +1,68 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ExternalEventSource.h"
+#include "FrameWrapper.h"
+#include "SyncPatch.h"
+
+// The SyncStatistics structure summarizes sync patch measurements. Latencies are in
+// milliseconds from the presentation timestamp of a frame on which the patch turned on
+// to the photodiode event it caused
+struct SyncStatistics
+{
+  uint64_t presentedFrames = 0;
+  uint64_t droppedFrames = 0;
+  uint64_t onsets = 0;
+  uint64_t matchedEvents = 0;
+  uint64_t missedOnsets = 0;
+  uint64_t unexpectedEvents = 0;
+  double meanLatencyMs = 0;
+  double stdDevLatencyMs = 0;
+  double minLatencyMs = 0;
+  double maxLatencyMs = 0;
+  double lastLatencyMs = 0;
+};
+
+// The SyncTracker class paints the sync patch during playback and correlates the
+// external events reported by the photodiode with the frames on which the patch turned
+// on. Each event is matched to a pending onset, by order until a latency estimate is
+// established and then to the onset closest to that estimate. Onsets passed over or
+// left without an event for too long are counted as missed. Frames presented more than
+// half a frame late are counted as dropped. Statistics are updated as playback runs and
+// can be read from another thread at any time.
+class SyncTracker
+{
+public:
+  SyncTracker(std::shared_ptr<SyncPatch> syncPatch,
+    std::shared_ptr<ExternalEventSource> eventSource);
+  virtual ~SyncTracker() {};
+
+  // Returns the source to pass to the external event thread, or null to use the timing
+  // card
+  std::shared_ptr<ExternalEventSource> getEventSource();
+
+  // Paints the patch into the frame about to be presented and returns true if it's lit
+  bool paintPatch(std::shared_ptr<FrameWrapper> wrapper);
+
+  void framePresented(uint64_t timestampUsec, bool patchLit, uint32_t fps);
+  void addEvents(std::vector<uint64_t> eventTimestamps);
+
+  SyncStatistics getStatistics();
+
+private:
+  void addEvent(uint64_t eventTimestamp);
+
+private:
+  std::shared_ptr<SyncPatch> syncPatch;
+  std::shared_ptr<ExternalEventSource> eventSource;
+  std::mutex trackerMutex;
+  SyncStatistics statistics;
+  std::deque<uint64_t> pendingOnsets;
+  uint64_t lastTimestamp = 0;
+  bool lastLit = false;
+  double latencySum = 0;
+  double latencySquareSum = 0;
+};
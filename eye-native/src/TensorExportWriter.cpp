@@ -0,0 +1,177 @@
+#include "TensorExportWriter.h"
+#include "Platform.h"
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+
+// The .npy magic string and format version
+#define NPY_MAGIC "\x93NUMPY"
+#define NPY_MAGIC_LENGTH 6
+#define NPY_PREAMBLE_LENGTH 10
+
+TensorExportWriter::TensorExportWriter(string videoPath, uint32_t width, uint32_t height,
+    bool useFloat, uint32_t shardFrameCount) :
+  RecordStage("tensor"),
+  tensorWidth(width),
+  tensorHeight(height),
+  floatPixels(useFloat),
+  framesPerShard(shardFrameCount)
+{
+  // Strip the extension of the video file, if any
+  size_t dotPos = videoPath.find_last_of('.');
+  size_t slashPos = videoPath.find_last_of("/\\");
+  if ((dotPos != string::npos) && ((slashPos == string::npos) || (dotPos > slashPos)))
+  {
+    basePath = videoPath.substr(0, dotPos);
+  }
+  else
+  {
+    basePath = videoPath;
+  }
+}
+
+bool TensorExportWriter::open(uint32_t width, uint32_t height, uint32_t fps,
+  string& error)
+{
+  if ((tensorWidth == 0) || (tensorHeight == 0) || (tensorWidth > width) ||
+    (tensorHeight > height) || (framesPerShard == 0))
+  {
+    error = "Invalid tensor dimensions";
+    return false;
+  }
+  frameWidth = width;
+  frameHeight = height;
+  tensorFrameLength = (size_t)tensorWidth * tensorHeight * (floatPixels ? 4 : 1);
+  shardNumber = 0;
+  return openShard(error);
+}
+
+bool TensorExportWriter::processFrame(shared_ptr<FrameWrapper> wrapper,
+  const uint8_t* data, size_t length, string& error)
+{
+  if (length != ((size_t)frameWidth * frameHeight * 4))
+  {
+    error = "Unexpected frame length";
+    return false;
+  }
+
+  // Move on to the next shard once this one is full
+  if (shardFrames == framesPerShard)
+  {
+    if (!closeShard(error))
+    {
+      return false;
+    }
+    shardNumber += 1;
+    if (!openShard(error))
+    {
+      return false;
+    }
+  }
+
+  // A repeated frame is copied from the previous slice of the shard
+  uint8_t* dest = shardData + TENSOR_EXPORT_HEADER_SIZE + shardFrames * tensorFrameLength;
+  if (wrapper->repeatFrame && (shardFrames > 0))
+  {
+    memcpy(dest, dest - tensorFrameLength, tensorFrameLength);
+    shardFrames += 1;
+    return true;
+  }
+
+  // Convert to gray and area-downsample straight into the mapped shard. The output
+  // matrix wraps the mapping so resize() writes in place rather than allocating
+  Mat frame(frameHeight, frameWidth, CV_8UC4, (void*)data);
+  cvtColor(frame, grayFrame, COLOR_BGRA2GRAY);
+  if (floatPixels)
+  {
+    grayFrame.convertTo(floatFrame, CV_32F, 1.0 / 255.0);
+    Mat output(tensorHeight, tensorWidth, CV_32FC1, dest);
+    resize(floatFrame, output, output.size(), 0, 0, INTER_AREA);
+  }
+  else
+  {
+    Mat output(tensorHeight, tensorWidth, CV_8UC1, dest);
+    resize(grayFrame, output, output.size(), 0, 0, INTER_AREA);
+  }
+  shardFrames += 1;
+  return true;
+}
+
+bool TensorExportWriter::close(string& error)
+{
+  return closeShard(error);
+}
+
+string TensorExportWriter::getShardPath(uint32_t shard)
+{
+  stringstream path;
+  path << basePath << ".tensor." << setw(3) << setfill('0') << shard << ".npy";
+  return path.str();
+}
+
+string TensorExportWriter::formatHeader(uint32_t frameCount)
+{
+  // Format the dictionary that describes the array and pad it with spaces so the data
+  // starts at the reserved offset. The format requires the header to end with a newline
+  stringstream dictionary;
+  dictionary << "{'descr': '" << (floatPixels ? "<f4" : "|u1") <<
+    "', 'fortran_order': False, 'shape': (" << frameCount << ", " << tensorHeight <<
+    ", " << tensorWidth << "), }";
+  string header = dictionary.str();
+  header.resize(TENSOR_EXPORT_HEADER_SIZE - NPY_PREAMBLE_LENGTH - 1, ' ');
+  header += "\n";
+
+  // Prepend the magic string, version 1.0, and the little-endian header length
+  uint16_t headerLength = (uint16_t)header.size();
+  string preamble(NPY_MAGIC, NPY_MAGIC_LENGTH);
+  preamble += (char)1;
+  preamble += (char)0;
+  preamble += (char)(headerLength & 0xFF);
+  preamble += (char)(headerLength >> 8);
+  return preamble + header;
+}
+
+bool TensorExportWriter::openShard(string& error)
+{
+  // Preallocate and map the shard for its full number of frames
+  shardPath = getShardPath(shardNumber);
+  shardLength = TENSOR_EXPORT_HEADER_SIZE + (uint64_t)framesPerShard * tensorFrameLength;
+  if (!platform::mapFileForWriting(shardPath, shardLength, shardData, shardMapId))
+  {
+    error = "Failed to map " + shardPath;
+    shardData = nullptr;
+    return false;
+  }
+  string header = formatHeader(framesPerShard);
+  memcpy(shardData, header.data(), TENSOR_EXPORT_HEADER_SIZE);
+  shardFrames = 0;
+  return true;
+}
+
+bool TensorExportWriter::closeShard(string& error)
+{
+  if (shardData == nullptr)
+  {
+    return true;
+  }
+
+  // Rewrite the shape to match the frames written, unmap, and trim the unused space
+  string header = formatHeader(shardFrames);
+  memcpy(shardData, header.data(), TENSOR_EXPORT_HEADER_SIZE);
+  platform::unmapFile(shardData, shardLength, shardMapId);
+  shardData = nullptr;
+  if (shardFrames < framesPerShard)
+  {
+    uint64_t length = TENSOR_EXPORT_HEADER_SIZE + (uint64_t)shardFrames * tensorFrameLength;
+    if (!platform::truncateFile(shardPath, length))
+    {
+      error = "Failed to truncate " + shardPath;
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <opencv2/core/core.hpp>
+#include "RecordStage.h"
+
+// The TensorExportWriter class is a record stage that area-downsamples every frame to a
+// small grayscale image and appends it to a NumPy .npy file so the stimulus movie can be
+// loaded as an array with shape (frames, height, width) the moment recording ends.
+// Pixels are stored either as uint8 gray levels or as float32 values from 0 to 1.
+//
+// Each shard is preallocated for a fixed number of frames and memory-mapped so frames are
+// written in place. When a shard fills up the next one is started, and the last shard is
+// truncated to the frames it actually holds when recording ends. Shards are named
+// "<video name>.tensor.000.npy", "<video name>.tensor.001.npy", and so on.
+
+// The number of bytes reserved for the .npy header. This leaves room to rewrite the
+// shape of a partially filled shard in place
+#define TENSOR_EXPORT_HEADER_SIZE 128
+
+class TensorExportWriter : public RecordStage
+{
+public:
+  TensorExportWriter(std::string videoPath, uint32_t width, uint32_t height,
+    bool floatPixels, uint32_t framesPerShard);
+  virtual ~TensorExportWriter() {};
+
+  bool open(uint32_t width, uint32_t height, uint32_t fps, std::string& error) override;
+  bool processFrame(std::shared_ptr<FrameWrapper> wrapper, const uint8_t* data,
+    size_t length, std::string& error) override;
+  bool close(std::string& error) override;
+
+private:
+  std::string getShardPath(uint32_t shard);
+  std::string formatHeader(uint32_t frameCount);
+  bool openShard(std::string& error);
+  bool closeShard(std::string& error);
+
+private:
+  std::string basePath;
+  uint32_t tensorWidth;
+  uint32_t tensorHeight;
+  bool floatPixels;
+  uint32_t framesPerShard;
+  uint32_t frameWidth = 0;
+  uint32_t frameHeight = 0;
+  size_t tensorFrameLength = 0;
+
+  // The current shard's path, mapping, and number of frames written to it
+  uint32_t shardNumber = 0;
+  std::string shardPath;
+  uint8_t* shardData = nullptr;
+  uint64_t shardLength = 0;
+  uint64_t shardMapId = 0;
+  uint32_t shardFrames = 0;
+
+  // Intermediate full-size images reused for every frame
+  cv::Mat grayFrame;
+  cv::Mat floatFrame;
+};
@@ -56,6 +56,18 @@ bool Thread::terminate(uint32_t timeout /*= 100*/)
   return true;
 }
 
+void Thread::join()
+{
+  if (threadId == 0)
+  {
+    return;
+  }
+  signalExit();
+  while (!waitForCompletion(100))
+  {
+  }
+}
+
 void Thread::signalExit()
 {
   unique_lock<mutex> lock(threadMutex);
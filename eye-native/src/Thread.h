@@ -13,6 +13,11 @@ public:
   bool isRunning();
   virtual bool terminate(uint32_t timeout = 100);
 
+  // Asks the thread to exit and waits for it to return from run() however long that
+  // takes. Unlike terminate() the thread is never killed, so use this for threads that
+  // must finish writing files
+  void join();
+
 protected:
   void signalExit();
   bool checkForExit();
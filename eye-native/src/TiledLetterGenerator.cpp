@@ -0,0 +1,104 @@
+#include "TiledLetterGenerator.h"
+#include "Color.h"
+#include "GlyphAtlas.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+TiledLetterGenerator::TiledLetterGenerator(uint32_t count, string l, double s, double p,
+    string col, double a, string background) :
+  FrameGenerator("tiledletter", count),
+  letter(l),
+  size(s),
+  padding(p),
+  color(col),
+  angle(a),
+  backgroundColor(background)
+{
+}
+
+bool TiledLetterGenerator::open(uint32_t width, uint32_t height, string& error)
+{
+  uint8_t red, green, blue;
+  if (!color::parse(color, red, green, blue))
+  {
+    error = "Unknown color " + color;
+    return false;
+  }
+  uint32_t pixel = color::toPixel(red, green, blue);
+  if (!color::parse(backgroundColor, red, green, blue))
+  {
+    error = "Unknown color " + backgroundColor;
+    return false;
+  }
+  uint32_t backgroundPixel = color::toPixel(red, green, blue);
+  if ((letter.size() != 1) || !GlyphAtlas::isSupported(letter[0]) || !(size >= 1.0) ||
+    !(padding >= 0.0))
+  {
+    error = "Unsupported letter " + letter;
+    return false;
+  }
+
+  // Compose one tile with the letter inset by half the padding
+  uint32_t tileSize = (uint32_t)(size + padding);
+  vector<uint8_t> tile((size_t)tileSize * tileSize * 4);
+  color::fillPixels(tile.data(), backgroundPixel, (size_t)tileSize * tileSize);
+  GlyphAtlas atlas((uint32_t)floor(size + 0.5));
+  int32_t inset = (int32_t)floor(padding / 2 + 0.5);
+  atlas.composite(letter[0], inset, inset, pixel, tile.data(), tileSize, tileSize);
+
+  // Repeat the tile across the frame
+  size_t stride = (size_t)width * 4;
+  frame.resize(stride * height);
+  const uint32_t* tilePixels = (const uint32_t*)tile.data();
+  if (angle == 0)
+  {
+    // Without rotation each row of tiles is built once and copied down
+    for (uint32_t y = 0; y < height; ++y)
+    {
+      uint32_t* row = (uint32_t*)&frame[y * stride];
+      if (y >= tileSize)
+      {
+        memcpy(row, row - tileSize * width, stride);
+        continue;
+      }
+      for (uint32_t x = 0; x < width; ++x)
+      {
+        row[x] = tilePixels[y * tileSize + (x % tileSize)];
+      }
+    }
+  }
+  else
+  {
+    // Map the center of each pixel into pattern space by undoing the rotation about the
+    // center of the frame
+    double diagonal = sqrt((double)width * width + (double)height * height);
+    double cosAngle = cos(angle), sinAngle = sin(angle);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+      uint32_t* row = (uint32_t*)&frame[y * stride];
+      double dy = y + 0.5 - height / 2.0;
+      for (uint32_t x = 0; x < width; ++x)
+      {
+        double dx = x + 0.5 - width / 2.0;
+        double u = fmod(floor(dx * cosAngle - dy * sinAngle + diagonal / 2), tileSize);
+        double v = fmod(floor(dx * sinAngle + dy * cosAngle + diagonal / 2), tileSize);
+        u += (u < 0) ? tileSize : 0;
+        v += (v < 0) ? tileSize : 0;
+        row[x] = tilePixels[(uint32_t)v * tileSize + (uint32_t)u];
+      }
+    }
+  }
+  return true;
+}
+
+void TiledLetterGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  memcpy(dest, frame.data(), frame.size());
+}
+
+bool TiledLetterGenerator::isRepeatFrame(uint32_t frameNumber)
+{
+  return (frameNumber > 0);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The TiledLetterGenerator class renders the TiledLetter stimulus, a Sloan letter
+// repeated on a grid with the given padding between letters and rotated by the angle
+// around the center of the frame. This matches TiledLetterRenderer in the stimulus
+// window. One tile is composed from a GlyphAtlas and the frame is built from it once
+// when the generator is opened. Every frame after the first is marked as a repeat.
+class TiledLetterGenerator : public FrameGenerator
+{
+public:
+  TiledLetterGenerator(uint32_t frameCount, std::string letter, double size,
+    double padding, std::string color, double angle, std::string backgroundColor);
+  virtual ~TiledLetterGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+  bool isRepeatFrame(uint32_t frameNumber) override;
+
+private:
+  std::string letter;
+  double size;
+  double padding;
+  std::string color;
+  double angle;
+  std::string backgroundColor;
+  std::vector<uint8_t> frame;
+};
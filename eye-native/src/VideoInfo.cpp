@@ -0,0 +1,65 @@
+#include "VideoInfo.h"
+#include "MkvReader.h"
+#include "Mp4Reader.h"
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+// Number of bytes needed to recognize a container
+#define SNIFF_LENGTH 8
+
+bool videoinfo::read(string videoPath, VideoInfo& info, string& error)
+{
+  // Recognize the container from its first bytes rather than the file extension
+  uint8_t header[SNIFF_LENGTH];
+  {
+    ifstream file(videoPath, ios::in | ios::binary);
+    if (!file.is_open() || !file.read((char*)header, SNIFF_LENGTH))
+    {
+      error = "Failed to read " + videoPath;
+      return false;
+    }
+  }
+  const uint8_t ebmlMagic[4] = { 0x1A, 0x45, 0xDF, 0xA3 };
+  string boxType((const char*)header + 4, 4);
+  if ((boxType == "ftyp") || (boxType == "moov") || (boxType == "mdat") ||
+    (boxType == "free") || (boxType == "wide"))
+  {
+    Mp4Reader reader(videoPath);
+    if (!reader.parseInfo(error))
+    {
+      return false;
+    }
+    info.width = reader.getWidth();
+    info.height = reader.getHeight();
+    info.fps = reader.getFps();
+    info.frameCount = reader.getSampleCount();
+    info.durationUsec = reader.getDurationUsec();
+  }
+  else if (memcmp(header, ebmlMagic, sizeof(ebmlMagic)) == 0)
+  {
+    MkvReader reader(videoPath);
+    if (!reader.parseInfo(error))
+    {
+      return false;
+    }
+    info.width = reader.getWidth();
+    info.height = reader.getHeight();
+    info.fps = reader.getFps();
+    info.frameCount = reader.getFrameCount();
+    info.durationUsec = reader.getDurationUsec();
+  }
+  else
+  {
+    error = "Unrecognized container format in " + videoPath;
+    return false;
+  }
+  if ((info.width == 0) || (info.height == 0) || (info.fps == 0) ||
+    (info.frameCount == 0))
+  {
+    error = "Incomplete container headers in " + videoPath;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// The VideoInfo structure holds the properties of a video file that playback needs
+// before it can start
+struct VideoInfo
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t fps = 0;
+  uint32_t frameCount = 0;
+  uint64_t durationUsec = 0;
+};
+
+// Reads the properties of an MP4 or Matroska file from its container headers without
+// decoding anything. Returns false for other formats or when the headers don't say
+// enough, in which case the caller falls back to ffprobe
+namespace videoinfo
+{
+  bool read(std::string videoPath, VideoInfo& info, std::string& error);
+}
@@ -0,0 +1,236 @@
+#include "WhiteNoiseGenerator.h"
+#include "Philox.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// Mean and standard deviation of the cell values before truncation
+#define NOISE_MEAN 0.5f
+#define NOISE_STD_DEV 0.1f
+
+// Exponent used to gamma encode the linear values
+#define NOISE_GAMMA (1.0 / 2.2)
+
+// Number of entries in the coarse gamma table
+#define COARSE_LEVEL_COUNT 4096
+
+// Each Philox call produces four uniforms which Box-Muller turns into four Gaussians
+#define VALUES_PER_CALL 4
+
+// Upper bound on resampling attempts. Values fall outside the range with a probability
+// of about 6e-7 so this is never reached in practice
+#define MAX_ATTEMPTS 64
+
+// Number of groups of cells generated together, small enough for the working arrays to
+// stay in the L1 cache
+#define GROUPS_PER_BLOCK 256
+
+static const float TWO_PI = 6.28318530718f;
+
+// Applies the Box-Muller transform to pairs of uniforms taken from the two arrays
+static void boxMuller(const uint32_t* first, const uint32_t* second, uint32_t count,
+  float* cosines, float* sines)
+{
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    float radius = sqrt(-2.0f * log(philox::toUniform(first[i])));
+    float angle = TWO_PI * philox::toUniform(second[i]);
+    cosines[i] = radius * cos(angle);
+    sines[i] = radius * sin(angle);
+  }
+}
+
+// Gamma encodes a value the same way as WhiteNoiseRenderer
+static uint32_t encodeExact(float value)
+{
+  return (uint32_t)floor(pow((double)value, NOISE_GAMMA) * 255.0 + 0.5);
+}
+
+WhiteNoiseGenerator::WhiteNoiseGenerator(uint32_t count, uint32_t r, uint32_t c, bool col,
+    uint32_t s) :
+  FrameGenerator("whitenoise", count),
+  rows(r),
+  columns(c),
+  color(col),
+  seed(s)
+{
+}
+
+bool WhiteNoiseGenerator::open(uint32_t wid, uint32_t hgt, string& error)
+{
+  if ((rows == 0) || (columns == 0))
+  {
+    error = "White noise must have at least one row and column";
+    return false;
+  }
+  width = wid;
+  height = hgt;
+
+  // Sample the center of each output pixel the way the canvas does when smoothing is
+  // disabled
+  rowMap.resize(height);
+  for (uint32_t y = 0; y < height; ++y)
+  {
+    rowMap[y] = (uint32_t)(((uint64_t)y * 2 + 1) * rows / (2 * (uint64_t)height));
+  }
+  columnMap.resize(width);
+  for (uint32_t x = 0; x < width; ++x)
+  {
+    columnMap[x] = (uint32_t)(((uint64_t)x * 2 + 1) * columns / (2 * (uint64_t)width));
+  }
+
+  // A linear value is encoded as level k when it is at least ((k - 0.5) / 255) ^ 2.2,
+  // which is the inverse of round(value ^ (1 / 2.2) * 255). Each threshold is nudged to
+  // the exact float at which the level changes so the lookup matches the formula
+  levelThresholds.resize(257);
+  levelThresholds[0] = 0.0f;
+  for (uint32_t level = 1; level < 256; ++level)
+  {
+    float threshold = (float)pow((level - 0.5) / 255.0, 2.2);
+    while (encodeExact(nextafter(threshold, 0.0f)) >= level)
+    {
+      threshold = nextafter(threshold, 0.0f);
+    }
+    while (encodeExact(threshold) < level)
+    {
+      threshold = nextafter(threshold, 1.0f);
+    }
+    levelThresholds[level] = threshold;
+  }
+  levelThresholds[256] = 2.0f;
+  coarseLevels.resize(COARSE_LEVEL_COUNT + 1);
+  uint32_t level = 0;
+  for (uint32_t i = 0; i <= COARSE_LEVEL_COUNT; ++i)
+  {
+    float value = (float)i / COARSE_LEVEL_COUNT;
+    while (value >= levelThresholds[level + 1])
+    {
+      level += 1;
+    }
+    coarseLevels[i] = (uint8_t)level;
+  }
+  return true;
+}
+
+void WhiteNoiseGenerator::renderFrame(uint32_t frameNumber, uint8_t* dest)
+{
+  // Generate the gray level of every cell for each channel
+  uint32_t cellCount = rows * columns;
+  uint32_t channelCount = color ? 3 : 1;
+  vector<uint8_t> levels(cellCount * channelCount);
+  for (uint32_t channel = 0; channel < channelCount; ++channel)
+  {
+    generateCells(frameNumber, channel, &levels[channel * cellCount]);
+  }
+
+  // Scale the cells up to the output size. Consecutive output rows usually come from
+  // the same row of cells so those are copied from the row above
+  size_t stride = (size_t)width * 4;
+  const uint8_t* red = &levels[0];
+  const uint8_t* green = color ? &levels[cellCount] : red;
+  const uint8_t* blue = color ? &levels[2 * cellCount] : red;
+  for (uint32_t y = 0; y < height; ++y)
+  {
+    uint8_t* row = dest + y * stride;
+    if ((y > 0) && (rowMap[y] == rowMap[y - 1]))
+    {
+      memcpy(row, row - stride, stride);
+      continue;
+    }
+    uint32_t cellRow = rowMap[y] * columns;
+    for (uint32_t x = 0; x < width; ++x)
+    {
+      uint32_t cell = cellRow + columnMap[x];
+      row[x * 4] = blue[cell];
+      row[x * 4 + 1] = green[cell];
+      row[x * 4 + 2] = red[cell];
+      row[x * 4 + 3] = 255;
+    }
+  }
+}
+
+void WhiteNoiseGenerator::generateCells(uint32_t frameNumber, uint32_t channel,
+  uint8_t* levels)
+{
+  // Each group of four cells shares one Philox call. The counter identifies the group,
+  // frame, channel, and resampling attempt so every value has a fixed position in the
+  // random stream. The groups are processed in blocks: Philox runs across the block
+  // with one array per counter word and Box-Muller runs over the resulting arrays, which
+  // keeps both loops free of branches
+  uint32_t key[2] = { seed, 0 };
+  uint32_t cellCount = rows * columns;
+  uint32_t groupCount = (cellCount + VALUES_PER_CALL - 1) / VALUES_PER_CALL;
+  uint32_t words[VALUES_PER_CALL][GROUPS_PER_BLOCK];
+  float gaussians[VALUES_PER_CALL][GROUPS_PER_BLOCK];
+  for (uint32_t firstGroup = 0; firstGroup < groupCount; firstGroup += GROUPS_PER_BLOCK)
+  {
+    uint32_t count = min((uint32_t)GROUPS_PER_BLOCK, groupCount - firstGroup);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      words[0][i] = firstGroup + i;
+      words[1][i] = frameNumber;
+      words[2][i] = channel;
+      words[3][i] = 0;
+    }
+    philox::generateLanes(words[0], words[1], words[2], words[3], key, count);
+    boxMuller(words[0], words[1], count, gaussians[0], gaussians[1]);
+    boxMuller(words[2], words[3], count, gaussians[2], gaussians[3]);
+
+    // Gamma encode the values, resampling the rare few that fall out of range one at a
+    // time
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      uint32_t group = firstGroup + i;
+      for (uint32_t lane = 0; lane < VALUES_PER_CALL; ++lane)
+      {
+        uint32_t cell = group * VALUES_PER_CALL + lane;
+        if (cell >= cellCount)
+        {
+          break;
+        }
+        float value = gaussians[lane][i] * NOISE_STD_DEV + NOISE_MEAN;
+        if ((value < 0.0f) || (value > 1.0f))
+        {
+          value = resample(frameNumber, channel, group, lane);
+        }
+        levels[cell] = encodeLevel(value);
+      }
+    }
+  }
+}
+
+float WhiteNoiseGenerator::resample(uint32_t frameNumber, uint32_t channel,
+  uint32_t group, uint32_t lane)
+{
+  // Draw the value again from the following attempts until it's in range
+  uint32_t key[2] = { seed, 0 };
+  for (uint32_t attempt = 1; attempt < MAX_ATTEMPTS; ++attempt)
+  {
+    uint32_t counter[4] = { group, frameNumber, channel, attempt };
+    uint32_t random[VALUES_PER_CALL];
+    philox::generate(counter, key, random);
+    uint32_t pair = lane & ~1u;
+    float gaussians[2];
+    boxMuller(&random[pair], &random[pair + 1], 1, &gaussians[0], &gaussians[1]);
+    float value = gaussians[lane - pair] * NOISE_STD_DEV + NOISE_MEAN;
+    if ((value >= 0.0f) && (value <= 1.0f))
+    {
+      return value;
+    }
+  }
+  return NOISE_MEAN;
+}
+
+uint8_t WhiteNoiseGenerator::encodeLevel(float value)
+{
+  // Start from the coarse table and step up to the exact level, which takes at most a
+  // few steps near black where the levels are closest together
+  uint32_t level = coarseLevels[(uint32_t)(value * COARSE_LEVEL_COUNT)];
+  while (value >= levelThresholds[level + 1])
+  {
+    level += 1;
+  }
+  return (uint8_t)level;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include "FrameGenerator.h"
+
+// The WhiteNoiseGenerator class renders the WhiteNoise stimulus. Each frame is a grid of
+// cells whose gray levels are drawn from a Gaussian with a mean of 0.5 and a standard
+// deviation of 0.1, truncated to the range 0 to 1 by resampling, gamma encoded with an
+// exponent of 1 / 2.2, and scaled up to the output size without smoothing. This matches
+// WhiteNoiseRenderer in the stimulus window. When color is true the red, green, and blue
+// channels of each cell are drawn independently.
+//
+// The random values come from a Philox generator keyed with the seed and indexed by the
+// frame number, cell, and channel, so the same seed always produces the same movie no
+// matter how many threads render it or in what order.
+class WhiteNoiseGenerator : public FrameGenerator
+{
+public:
+  WhiteNoiseGenerator(uint32_t frameCount, uint32_t rows, uint32_t columns, bool color,
+    uint32_t seed);
+  virtual ~WhiteNoiseGenerator() {};
+
+  bool open(uint32_t width, uint32_t height, std::string& error) override;
+  void renderFrame(uint32_t frameNumber, uint8_t* dest) override;
+
+private:
+  void generateCells(uint32_t frameNumber, uint32_t channel, uint8_t* levels);
+  float resample(uint32_t frameNumber, uint32_t channel, uint32_t group, uint32_t lane);
+  uint8_t encodeLevel(float value);
+
+private:
+  uint32_t rows;
+  uint32_t columns;
+  bool color;
+  uint32_t seed;
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  // The source cell of each output row and column
+  std::vector<uint32_t> rowMap;
+  std::vector<uint32_t> columnMap;
+
+  // Gamma lookup. The coarse table gives the lowest possible gray level for each range
+  // of linear values and the thresholds give the exact value at which each level begins
+  std::vector<uint8_t> coarseLevels;
+  std::vector<float> levelThresholds;
+};
@@ -1,4 +1,5 @@
 #include "Wrapper.h"
+#include "BenchmarkWorker.h"
 #include "Native.h"
 #include <stdio.h>
 
@@ -10,12 +11,55 @@ Napi::Object wrapper::Init(Napi::Env env, Napi::Object exports)
 
   exports.Set("createVideoOutput", Napi::Function::New(env, wrapper::createVideoOutput));
   exports.Set("queueNextFrame", Napi::Function::New(env, wrapper::queueNextFrame));
+  exports.Set("queueWhiteNoise", Napi::Function::New(env, wrapper::queueWhiteNoise));
+  exports.Set("queueGrating", Napi::Function::New(env, wrapper::queueGrating));
+  exports.Set("queueChirp", Napi::Function::New(env, wrapper::queueChirp));
+  exports.Set("queueSolid", Napi::Function::New(env, wrapper::queueSolid));
+  exports.Set("queueCheckerboard", Napi::Function::New(env, wrapper::queueCheckerboard));
+  exports.Set("queueBar", Napi::Function::New(env, wrapper::queueBar));
+  exports.Set("queueLetter", Napi::Function::New(env, wrapper::queueLetter));
+  exports.Set("queueTiledLetter", Napi::Function::New(env, wrapper::queueTiledLetter));
+  exports.Set("queueEyeChart", Napi::Function::New(env, wrapper::queueEyeChart));
+  exports.Set("queueStimuli", Napi::Function::New(env, wrapper::queueStimuli));
+  exports.Set("countNativeStimuli", Napi::Function::New(env, wrapper::countNativeStimuli));
+  exports.Set("setNativeLetters", Napi::Function::New(env, wrapper::setNativeLetters));
+  exports.Set("queueImage", Napi::Function::New(env, wrapper::queueImage));
+  exports.Set("configureImageCache", Napi::Function::New(env, wrapper::configureImageCache));
+  exports.Set("prefetchImage", Napi::Function::New(env, wrapper::prefetchImage));
+  exports.Set("getImageCacheStatistics", Napi::Function::New(env, wrapper::getImageCacheStatistics));
   exports.Set("checkCompletedFrames", Napi::Function::New(env, wrapper::checkCompletedFrames));
   exports.Set("closeVideoOutput", Napi::Function::New(env, wrapper::closeVideoOutput));
+  exports.Set("markStimulusBoundary", Napi::Function::New(env, wrapper::markStimulusBoundary));
+  exports.Set("enableFrameArchive", Napi::Function::New(env, wrapper::enableFrameArchive));
+  exports.Set("benchmarkFrameArchive", Napi::Function::New(env, wrapper::benchmarkFrameArchive));
+  exports.Set("enableFrameStore", Napi::Function::New(env, wrapper::enableFrameStore));
+  exports.Set("collectFrameStore", Napi::Function::New(env, wrapper::collectFrameStore));
+  exports.Set("enableLuminanceTrace", Napi::Function::New(env, wrapper::enableLuminanceTrace));
+  exports.Set("enableTensorExport", Napi::Function::New(env, wrapper::enableTensorExport));
+  exports.Set("enableDryRun", Napi::Function::New(env, wrapper::enableDryRun));
+  exports.Set("getDryRunStatistics", Napi::Function::New(env, wrapper::getDryRunStatistics));
+  exports.Set("loadGammaTable", Napi::Function::New(env, wrapper::loadGammaTable));
+  exports.Set("enableSyncPatch", Napi::Function::New(env, wrapper::enableSyncPatch));
+  exports.Set("disableSyncPatch", Napi::Function::New(env, wrapper::disableSyncPatch));
+  exports.Set("getSyncStatistics", Napi::Function::New(env, wrapper::getSyncStatistics));
+  exports.Set("enableFrameCode", Napi::Function::New(env, wrapper::enableFrameCode));
+  exports.Set("disableFrameCode", Napi::Function::New(env, wrapper::disableFrameCode));
+  exports.Set("decodeFrameCodes", Napi::Function::New(env, wrapper::decodeFrameCodes));
 
   exports.Set("beginVideoPlayback", Napi::Function::New(env, wrapper::beginVideoPlayback));
   exports.Set("endVideoPlayback", Napi::Function::New(env, wrapper::endVideoPlayback));
+  exports.Set("setDecoderLookahead", Napi::Function::New(env, wrapper::setDecoderLookahead));
+  exports.Set("setPlaybackBufferSize", Napi::Function::New(env, wrapper::setPlaybackBufferSize));
+  exports.Set("setDecodeToDisplay", Napi::Function::New(env, wrapper::setDecodeToDisplay));
+  exports.Set("setStarvationPolicy", Napi::Function::New(env, wrapper::setStarvationPolicy));
+  exports.Set("setPresentationLogPath", Napi::Function::New(env, wrapper::setPresentationLogPath));
+  exports.Set("exportPresentationLog", Napi::Function::New(env, wrapper::exportPresentationLog));
+  exports.Set("setProbeCachePath", Napi::Function::New(env, wrapper::setProbeCachePath));
+  exports.Set("setPlaybackCache", Napi::Function::New(env, wrapper::setPlaybackCache));
+  exports.Set("beginPlaybackPreparation", Napi::Function::New(env, wrapper::beginPlaybackPreparation));
+  exports.Set("endPlaybackPreparation", Napi::Function::New(env, wrapper::endPlaybackPreparation));
   exports.Set("getDisplayFrequencies", Napi::Function::New(env, wrapper::getDisplayFrequencies));
+  exports.Set("benchmarkVideoDecode", Napi::Function::New(env, wrapper::benchmarkVideoDecode));
 
   exports.Set("createPreviewChannel", Napi::Function::New(env, wrapper::createPreviewChannel));
   exports.Set("openPreviewChannel", Napi::Function::New(env, wrapper::openPreviewChannel));
@@ -154,6 +198,366 @@ Napi::Number wrapper::queueNextFrame(const Napi::CallbackInfo& info)
     width, height));
 }
 
+Napi::Number wrapper::queueWhiteNoise(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 5) ||
+    !info[0].IsNumber() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsBoolean() ||
+    !info[4].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::Number rows = info[1].As<Napi::Number>();
+  Napi::Number columns = info[2].As<Napi::Number>();
+  Napi::Boolean color = info[3].As<Napi::Boolean>();
+  Napi::Number seed = info[4].As<Napi::Number>();
+  return Napi::Number::New(env, native::queueWhiteNoise(env, frameCount, rows, columns,
+    color, seed));
+}
+
+Napi::Number wrapper::queueGrating(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 7) ||
+    !info[0].IsNumber() ||
+    !info[1].IsBoolean() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber() ||
+    !info[5].IsString() ||
+    !info[6].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::Boolean sinusoidal = info[1].As<Napi::Boolean>();
+  Napi::Number speed = info[2].As<Napi::Number>();
+  Napi::Number barWidth = info[3].As<Napi::Number>();
+  Napi::Number angle = info[4].As<Napi::Number>();
+  Napi::String barColor = info[5].As<Napi::String>();
+  Napi::String backgroundColor = info[6].As<Napi::String>();
+  return Napi::Number::New(env, native::queueGrating(env, frameCount, sinusoidal, speed,
+    barWidth, angle, barColor, backgroundColor));
+}
+
+Napi::Number wrapper::queueChirp(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 7) ||
+    !info[0].IsNumber() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber() ||
+    !info[5].IsNumber() ||
+    !info[6].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::Number f0 = info[1].As<Napi::Number>();
+  Napi::Number f1 = info[2].As<Napi::Number>();
+  Napi::Number a0 = info[3].As<Napi::Number>();
+  Napi::Number a1 = info[4].As<Napi::Number>();
+  Napi::Number t1 = info[5].As<Napi::Number>();
+  Napi::Number phi = info[6].As<Napi::Number>();
+  return Napi::Number::New(env, native::queueChirp(env, frameCount, f0, f1, a0, a1, t1,
+    phi));
+}
+
+Napi::Number wrapper::queueSolid(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsNumber() ||
+    !info[1].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::String color = info[1].As<Napi::String>();
+  return Napi::Number::New(env, native::queueSolid(env, frameCount, color));
+}
+
+Napi::Number wrapper::queueCheckerboard(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 5) ||
+    !info[0].IsNumber() ||
+    !info[1].IsString() ||
+    !info[2].IsString() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::String color = info[1].As<Napi::String>();
+  Napi::String alternateColor = info[2].As<Napi::String>();
+  Napi::Number size = info[3].As<Napi::Number>();
+  Napi::Number angle = info[4].As<Napi::Number>();
+  return Napi::Number::New(env, native::queueCheckerboard(env, frameCount, color,
+    alternateColor, size, angle));
+}
+
+Napi::Number wrapper::queueBar(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 6) ||
+    !info[0].IsNumber() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsString() ||
+    !info[5].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::Number speed = info[1].As<Napi::Number>();
+  Napi::Number barWidth = info[2].As<Napi::Number>();
+  Napi::Number angle = info[3].As<Napi::Number>();
+  Napi::String barColor = info[4].As<Napi::String>();
+  Napi::String backgroundColor = info[5].As<Napi::String>();
+  return Napi::Number::New(env, native::queueBar(env, frameCount, speed, barWidth, angle,
+    barColor, backgroundColor));
+}
+
+Napi::Number wrapper::queueLetter(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 7) ||
+    !info[0].IsNumber() ||
+    !info[1].IsString() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber() ||
+    !info[5].IsString() ||
+    !info[6].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::String letter = info[1].As<Napi::String>();
+  Napi::Number x = info[2].As<Napi::Number>();
+  Napi::Number y = info[3].As<Napi::Number>();
+  Napi::Number size = info[4].As<Napi::Number>();
+  Napi::String color = info[5].As<Napi::String>();
+  Napi::String backgroundColor = info[6].As<Napi::String>();
+  return Napi::Number::New(env, native::queueLetter(env, frameCount, letter, x, y, size,
+    color, backgroundColor));
+}
+
+Napi::Number wrapper::queueTiledLetter(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 7) ||
+    !info[0].IsNumber() ||
+    !info[1].IsString() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsString() ||
+    !info[5].IsNumber() ||
+    !info[6].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::String letter = info[1].As<Napi::String>();
+  Napi::Number size = info[2].As<Napi::Number>();
+  Napi::Number padding = info[3].As<Napi::Number>();
+  Napi::String color = info[4].As<Napi::String>();
+  Napi::Number angle = info[5].As<Napi::Number>();
+  Napi::String backgroundColor = info[6].As<Napi::String>();
+  return Napi::Number::New(env, native::queueTiledLetter(env, frameCount, letter, size,
+    padding, color, angle, backgroundColor));
+}
+
+Napi::Number wrapper::queueEyeChart(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 6) ||
+    !info[0].IsNumber() ||
+    !info[1].IsArray() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsString() ||
+    !info[5].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::Array rows = info[1].As<Napi::Array>();
+  Napi::Number size = info[2].As<Napi::Number>();
+  Napi::Number padding = info[3].As<Napi::Number>();
+  Napi::String color = info[4].As<Napi::String>();
+  Napi::String backgroundColor = info[5].As<Napi::String>();
+  vector<string> letterMatrix;
+  for (uint32_t i = 0; i < rows.Length(); ++i)
+  {
+    Napi::Value row = rows.Get(i);
+    if (!row.IsString())
+    {
+      Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+      return Napi::Number::New(env, -1);
+    }
+    letterMatrix.push_back(row.As<Napi::String>());
+  }
+  return Napi::Number::New(env, native::queueEyeChart(env, frameCount, letterMatrix, size,
+    padding, color, backgroundColor));
+}
+
+Napi::Value wrapper::queueStimuli(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) || !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::String batchJson = info[0].As<Napi::String>();
+  vector<int32_t> firstFrameIds;
+  string stopReason;
+  string error = native::queueStimuli(env, batchJson, firstFrameIds, stopReason);
+  if (!error.empty())
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Int32Array ids = Napi::Int32Array::New(env, firstFrameIds.size());
+  memcpy(ids.Data(), firstFrameIds.data(), sizeof(int32_t) * firstFrameIds.size());
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("firstFrameIds", ids);
+  result.Set("stopReason", Napi::String::New(env, stopReason));
+  return result;
+}
+
+Napi::Number wrapper::countNativeStimuli(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::String batchJson = info[0].As<Napi::String>();
+  Napi::Number fps = info[1].As<Napi::Number>();
+  return Napi::Number::New(env, native::countNativeStimuli(env, batchJson, fps));
+}
+
+Napi::String wrapper::setNativeLetters(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsBoolean())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Boolean enabled = info[0].As<Napi::Boolean>();
+  return Napi::String::New(env, native::setNativeLetters(env, enabled));
+}
+
+Napi::Number wrapper::queueImage(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 7) ||
+    !info[0].IsNumber() ||
+    !info[1].IsString() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber() ||
+    !info[5].IsNumber() ||
+    !info[6].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  Napi::Number frameCount = info[0].As<Napi::Number>();
+  Napi::String path = info[1].As<Napi::String>();
+  Napi::Number fixationX = info[2].As<Napi::Number>();
+  Napi::Number fixationY = info[3].As<Napi::Number>();
+  Napi::Number scaleX = info[4].As<Napi::Number>();
+  Napi::Number scaleY = info[5].As<Napi::Number>();
+  Napi::String backgroundColor = info[6].As<Napi::String>();
+  return Napi::Number::New(env, native::queueImage(env, frameCount, path, fixationX,
+    fixationY, scaleX, scaleY, backgroundColor));
+}
+
+Napi::String wrapper::configureImageCache(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsNumber() ||
+    !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Number maxMegabytes = info[0].As<Napi::Number>();
+  Napi::Number workerCount = info[1].As<Napi::Number>();
+  return Napi::String::New(env, native::configureImageCache(env, maxMegabytes,
+    workerCount));
+}
+
+Napi::String wrapper::prefetchImage(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 6) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber() ||
+    !info[5].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String path = info[0].As<Napi::String>();
+  Napi::Number fixationX = info[1].As<Napi::Number>();
+  Napi::Number fixationY = info[2].As<Napi::Number>();
+  Napi::Number scaleX = info[3].As<Napi::Number>();
+  Napi::Number scaleY = info[4].As<Napi::Number>();
+  Napi::String backgroundColor = info[5].As<Napi::String>();
+  return Napi::String::New(env, native::prefetchImage(env, path, fixationX, fixationY,
+    scaleX, scaleY, backgroundColor));
+}
+
+Napi::Value wrapper::getImageCacheStatistics(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() != 0)
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  uint32_t hits = 0, misses = 0, entries = 0;
+  uint64_t bytes = 0;
+  native::getImageCacheStatistics(env, hits, misses, entries, bytes);
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", Napi::Number::New(env, hits));
+  result.Set("misses", Napi::Number::New(env, misses));
+  result.Set("entries", Napi::Number::New(env, entries));
+  result.Set("bytes", Napi::Number::New(env, (double)bytes));
+  return result;
+}
+
 Napi::Int32Array wrapper::checkCompletedFrames(const Napi::CallbackInfo& info)
 {
   Napi::Env env = info.Env();
@@ -169,17 +573,404 @@ void wrapper::closeVideoOutput(const Napi::CallbackInfo& info)
   native::closeVideoOutput(env);
 }
 
+Napi::String wrapper::markStimulusBoundary(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsNumber() ||
+    !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Number stimulusId = info[0].As<Napi::Number>();
+  Napi::Number frameNumber = info[1].As<Napi::Number>();
+  return Napi::String::New(env, native::markStimulusBoundary(env, stimulusId,
+    frameNumber));
+}
+
+Napi::String wrapper::enableFrameArchive(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsString() ||
+    !info[1].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String archivePath = info[0].As<Napi::String>();
+  Napi::String compression = info[1].As<Napi::String>();
+  return Napi::String::New(env, native::enableFrameArchive(env, archivePath,
+    compression));
+}
+
+Napi::Value wrapper::benchmarkFrameArchive(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 5) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::String archivePath = info[0].As<Napi::String>();
+  Napi::Number width = info[1].As<Napi::Number>();
+  Napi::Number height = info[2].As<Napi::Number>();
+  Napi::Number frameCount = info[3].As<Napi::Number>();
+  Napi::String compression = info[4].As<Napi::String>();
+  string path = archivePath, codec = compression;
+  int benchmarkWidth = width, benchmarkHeight = height, count = frameCount;
+  BenchmarkWorker* worker = new BenchmarkWorker(env, [=](BenchmarkResults& results)
+  {
+    double writeMBps = 0, readMBps = 0, compressionRatio = 0;
+    string error = native::benchmarkFrameArchive(env, path, benchmarkWidth,
+      benchmarkHeight, count, codec, writeMBps, readMBps, compressionRatio);
+    results.push_back(make_pair("writeMBps", writeMBps));
+    results.push_back(make_pair("readMBps", readMBps));
+    results.push_back(make_pair("compressionRatio", compressionRatio));
+    return error;
+  });
+  Napi::Promise promise = worker->getPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::String wrapper::enableFrameStore(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 3) ||
+    !info[0].IsString() ||
+    !info[1].IsString() ||
+    !info[2].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String storePath = info[0].As<Napi::String>();
+  Napi::String runName = info[1].As<Napi::String>();
+  Napi::String compression = info[2].As<Napi::String>();
+  return Napi::String::New(env, native::enableFrameStore(env, storePath, runName,
+    compression));
+}
+
+Napi::Value wrapper::collectFrameStore(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) || !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::String storePath = info[0].As<Napi::String>();
+  uint32_t removedCount = 0, keptCount = 0;
+  uint64_t removedBytes = 0;
+  string error = native::collectFrameStore(env, storePath, removedCount, removedBytes,
+    keptCount);
+  if (!error.empty())
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("removedFrames", Napi::Number::New(env, removedCount));
+  result.Set("removedBytes", Napi::Number::New(env, (double)removedBytes));
+  result.Set("keptFrames", Napi::Number::New(env, keptCount));
+  return result;
+}
+
+Napi::String wrapper::enableLuminanceTrace(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 3) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String format = info[0].As<Napi::String>();
+  Napi::Number gridRows = info[1].As<Napi::Number>();
+  Napi::Number gridColumns = info[2].As<Napi::Number>();
+  return Napi::String::New(env, native::enableLuminanceTrace(env, format, gridRows,
+    gridColumns));
+}
+
+Napi::String wrapper::enableTensorExport(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 4) ||
+    !info[0].IsNumber() ||
+    !info[1].IsNumber() ||
+    !info[2].IsString() ||
+    !info[3].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Number width = info[0].As<Napi::Number>();
+  Napi::Number height = info[1].As<Napi::Number>();
+  Napi::String format = info[2].As<Napi::String>();
+  Napi::Number framesPerShard = info[3].As<Napi::Number>();
+  return Napi::String::New(env, native::enableTensorExport(env, width, height, format,
+    framesPerShard));
+}
+
+// Helper function that converts a JavaScript array of numbers to a vector, returning
+// false if any element isn't a number
+static bool toIntVector(Napi::Array array, vector<int>& values)
+{
+  values.clear();
+  for (uint32_t i = 0; i < array.Length(); ++i)
+  {
+    Napi::Value value = array.Get(i);
+    if (!value.IsNumber())
+    {
+      return false;
+    }
+    values.push_back(value.As<Napi::Number>());
+  }
+  return true;
+}
+
+Napi::String wrapper::enableDryRun(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  vector<int> gamutMin, gamutMax;
+  if ((info.Length() != 2) ||
+    !info[0].IsArray() ||
+    !info[1].IsArray() ||
+    !toIntVector(info[0].As<Napi::Array>(), gamutMin) ||
+    !toIntVector(info[1].As<Napi::Array>(), gamutMax))
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  return Napi::String::New(env, native::enableDryRun(env, gamutMin, gamutMax));
+}
+
+// Helper function that converts a dry run summary to a JavaScript object
+static Napi::Object toDryRunObject(Napi::Env env, const DryRunSummary& summary)
+{
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("firstFrame", Napi::Number::New(env, summary.firstFrame));
+  result.Set("frameCount", Napi::Number::New(env, summary.frameCount));
+  result.Set("duration", Napi::Number::New(env, summary.duration));
+  result.Set("minLuminance", Napi::Number::New(env, summary.minLuminance));
+  result.Set("maxLuminance", Napi::Number::New(env, summary.maxLuminance));
+  result.Set("meanLuminance", Napi::Number::New(env, summary.meanLuminance));
+  result.Set("outOfGamutFrames", Napi::Number::New(env, summary.outOfGamutFrames));
+  result.Set("firstOutOfGamutFrame", Napi::Number::New(env,
+    (double)summary.firstOutOfGamutFrame));
+  return result;
+}
+
+Napi::Value wrapper::getDryRunStatistics(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() != 0)
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  DryRunSummary program;
+  vector<DryRunSummary> stimuli;
+  string error = native::getDryRunStatistics(env, program, stimuli);
+  if (!error.empty())
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = toDryRunObject(env, program);
+  Napi::Array stimulusArray = Napi::Array::New(env, stimuli.size());
+  for (uint32_t i = 0; i < stimuli.size(); ++i)
+  {
+    Napi::Object stimulus = toDryRunObject(env, stimuli[i]);
+    stimulus.Set("stimulusId", Napi::Number::New(env, stimuli[i].stimulusId));
+    stimulusArray.Set(i, stimulus);
+  }
+  result.Set("stimuli", stimulusArray);
+  return result;
+}
+
+Napi::String wrapper::loadGammaTable(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsString() ||
+    !info[1].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String path = info[0].As<Napi::String>();
+  Napi::String target = info[1].As<Napi::String>();
+  return Napi::String::New(env, native::loadGammaTable(env, path, target));
+}
+
+Napi::String wrapper::enableSyncPatch(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 8) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber() ||
+    !info[2].IsString() ||
+    !info[3].IsBoolean() ||
+    !info[4].IsNumber() ||
+    !info[5].IsNumber() ||
+    !info[6].IsNumber() ||
+    !info[7].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String corner = info[0].As<Napi::String>();
+  Napi::Number size = info[1].As<Napi::Number>();
+  Napi::String mode = info[2].As<Napi::String>();
+  Napi::Boolean simulate = info[3].As<Napi::Boolean>();
+  Napi::Number latencyMs = info[4].As<Napi::Number>();
+  Napi::Number jitterMs = info[5].As<Napi::Number>();
+  Napi::Number missRate = info[6].As<Napi::Number>();
+  Napi::Number seed = info[7].As<Napi::Number>();
+  return Napi::String::New(env, native::enableSyncPatch(env, corner, size, mode, simulate,
+    latencyMs, jitterMs, missRate, seed));
+}
+
+Napi::String wrapper::disableSyncPatch(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() != 0)
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  return Napi::String::New(env, native::disableSyncPatch(env));
+}
+
+Napi::Value wrapper::getSyncStatistics(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() != 0)
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  SyncStatistics statistics;
+  string error = native::getSyncStatistics(env, statistics);
+  if (!error.empty())
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("presentedFrames", Napi::Number::New(env, (double)statistics.presentedFrames));
+  result.Set("droppedFrames", Napi::Number::New(env, (double)statistics.droppedFrames));
+  result.Set("onsets", Napi::Number::New(env, (double)statistics.onsets));
+  result.Set("matchedEvents", Napi::Number::New(env, (double)statistics.matchedEvents));
+  result.Set("missedOnsets", Napi::Number::New(env, (double)statistics.missedOnsets));
+  result.Set("unexpectedEvents", Napi::Number::New(env,
+    (double)statistics.unexpectedEvents));
+  result.Set("meanLatencyMs", Napi::Number::New(env, statistics.meanLatencyMs));
+  result.Set("stdDevLatencyMs", Napi::Number::New(env, statistics.stdDevLatencyMs));
+  result.Set("minLatencyMs", Napi::Number::New(env, statistics.minLatencyMs));
+  result.Set("maxLatencyMs", Napi::Number::New(env, statistics.maxLatencyMs));
+  result.Set("lastLatencyMs", Napi::Number::New(env, statistics.lastLatencyMs));
+  return result;
+}
+
+Napi::String wrapper::enableFrameCode(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 5) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String target = info[0].As<Napi::String>();
+  Napi::Number x = info[1].As<Napi::Number>();
+  Napi::Number y = info[2].As<Napi::Number>();
+  Napi::Number cellSize = info[3].As<Napi::Number>();
+  Napi::Number bits = info[4].As<Napi::Number>();
+  return Napi::String::New(env, native::enableFrameCode(env, target, x, y, cellSize,
+    bits));
+}
+
+Napi::String wrapper::disableFrameCode(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String target = info[0].As<Napi::String>();
+  return Napi::String::New(env, native::disableFrameCode(env, target));
+}
+
+Napi::Value wrapper::decodeFrameCodes(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 6) ||
+    !info[0].IsArray() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber() ||
+    !info[3].IsNumber() ||
+    !info[4].IsNumber() ||
+    !info[5].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Array pathsArray = info[0].As<Napi::Array>();
+  vector<string> paths;
+  for (uint32_t i = 0; i < pathsArray.Length(); i++)
+  {
+    Napi::Value value = pathsArray[i];
+    paths.push_back(value.ToString().Utf8Value());
+  }
+  Napi::Number x = info[1].As<Napi::Number>();
+  Napi::Number y = info[2].As<Napi::Number>();
+  Napi::Number cellWidth = info[3].As<Napi::Number>();
+  Napi::Number cellHeight = info[4].As<Napi::Number>();
+  Napi::Number bits = info[5].As<Napi::Number>();
+  vector<int32_t> numbers;
+  string error = native::decodeFrameCodes(env, paths, x, y, cellWidth, cellHeight, bits,
+    numbers);
+  if (!error.empty())
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Int32Array result = Napi::Int32Array::New(env, numbers.size());
+  memcpy(result.Data(), numbers.data(), sizeof(int32_t) * numbers.size());
+  return result;
+}
+
 Napi::String wrapper::beginVideoPlayback(const Napi::CallbackInfo& info)
 {
   Napi::Env env = info.Env();
-  if ((info.Length() != 7) ||
+  if ((info.Length() != 10) ||
     !info[0].IsNumber() ||
     !info[1].IsNumber() ||
     !info[2].IsArray() ||
     !info[3].IsBoolean() ||
     !info[4].IsFunction() ||
     !info[5].IsFunction() ||
-    !info[6].IsFunction())
+    !info[6].IsFunction() ||
+    !info[7].IsNumber() ||
+    !info[8].IsNumber() ||
+    !info[9].IsNumber())
   {
     Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
     return Napi::String();
@@ -201,8 +992,12 @@ Napi::String wrapper::beginVideoPlayback(const Napi::CallbackInfo& info)
   wrapper::JsCallback* positionJsCallback = createJsCallback(env, positionCallback);
   Napi::Function delayCallback = info[6].As<Napi::Function>();
   wrapper::JsCallback* delayJsCallback = createJsCallback(env, delayCallback);
+  Napi::Number startVideo = info[7].As<Napi::Number>();
+  Napi::Number startFrame = info[8].As<Napi::Number>();
+  Napi::Number startTimeMs = info[9].As<Napi::Number>();
   return Napi::String::New(env, native::beginVideoPlayback(env, x, y, videos, scaleToFit,
-    durationJsCallback, positionJsCallback, delayJsCallback));
+    durationJsCallback, positionJsCallback, delayJsCallback, startVideo, startFrame,
+    startTimeMs));
 }
 
 Napi::String wrapper::endVideoPlayback(const Napi::CallbackInfo& info)
@@ -211,6 +1006,145 @@ Napi::String wrapper::endVideoPlayback(const Napi::CallbackInfo& info)
   return Napi::String::New(env, native::endVideoPlayback(env));
 }
 
+Napi::String wrapper::setDecoderLookahead(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Number videoCount = info[0].As<Napi::Number>();
+  return Napi::String::New(env, native::setDecoderLookahead(env, videoCount));
+}
+
+Napi::String wrapper::setPlaybackBufferSize(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Number maxMegabytes = info[0].As<Napi::Number>();
+  return Napi::String::New(env, native::setPlaybackBufferSize(env, maxMegabytes));
+}
+
+Napi::String wrapper::setDecodeToDisplay(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsBoolean())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Boolean enabled = info[0].As<Napi::Boolean>();
+  return Napi::String::New(env, native::setDecodeToDisplay(env, enabled));
+}
+
+Napi::String wrapper::setStarvationPolicy(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String policy = info[0].As<Napi::String>();
+  return Napi::String::New(env, native::setStarvationPolicy(env, policy));
+}
+
+Napi::String wrapper::setPresentationLogPath(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String path = info[0].As<Napi::String>();
+  return Napi::String::New(env, native::setPresentationLogPath(env, path));
+}
+
+Napi::String wrapper::exportPresentationLog(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsString() ||
+    !info[1].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String logPath = info[0].As<Napi::String>();
+  Napi::String outputPath = info[1].As<Napi::String>();
+  return Napi::String::New(env, native::exportPresentationLog(env, logPath, outputPath));
+}
+
+Napi::String wrapper::setProbeCachePath(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 1) ||
+    !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String path = info[0].As<Napi::String>();
+  return Napi::String::New(env, native::setProbeCachePath(env, path));
+}
+
+Napi::String wrapper::setPlaybackCache(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 2) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::String directory = info[0].As<Napi::String>();
+  Napi::Number maxMegabytes = info[1].As<Napi::Number>();
+  return Napi::String::New(env, native::setPlaybackCache(env, directory, maxMegabytes));
+}
+
+Napi::String wrapper::beginPlaybackPreparation(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 3) ||
+    !info[0].IsArray() ||
+    !info[1].IsString() ||
+    !info[2].IsFunction())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return Napi::String();
+  }
+  Napi::Array videosArray = info[0].As<Napi::Array>();
+  vector<string> videos;
+  for (uint32_t i = 0; i < videosArray.Length(); i++)
+  {
+    Napi::Value value = videosArray[i];
+    string video = value.ToString().Utf8Value();
+    videos.push_back(video);
+  }
+  Napi::String compression = info[1].As<Napi::String>();
+  Napi::Function progressCallback = info[2].As<Napi::Function>();
+  wrapper::JsCallback* progressJsCallback = createJsCallback(env, progressCallback);
+  return Napi::String::New(env, native::beginPlaybackPreparation(env, videos,
+    compression, progressJsCallback));
+}
+
+void wrapper::endPlaybackPreparation(const Napi::CallbackInfo& info)
+{
+  native::endPlaybackPreparation(info.Env());
+}
+
 Napi::Int32Array wrapper::getDisplayFrequencies(const Napi::CallbackInfo& info)
 {
   Napi::Env env = info.Env();
@@ -230,6 +1164,38 @@ Napi::Int32Array wrapper::getDisplayFrequencies(const Napi::CallbackInfo& info)
   return returnValue;
 }
 
+Napi::Value wrapper::benchmarkVideoDecode(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if ((info.Length() != 3) ||
+    !info[0].IsString() ||
+    !info[1].IsNumber() ||
+    !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Incorrect parameter type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::String rawPath = info[0].As<Napi::String>();
+  Napi::Number width = info[1].As<Napi::Number>();
+  Napi::Number height = info[2].As<Napi::Number>();
+  string path = rawPath;
+  int benchmarkWidth = width, benchmarkHeight = height;
+  BenchmarkWorker* worker = new BenchmarkWorker(env, [=](BenchmarkResults& results)
+  {
+    uint32_t frameCount = 0;
+    double framesPerSecond = 0, megabytesPerSecond = 0;
+    string error = native::benchmarkVideoDecode(env, path, benchmarkWidth,
+      benchmarkHeight, frameCount, framesPerSecond, megabytesPerSecond);
+    results.push_back(make_pair("frameCount", (double)frameCount));
+    results.push_back(make_pair("framesPerSecond", framesPerSecond));
+    results.push_back(make_pair("MBps", megabytesPerSecond));
+    return error;
+  });
+  Napi::Promise promise = worker->getPromise();
+  worker->Queue();
+  return promise;
+}
+
 Napi::String wrapper::createPreviewChannel(const Napi::CallbackInfo& info)
 {
   Napi::Env env = info.Env();
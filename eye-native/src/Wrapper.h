@@ -25,12 +25,55 @@ namespace wrapper
 
   Napi::String createVideoOutput(const Napi::CallbackInfo& info);
   Napi::Number queueNextFrame(const Napi::CallbackInfo& info);
+  Napi::Number queueWhiteNoise(const Napi::CallbackInfo& info);
+  Napi::Number queueGrating(const Napi::CallbackInfo& info);
+  Napi::Number queueChirp(const Napi::CallbackInfo& info);
+  Napi::Number queueSolid(const Napi::CallbackInfo& info);
+  Napi::Number queueCheckerboard(const Napi::CallbackInfo& info);
+  Napi::Number queueBar(const Napi::CallbackInfo& info);
+  Napi::Number queueLetter(const Napi::CallbackInfo& info);
+  Napi::Number queueTiledLetter(const Napi::CallbackInfo& info);
+  Napi::Number queueEyeChart(const Napi::CallbackInfo& info);
+  Napi::Value queueStimuli(const Napi::CallbackInfo& info);
+  Napi::Number countNativeStimuli(const Napi::CallbackInfo& info);
+  Napi::String setNativeLetters(const Napi::CallbackInfo& info);
+  Napi::Number queueImage(const Napi::CallbackInfo& info);
+  Napi::String configureImageCache(const Napi::CallbackInfo& info);
+  Napi::String prefetchImage(const Napi::CallbackInfo& info);
+  Napi::Value getImageCacheStatistics(const Napi::CallbackInfo& info);
   Napi::Int32Array checkCompletedFrames(const Napi::CallbackInfo& info);
   void closeVideoOutput(const Napi::CallbackInfo& info);
+  Napi::String markStimulusBoundary(const Napi::CallbackInfo& info);
+  Napi::String enableFrameArchive(const Napi::CallbackInfo& info);
+  Napi::Value benchmarkFrameArchive(const Napi::CallbackInfo& info);
+  Napi::String enableFrameStore(const Napi::CallbackInfo& info);
+  Napi::Value collectFrameStore(const Napi::CallbackInfo& info);
+  Napi::String enableLuminanceTrace(const Napi::CallbackInfo& info);
+  Napi::String enableTensorExport(const Napi::CallbackInfo& info);
+  Napi::String enableDryRun(const Napi::CallbackInfo& info);
+  Napi::Value getDryRunStatistics(const Napi::CallbackInfo& info);
+  Napi::String loadGammaTable(const Napi::CallbackInfo& info);
+  Napi::String enableSyncPatch(const Napi::CallbackInfo& info);
+  Napi::String disableSyncPatch(const Napi::CallbackInfo& info);
+  Napi::Value getSyncStatistics(const Napi::CallbackInfo& info);
+  Napi::String enableFrameCode(const Napi::CallbackInfo& info);
+  Napi::String disableFrameCode(const Napi::CallbackInfo& info);
+  Napi::Value decodeFrameCodes(const Napi::CallbackInfo& info);
 
   Napi::String beginVideoPlayback(const Napi::CallbackInfo& info);
   Napi::String endVideoPlayback(const Napi::CallbackInfo& info);
+  Napi::String setDecoderLookahead(const Napi::CallbackInfo& info);
+  Napi::String setPlaybackBufferSize(const Napi::CallbackInfo& info);
+  Napi::String setDecodeToDisplay(const Napi::CallbackInfo& info);
+  Napi::String setStarvationPolicy(const Napi::CallbackInfo& info);
+  Napi::String setPresentationLogPath(const Napi::CallbackInfo& info);
+  Napi::String exportPresentationLog(const Napi::CallbackInfo& info);
+  Napi::String setProbeCachePath(const Napi::CallbackInfo& info);
+  Napi::String setPlaybackCache(const Napi::CallbackInfo& info);
+  Napi::String beginPlaybackPreparation(const Napi::CallbackInfo& info);
+  void endPlaybackPreparation(const Napi::CallbackInfo& info);
   Napi::Int32Array getDisplayFrequencies(const Napi::CallbackInfo& info);
+  Napi::Value benchmarkVideoDecode(const Napi::CallbackInfo& info);
 
   Napi::String createPreviewChannel(const Napi::CallbackInfo& info);
   Napi::String openPreviewChannel(const Napi::CallbackInfo& info);